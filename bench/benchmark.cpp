@@ -0,0 +1,541 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+#include <cstdio>
+#include <type_traits>
+#include <array>
+#include <limits>
+#include <sstream>
+#include <set>
+#include <cmath>
+#include "graph_analysis.h"
+#include "csv_loader.h"
+#include "path_search.h"
+#include "graph_metrics.h"
+#include "vertex_order.h"
+#include "spatial_index.h"
+#include "sssp_cache.h"
+#include "graph_updates.h"
+
+using namespace std;
+
+using CSRVertex = boost::graph_traits<CSRGraph>::vertex_descriptor;
+
+/**
+ * @brief banc d'essai sans interface sur un répertoire nodes.csv / edges.csv
+ *
+ * Usage : benchmark <répertoire> [--repeat N] [--queries Q] [--export-sources S] [--sssp-sources K] [--updates U] [--engine E] [--reorder O] [--weights P] [--graph R] [--threads T] [--seed G] [--json fichier]
+ *
+ * Mesures : chargement CSV, poids des arêtes (arête par arête avec calcul_distance, puis par lots avec le noyau
+ * vectoriel à la précision P, double par défaut), construction du graph CSR, requêtes point à point (chaque mode de find_shortest_path,
+ * Q couples aléatoires), recherches complètes depuis K sources avec chaque file de priorité (SearchEngine, distances
+ * comparées à celles du tas binaire), export CSV de tous les chemins depuis S sources, métriques, puis sur le graph CSR
+ * un lot aléatoire de U ouvertures, fermetures et changements de poids (300 par défaut) : export corrigé, arbres des
+ * K sources réparés et métriques incrémentales sont comparés à un recalcul complet. Requêtes et export
+ * utilisent la file E (binary par défaut). Avec --reorder O (hilbert, morton ou rcm), les sommets sont renumérotés
+ * après la construction et les mesures suivantes portent sur le graph renuméroté. Avec --graph compact, construction
+ * et mesures suivantes portent sur le graph compact (csr par défaut). Chaque mesure est répétée N fois ;
+ * minimum, médiane et moyenne sont affichés et écrits au format JSON.
+ */
+
+struct BenchResult
+{
+    string name;
+    vector<double> seconds;
+    size_t items = 0;
+};
+
+static double median_of(vector<double> values)
+{
+    sort(values.begin(), values.end());
+    size_t m = values.size() / 2;
+    return values.size() % 2 ? values[m] : (values[m - 1] + values[m]) / 2;
+}
+
+static double mean_of(const vector<double> &values)
+{
+    double sum = 0;
+    for (double v : values) sum += v;
+    return sum / values.size();
+}
+
+/**
+ * @brief exécution répétée de run, chronométrée sans prepare (appelée avant chaque répétition)
+ */
+static BenchResult measure(const string &name, unsigned repeat, size_t items, const function<void()> &prepare, const function<void()> &run)
+{
+    BenchResult result{name, {}, items};
+    for (unsigned r = 0; r < repeat; ++r) {
+        prepare();
+        auto start = chrono::steady_clock::now();
+        run();
+        auto end = chrono::steady_clock::now();
+        result.seconds.push_back(chrono::duration<double>(end - start).count());
+    }
+    printf("%-28s min %10.6f s  median %10.6f s  mean %10.6f s", name.c_str(),
+           *min_element(result.seconds.begin(), result.seconds.end()), median_of(result.seconds), mean_of(result.seconds));
+    if (items > 0) {
+        printf("  (%zu items, %.3f us/item)", items, 1e6 * median_of(result.seconds) / items);
+    }
+    printf("\n");
+    fflush(stdout);
+    return result;
+}
+
+static void write_json(const string &filename, const string &directory, size_t n, size_t arcs, unsigned threads, const vector<BenchResult> &results)
+{
+    ofstream file(filename, ios::out | ios::trunc);
+    if (!file.is_open()) {
+        cerr << "Impossible d'ouvrir le fichier '" << filename << "'" << endl;
+        return;
+    }
+    file.precision(9);
+    file << "{\n  \"dataset\": \"" << directory << "\",\n  \"vertices\": " << n << ",\n  \"arcs\": " << arcs
+         << ",\n  \"threads\": " << threads << ",\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult &r = results[i];
+        file << "    {\"name\": \"" << r.name << "\", \"repeat\": " << r.seconds.size() << ", \"items\": " << r.items
+             << ", \"min_s\": " << *min_element(r.seconds.begin(), r.seconds.end())
+             << ", \"median_s\": " << median_of(r.seconds) << ", \"mean_s\": " << mean_of(r.seconds) << ", \"runs_s\": [";
+        for (size_t k = 0; k < r.seconds.size(); ++k) {
+            file << (k ? ", " : "") << r.seconds[k];
+        }
+        file << "]}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+}
+
+/**
+ * @brief ligne d'export relue pour la vérification des lots : extrémités telles qu'écrites, chemin en numérotation interne
+ */
+struct ExportRow
+{
+    string start, goal;
+    bool found = false;
+    vector<Vertex> path;
+};
+
+static bool read_export_rows(const string &filename, const VertexNumbering &numbering, vector<ExportRow> &rows)
+{
+    ifstream file(filename);
+    string line;
+    if (!getline(file, line)) {
+        return false;
+    }
+    rows.clear();
+    while (getline(file, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        ExportRow row;
+        string length, path;
+        stringstream ss(line);
+        getline(ss, row.start, ';');
+        getline(ss, row.goal, ';');
+        getline(ss, length, ';');
+        getline(ss, path);
+        row.found = length != "Inf";
+        if (row.found && path.size() >= 2) {
+            stringstream ids(path.substr(1, path.size() - 2));
+            string id;
+            while (getline(ids, id, ',')) {
+                row.path.push_back(numbering.internal(static_cast<Vertex>(stoull(id) - 1)));
+            }
+        }
+        rows.push_back(std::move(row));
+    }
+    return true;
+}
+
+/**
+ * @brief longueur d'un chemin sur le graph, sommée dans l'ordre du chemin (infinie si un arc manque)
+ */
+static double path_length_on(const CSRGraph &g, const vector<Vertex> &path)
+{
+    auto weight = boost::get(boost::edge_weight, g);
+    double length = 0;
+    for (size_t i = 1; i < path.size(); ++i) {
+        double best = numeric_limits<double>::infinity();
+        for (auto [ei, ei_end] = out_edges(static_cast<CSRVertex>(path[i - 1]), g); ei != ei_end; ++ei) {
+            if (target(*ei, g) == path[i]) {
+                best = min(best, double(get(weight, *ei)));
+            }
+        }
+        length += best;
+    }
+    return length;
+}
+
+static bool same_length(double a, double b)
+{
+    return a == b || fabs(a - b) <= 1e-9 * max(fabs(a), fabs(b));
+}
+
+static bool same_metrics(const GraphMetrics &a, const GraphMetrics &b)
+{
+    return a.num_vertices == b.num_vertices && a.num_arcs == b.num_arcs && a.min_degree == b.min_degree &&
+           a.max_degree == b.max_degree && same_length(a.mean_degree, b.mean_degree) &&
+           same_length(a.degree_stddev, b.degree_stddev) && a.median_degree == b.median_degree &&
+           a.isolated_vertices == b.isolated_vertices && a.degree_histogram == b.degree_histogram &&
+           a.min_weight == b.min_weight && a.max_weight == b.max_weight && same_length(a.mean_weight, b.mean_weight) &&
+           a.num_components == b.num_components && a.component_sizes == b.component_sizes;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        cerr << "Usage : " << argv[0] << " <répertoire> [--repeat N] [--queries Q] [--export-sources S] [--sssp-sources K] [--updates U] [--engine E] [--reorder O] [--weights P] [--graph R] [--threads T] [--seed G] [--json fichier]" << endl;
+        return 1;
+    }
+
+    string directory = argv[1];
+    unsigned repeat = 5, threads = 0;
+    size_t queries = 1000, export_sources = 100, sssp_sources = 20, update_ops = 300;
+    uint64_t seed = 1;
+    string json;
+    VertexOrdering ordering = VertexOrdering::None;
+    WeightPrecision precision = WeightPrecision::Double;
+    bool compact = false;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        if (arg == "--repeat") repeat = max(1, atoi(argv[i + 1]));
+        else if (arg == "--queries") queries = strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--export-sources") export_sources = strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--sssp-sources") sssp_sources = strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--updates") update_ops = strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--engine") {
+            SearchEngine engine;
+            if (!parse_search_engine(argv[i + 1], engine)) {
+                cerr << "File de priorité inconnue : " << argv[i + 1] << endl;
+                return 1;
+            }
+            set_default_search_engine(engine);
+        }
+        else if (arg == "--reorder") {
+            if (!parse_vertex_ordering(argv[i + 1], ordering)) {
+                cerr << "Ordre des sommets inconnu : " << argv[i + 1] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--weights") {
+            if (!parse_weight_precision(argv[i + 1], precision)) {
+                cerr << "Précision des poids inconnue : " << argv[i + 1] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--graph") {
+            string representation = argv[i + 1];
+            if (representation != "csr" && representation != "compact") {
+                cerr << "Représentation du graph inconnue : " << representation << endl;
+                return 1;
+            }
+            compact = representation == "compact";
+        }
+        else if (arg == "--threads") threads = atoi(argv[i + 1]);
+        else if (arg == "--seed") seed = strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--json") json = argv[i + 1];
+        else {
+            cerr << "Option inconnue : " << arg << endl;
+            return 1;
+        }
+    }
+
+    const string filename_nodes = directory + "/nodes.csv";
+    const string filename_edges = directory + "/edges.csv";
+    vector<BenchResult> results;
+
+    CoordinateStore coord_list;
+    vector<pair<int, int>> edge_list;
+    bool load_ok = true;
+    results.push_back(measure("csv_load", repeat, 0, [&] {
+        coord_list.clear();
+        edge_list.clear();
+    }, [&] {
+        CSVLoadResult nodes_result = load_nodes_csv(filename_nodes, coord_list, threads);
+        CSVLoadResult edges_result = load_edges_csv(filename_edges, edge_list, coord_list.size(), threads);
+        load_ok = nodes_result.ok() && edges_result.ok();
+    }));
+    if (!load_ok || coord_list.empty()) {
+        cerr << "Chargement de '" << directory << "' impossible" << endl;
+        return 1;
+    }
+    size_t n = coord_list.size();
+    results.back().items = n + edge_list.size();
+
+    vector<float> weights(edge_list.size());
+    results.push_back(measure("edge_weights_scalar", repeat, edge_list.size(), [] {}, [&] {
+        for (size_t e = 0; e < edge_list.size(); ++e) {
+            weights[e] = static_cast<float>(calcul_distance(edge_list[e].first, edge_list[e].second, coord_list));
+        }
+    }));
+    results.push_back(measure("edge_weights", repeat, edge_list.size(), [] {}, [&] {
+        compute_edge_weights(coord_list, edge_list, weights, precision, threads);
+    }));
+    cout << "  edge weight kernel: " << edge_weight_kernel_name() << ", " << weight_precision_name(precision) << " precision" << endl;
+
+    // Index spatial : sommet le plus proche de positions aléatoires, comparé au parcours linéaire
+    SpatialIndex spatial;
+    results.push_back(measure("spatial_index_build", repeat, n, [] {}, [&] { spatial = SpatialIndex::build(coord_list); }));
+    if (queries > 0) {
+        mt19937_64 rng(seed);
+        uniform_real_distribution<double> unit(0, 1);
+        vector<array<double, 3>> positions(queries);
+        for (auto &p : positions) {
+            uint32_t v = static_cast<uint32_t>(rng() % n);
+            p = {coord_list.x(v) + unit(rng) - 0.5, coord_list.y(v) + unit(rng) - 0.5, coord_list.z(v)};
+        }
+        vector<NearestVertex> linear(queries), nearest;
+        results.push_back(measure("nearest_linear_scan", repeat, queries, [] {}, [&] {
+            for (size_t i = 0; i < queries; ++i) {
+                NearestVertex best{0, numeric_limits<double>::infinity()};
+                for (uint32_t v = 0; v < n; ++v) {
+                    double dx = coord_list.x(v) - positions[i][0], dy = coord_list.y(v) - positions[i][1], dz = coord_list.z(v) - positions[i][2];
+                    double d = dx * dx + dy * dy + dz * dz;
+                    if (d < best.distance) {
+                        best = {v, d};
+                    }
+                }
+                linear[i] = best;
+            }
+        }));
+        results.push_back(measure("nearest_kdtree", repeat, queries, [] {}, [&] { snap_to_vertices(spatial, positions, nearest, 1); }));
+        size_t mismatches = 0;
+        for (size_t i = 0; i < queries; ++i) {
+            mismatches += nearest[i].vertex != linear[i].vertex;
+        }
+        if (mismatches > 0) {
+            cerr << "Sommets les plus proches différents du parcours linéaire pour " << mismatches << " positions" << endl;
+        }
+        cout << "  spatial index memory: " << spatial.memory_used() << " bytes" << endl;
+    }
+
+    // Construction et mesures suivantes sur le graph CSR ou compact
+    size_t arcs = 0;
+    bool updates_ok = true;
+    auto run_graph = [&](auto &g) {
+        using G = std::decay_t<decltype(g)>;
+        results.push_back(measure("graph_build", repeat, edge_list.size(), [] {}, [&] {
+            if constexpr (std::is_same_v<G, CompactGraph>) {
+                g = build_compact(n, edge_list, weights);
+            } else {
+                g = build_csr(n, edge_list, weights);
+            }
+        }));
+        arcs = num_edges(g);
+        cout << directory << ": " << n << " vertices, " << arcs << " arcs" << endl;
+        if constexpr (std::is_same_v<G, CompactGraph>) {
+            cout << "  graph memory (compact): " << g.memory_used() << " bytes" << endl;
+        } else {
+            cout << "  graph memory (CSR): " << csr_memory_used(g) << " bytes" << endl;
+        }
+        VertexNumbering numbering;
+        if (ordering != VertexOrdering::None) {
+            ReorderReport report;
+            numbering = reorder_vertices(g, coord_list, ordering, numbering, report);
+            print_reorder_report(cout, report);
+        }
+
+        // Mêmes couples aléatoires pour chaque mode
+        mt19937_64 rng(seed);
+        uniform_int_distribution<size_t> pick(0, n - 1);
+        vector<pair<Vertex, Vertex>> pairs(queries);
+        for (auto &p : pairs) {
+            p = {pick(rng), pick(rng)};
+        }
+
+        if (queries > 0) {
+            for (SearchMode mode : {SearchMode::Dijkstra, SearchMode::AStar, SearchMode::Bidirectional}) {
+                SearchScratch scratch;
+                size_t settled = 0;
+                string name = string("query_") + (mode == SearchMode::Dijkstra ? "dijkstra" : mode == SearchMode::AStar ? "astar" : "bidirectional");
+                results.push_back(measure(name, repeat, queries, [&] { settled = 0; }, [&] {
+                    for (const auto &[s, t] : pairs) {
+                        settled += shortest_path_query(g, coord_list, s, t, mode, scratch).settled;
+                    }
+                }));
+                cout << "  settled vertices per query: " << settled / queries << endl;
+            }
+        }
+
+        // Recherches complètes : mêmes sources pour chaque file de priorité, distances identiques attendues
+        if (sssp_sources > 0) {
+            vector<Vertex> sources(sssp_sources);
+            for (auto &s : sources) {
+                s = pick(rng);
+            }
+            vector<vector<double>> reference(sources.size());
+            for (SearchEngine engine : {SearchEngine::BinaryHeap, SearchEngine::RadixHeap, SearchEngine::BucketQueue, SearchEngine::DeltaStepping}) {
+                SearchScratch scratch;
+                scratch.engine = engine;
+                scratch.engine_threads = threads;
+                size_t mismatches = 0;
+                results.push_back(measure(string("sssp_") + search_engine_name(engine), repeat, sources.size(), [&] { mismatches = 0; }, [&] {
+                    for (size_t k = 0; k < sources.size(); ++k) {
+                        dijkstra_to_goals(g, sources[k], {}, scratch);
+                        if (engine == SearchEngine::BinaryHeap) {
+                            reference[k] = scratch.distances;
+                        } else if (scratch.distances != reference[k]) {
+                            mismatches++;
+                        }
+                    }
+                }));
+                if (mismatches > 0) {
+                    cerr << "Distances différentes du tas binaire pour " << mismatches << " sources (" << search_engine_name(engine) << ")" << endl;
+                }
+            }
+        }
+
+        // Export : toutes les arrivées des premières sources, dans l'ordre de compute_graph
+        vector<pair<double, double>> list_Node;
+        for (size_t i = 0; i < min(n, export_sources); ++i) {
+            for (size_t j = i + 1; j < n; ++j) {
+                list_Node.push_back({i + 1.0, j + 1.0});
+            }
+        }
+        if (!list_Node.empty()) {
+            string output = directory + "/bench_output.csv";
+            results.push_back(measure("all_pairs_export", repeat, list_Node.size(), [] {}, [&] {
+                CSVOuptutFunction(g, list_Node, coord_list, numbering, output, threads);
+            }));
+            remove(output.c_str());
+        }
+
+        results.push_back(measure("metrics", repeat, n, [] {}, [&] {
+            GraphMetrics metrics = compute_metrics(g, threads);
+            if (metrics.num_vertices != n) {
+                cerr << "Métriques incohérentes" << endl;
+            }
+        }));
+
+        // Lot aléatoire sur le graph CSR : export corrigé, arbres réparés et métriques incrémentales comparés
+        // à un recalcul complet sur le graph modifié (chemins de même longueur acceptés)
+        if constexpr (std::is_same_v<G, CSRGraph>) {
+            if (update_ops == 0 || n < 2) {
+                return;
+            }
+            string output = directory + "/bench_updates.csv";
+            string reference_output = directory + "/bench_updates_reference.csv";
+            if (!list_Node.empty()) {
+                CSVOuptutFunction(g, list_Node, coord_list, numbering, output, threads);
+            }
+            ShortestPathTreeCache cache;
+            SearchScratch scratch;
+            vector<Vertex> tree_sources(max<size_t>(sssp_sources, 1));
+            for (auto &s : tree_sources) {
+                s = pick(rng);
+                cache.tree(g, s, scratch);
+            }
+            IncrementalMetrics incremental(g, threads);
+
+            // Fermetures et changements de poids d'arêtes existantes, ouvertures entre sommets quelconques,
+            // chaque paire de sommets touchée une seule fois
+            uniform_real_distribution<double> factor(0.5, 2.0);
+            auto weight = boost::get(boost::edge_weight, g);
+            vector<EdgeUpdate> updates;
+            set<pair<Vertex, Vertex>> touched;
+            for (size_t k = 0; k < update_ops; ++k) {
+                EdgeUpdate update;
+                Vertex u = pick(rng);
+                if (k % 3 == 2) {
+                    update.kind = EdgeUpdateKind::Insert;
+                    update.v = pick(rng);
+                    update.weight = calcul_distance(u, update.v, coord_list) * factor(rng);
+                } else {
+                    size_t degree = out_degree(static_cast<CSRVertex>(u), g);
+                    if (degree == 0) {
+                        continue;
+                    }
+                    auto ei = next(out_edges(static_cast<CSRVertex>(u), g).first, rng() % degree);
+                    update.kind = k % 3 == 0 ? EdgeUpdateKind::Delete : EdgeUpdateKind::Reweight;
+                    update.v = target(*ei, g);
+                    update.weight = get(weight, *ei) * factor(rng);
+                }
+                update.u = u;
+                if (u == update.v || !touched.insert(minmax(u, update.v)).second) {
+                    continue;
+                }
+                updates.push_back(update);
+            }
+
+            vector<ArcChange> changes;
+            size_t repaired = 0;
+            ExportUpdateResult patched;
+            results.push_back(measure("updates_apply", 1, updates.size(), [] {}, [&] { changes = apply_edge_updates(g, updates, numbering); }));
+            results.push_back(measure("updates_repair_trees", 1, tree_sources.size(), [] {}, [&] { repaired = repair_tree_cache(g, changes, cache); }));
+            results.push_back(measure("updates_metrics", 1, changes.size(), [] {}, [&] { incremental.apply(g, changes); }));
+            if (!list_Node.empty()) {
+                results.push_back(measure("updates_export", 1, list_Node.size(), [] {}, [&] {
+                    patched = update_export_csv(g, numbering, changes, output, threads);
+                }));
+            }
+            cout << "  updates: " << updates.size() << " operations, " << changes.size() << " vertex pairs changed, " << repaired
+                 << " trees repaired, " << patched.recomputed << " export rows recomputed" << endl;
+
+            size_t export_mismatches = 0, equal_paths = 0, tree_mismatches = 0;
+            if (!list_Node.empty()) {
+                CSVOuptutFunction(g, list_Node, coord_list, numbering, reference_output, threads);
+                vector<ExportRow> rows, reference;
+                if (!patched.ok || !read_export_rows(output, numbering, rows) || !read_export_rows(reference_output, numbering, reference) ||
+                    rows.size() != reference.size()) {
+                    export_mismatches = list_Node.size();
+                } else {
+                    for (size_t i = 0; i < rows.size(); ++i) {
+                        const ExportRow &row = rows[i], &expected = reference[i];
+                        bool same = row.start == expected.start && row.goal == expected.goal && row.found == expected.found;
+                        if (same && row.found) {
+                            same = !row.path.empty() && row.path.front() == expected.path.front() && row.path.back() == expected.path.back() &&
+                                   same_length(path_length_on(g, row.path), path_length_on(g, expected.path));
+                        }
+                        export_mismatches += !same;
+                        equal_paths += same && row.path != expected.path;
+                    }
+                }
+                remove(output.c_str());
+                remove(reference_output.c_str());
+            }
+            for (Vertex s : tree_sources) {
+                std::shared_ptr<const ShortestPathTree> tree = cache.find(s);
+                dijkstra_to_goals(g, s, {}, scratch);
+                bool same = tree && tree->distances.size() == n;
+                for (size_t v = 0; same && v < n; ++v) {
+                    same = same_length(tree->distances[v], scratch.distances[v]);
+                }
+                tree_mismatches += !same;
+            }
+            bool metrics_ok = same_metrics(incremental.metrics(), compute_metrics(g, threads));
+
+            if (equal_paths > 0) {
+                cout << "  patched export rows with another path of the same length: " << equal_paths << endl;
+            }
+            if (export_mismatches > 0) {
+                cerr << "Export corrigé différent du recalcul complet pour " << export_mismatches << " lignes" << endl;
+            }
+            if (tree_mismatches > 0) {
+                cerr << "Arbres réparés différents du recalcul complet pour " << tree_mismatches << " sources" << endl;
+            }
+            if (!metrics_ok) {
+                cerr << "Métriques incrémentales différentes du recalcul complet" << endl;
+            }
+            updates_ok = export_mismatches == 0 && tree_mismatches == 0 && metrics_ok;
+        }
+    };
+    if (compact) {
+        CompactGraph g;
+        run_graph(g);
+    } else {
+        CSRGraph g;
+        run_graph(g);
+    }
+
+    if (!json.empty()) {
+        write_json(json, directory, n, arcs, threads, results);
+        cout << "Results written to '" << json << "'" << endl;
+    }
+    return updates_ok ? 0 : 1;
+}
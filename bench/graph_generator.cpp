@@ -0,0 +1,255 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <algorithm>
+
+using namespace std;
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief générateur de graphs synthétiques au format de data/ (nodes.csv "id;x;y;z", edges.csv "source;target")
+ *
+ * Usage : graph_generator <rgg|grid|scalefree> <sommets> <graine> <répertoire> [degré]
+ *
+ * rgg : graph géométrique aléatoire 3D, points uniformes reliés sous un rayon choisi pour le degré moyen visé (6 par défaut)
+ * grid : grille 2D de côté ceil(sqrt(n)) aux coordonnées légèrement perturbées, une arête manquante sur 10
+ * scalefree : attachement préférentiel de Barabási-Albert, chaque nouveau sommet reçoit degré / 2 arêtes (3 par défaut)
+ *
+ * Les coordonnées x et y couvrent [0, 1000 * sqrt(n / 100)] pour garder une densité d'affichage constante,
+ * z couvre [-1000, 1000] comme l'échelle de couleur de l'interface.
+ */
+
+struct Point
+{
+    double x, y, z;
+};
+
+static void append_number(string &out, double value)
+{
+    char buffer[32];
+    auto [end, ec] = to_chars(buffer, buffer + sizeof(buffer), value, chars_format::fixed, 3);
+    out.append(buffer, end);
+}
+
+static void append_number(string &out, size_t value)
+{
+    char buffer[24];
+    auto [end, ec] = to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, end);
+}
+
+static bool write_nodes(const string &filename, const vector<Point> &points)
+{
+    ofstream file(filename, ios::out | ios::binary | ios::trunc);
+    string out = "id;x;y;z\n";
+    for (size_t i = 0; i < points.size(); ++i) {
+        append_number(out, i + 1);
+        out += ';';
+        append_number(out, points[i].x);
+        out += ';';
+        append_number(out, points[i].y);
+        out += ';';
+        append_number(out, points[i].z);
+        out += '\n';
+        if (out.size() >= (1 << 20)) {
+            file.write(out.data(), out.size());
+            out.clear();
+        }
+    }
+    file.write(out.data(), out.size());
+    return static_cast<bool>(file);
+}
+
+static bool write_edges(const string &filename, const vector<pair<size_t, size_t>> &edges)
+{
+    ofstream file(filename, ios::out | ios::binary | ios::trunc);
+    string out = "source;target\n";
+    for (const auto &[a, b] : edges) {
+        append_number(out, a + 1);
+        out += ';';
+        append_number(out, b + 1);
+        out += '\n';
+        if (out.size() >= (1 << 20)) {
+            file.write(out.data(), out.size());
+            out.clear();
+        }
+    }
+    file.write(out.data(), out.size());
+    return static_cast<bool>(file);
+}
+
+static vector<Point> random_points(size_t n, double side, mt19937_64 &rng)
+{
+    uniform_real_distribution<double> xy(0, side), z(-1000, 1000);
+    vector<Point> points(n);
+    for (auto &p : points) {
+        p = {xy(rng), xy(rng), z(rng)};
+    }
+    return points;
+}
+
+/**
+ * @brief graph géométrique aléatoire : paires à distance euclidienne 3D inférieure au rayon, recherche par cases
+ */
+static void random_geometric(size_t n, double degree, double side, mt19937_64 &rng, vector<Point> &points, vector<pair<size_t, size_t>> &edges)
+{
+    points = random_points(n, side, rng);
+    const double PI = 3.14159265358979323846;
+    double volume = side * side * 2000.0;
+    double radius = cbrt(3.0 * degree * volume / (4.0 * PI * max<size_t>(n, 1)));
+
+    size_t cx = max<size_t>(1, static_cast<size_t>(side / radius));
+    size_t cz = max<size_t>(1, static_cast<size_t>(2000.0 / radius));
+    auto cell_of = [&](const Point &p, size_t &ix, size_t &iy, size_t &iz) {
+        ix = min(cx - 1, static_cast<size_t>(p.x / side * cx));
+        iy = min(cx - 1, static_cast<size_t>(p.y / side * cx));
+        iz = min(cz - 1, static_cast<size_t>((p.z + 1000.0) / 2000.0 * cz));
+    };
+
+    // Rangement des points par case (tri par dénombrement)
+    size_t num_cells = cx * cx * cz;
+    vector<size_t> offsets(num_cells + 1, 0), cell(n), order(n);
+    for (size_t i = 0; i < n; ++i) {
+        size_t ix, iy, iz;
+        cell_of(points[i], ix, iy, iz);
+        cell[i] = (iz * cx + iy) * cx + ix;
+        offsets[cell[i] + 1]++;
+    }
+    for (size_t c = 0; c < num_cells; ++c) {
+        offsets[c + 1] += offsets[c];
+    }
+    vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        order[cursor[cell[i]]++] = i;
+    }
+
+    double r2 = radius * radius;
+    for (size_t i = 0; i < n; ++i) {
+        size_t ix, iy, iz;
+        cell_of(points[i], ix, iy, iz);
+        for (size_t z = iz ? iz - 1 : 0; z <= min(cz - 1, iz + 1); ++z) {
+            for (size_t y = iy ? iy - 1 : 0; y <= min(cx - 1, iy + 1); ++y) {
+                for (size_t x = ix ? ix - 1 : 0; x <= min(cx - 1, ix + 1); ++x) {
+                    size_t c = (z * cx + y) * cx + x;
+                    for (size_t k = offsets[c]; k < offsets[c + 1]; ++k) {
+                        size_t j = order[k];
+                        if (j <= i) {
+                            continue;
+                        }
+                        double dx = points[i].x - points[j].x, dy = points[i].y - points[j].y, dz = points[i].z - points[j].z;
+                        if (dx * dx + dy * dy + dz * dz <= r2) {
+                            edges.emplace_back(i, j);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void grid(size_t n, double side, mt19937_64 &rng, vector<Point> &points, vector<pair<size_t, size_t>> &edges)
+{
+    size_t w = static_cast<size_t>(ceil(sqrt(double(n))));
+    double step = side / w;
+    uniform_real_distribution<double> jitter(-0.3 * step, 0.3 * step), z(-1000, 1000), keep(0, 1);
+    points.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        points[i] = {(i % w + 0.5) * step + jitter(rng), (i / w + 0.5) * step + jitter(rng), z(rng)};
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (i % w + 1 < w && i + 1 < n && keep(rng) < 0.9) {
+            edges.emplace_back(i, i + 1);
+        }
+        if (i + w < n && keep(rng) < 0.9) {
+            edges.emplace_back(i, i + w);
+        }
+    }
+}
+
+static void scale_free(size_t n, double degree, double side, mt19937_64 &rng, vector<Point> &points, vector<pair<size_t, size_t>> &edges)
+{
+    points = random_points(n, side, rng);
+    size_t m = max<size_t>(1, static_cast<size_t>(degree / 2 + 0.5));
+
+    // Extrémités de toutes les arêtes : un tirage uniforme dans ce tableau suit la loi des degrés
+    vector<size_t> endpoints;
+    endpoints.reserve(2 * m * n);
+    size_t core = min(n, m + 1);
+    for (size_t i = 0; i < core; ++i) {
+        for (size_t j = i + 1; j < core; ++j) {
+            edges.emplace_back(i, j);
+            endpoints.push_back(i);
+            endpoints.push_back(j);
+        }
+    }
+
+    vector<size_t> targets;
+    for (size_t v = core; v < n; ++v) {
+        targets.clear();
+        while (targets.size() < m) {
+            size_t t = endpoints[uniform_int_distribution<size_t>(0, endpoints.size() - 1)(rng)];
+            if (find(targets.begin(), targets.end(), t) == targets.end()) {
+                targets.push_back(t);
+            }
+        }
+        for (size_t t : targets) {
+            edges.emplace_back(t, v);
+            endpoints.push_back(t);
+            endpoints.push_back(v);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 5) {
+        cerr << "Usage : " << argv[0] << " <rgg|grid|scalefree> <sommets> <graine> <répertoire> [degré]" << endl;
+        return 1;
+    }
+
+    string type = argv[1];
+    size_t n = strtoull(argv[2], nullptr, 10);
+    uint64_t seed = strtoull(argv[3], nullptr, 10);
+    string directory = argv[4];
+    double degree = argc > 5 ? strtod(argv[5], nullptr) : 6.0;
+    if (n < 2 || degree <= 0) {
+        cerr << "Paramètres invalides" << endl;
+        return 1;
+    }
+
+    mt19937_64 rng(seed);
+    double side = 1000.0 * sqrt(n / 100.0);
+    vector<Point> points;
+    vector<pair<size_t, size_t>> edges;
+
+    if (type == "rgg") {
+        random_geometric(n, degree, side, rng, points, edges);
+    } else if (type == "grid") {
+        grid(n, side, rng, points, edges);
+    } else if (type == "scalefree") {
+        scale_free(n, degree, side, rng, points, edges);
+    } else {
+        cerr << "Type de graph inconnu : " << type << endl;
+        return 1;
+    }
+
+    // Arêtes mélangées : l'ordre du fichier ne doit pas favoriser la construction du graph
+    shuffle(edges.begin(), edges.end(), rng);
+
+    error_code ec;
+    fs::create_directories(directory, ec);
+    if (!write_nodes(directory + "/nodes.csv", points) || !write_edges(directory + "/edges.csv", edges)) {
+        cerr << "Impossible d'écrire dans '" << directory << "'" << endl;
+        return 1;
+    }
+
+    cout << type << " graph: " << n << " vertices, " << edges.size() << " edges (seed " << seed << ") -> " << directory << endl;
+    return 0;
+}
@@ -0,0 +1,271 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+using namespace std;
+
+/**
+ * @brief générateur de charge pour graph_server : requêtes aléatoires en pipeline sur plusieurs connexions
+ *
+ * Usage : load_generator [--socket P] [--connections C] [--requests R] [--pipeline W] [--mode M] [--seed G] [--json F]
+ *
+ * Chaque connexion envoie R requêtes en gardant au plus W requêtes sans réponse ; la latence d'une requête
+ * va de l'envoi de sa ligne à la réception de sa réponse. Débit et centiles de latence sont affichés,
+ * et écrits au format JSON si demandé.
+ */
+
+#ifndef _WIN32
+
+using Clock = chrono::steady_clock;
+
+struct ConnectionResult
+{
+    vector<double> latencies_us;
+    size_t errors = 0;
+    bool failed = false;
+};
+
+static int connect_to(const string &socket_path)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool send_all(int fd, const string &data)
+{
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t k = ::send(fd, data.data() + sent, data.size() - sent, 0);
+        if (k < 0 && errno == EINTR) {
+            continue;
+        }
+        if (k <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(k);
+    }
+    return true;
+}
+
+/**
+ * @brief lecture d'une ligne de réponse complète (sans le '\n')
+ */
+static bool read_line(int fd, string &pending, string &line)
+{
+    char buffer[4096];
+    for (;;) {
+        size_t nl = pending.find('\n');
+        if (nl != string::npos) {
+            line.assign(pending, 0, nl);
+            pending.erase(0, nl + 1);
+            return true;
+        }
+        ssize_t k = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (k < 0 && errno == EINTR) {
+            continue;
+        }
+        if (k <= 0) {
+            return false;
+        }
+        pending.append(buffer, static_cast<size_t>(k));
+    }
+}
+
+static void run_connection(const string &socket_path, const string &mode, size_t num_vertices, size_t requests, size_t pipeline, uint64_t seed, ConnectionResult &result)
+{
+    int fd = connect_to(socket_path);
+    if (fd < 0) {
+        result.failed = true;
+        return;
+    }
+
+    string pending, line;
+    if (!mode.empty() && (!send_all(fd, "MODE " + mode + "\n") || !read_line(fd, pending, line) || line != "OK")) {
+        cerr << "Mode refusé par le serveur : " << line << endl;
+        result.failed = true;
+        ::close(fd);
+        return;
+    }
+
+    mt19937_64 rng(seed);
+    uniform_int_distribution<size_t> pick(1, num_vertices);
+    deque<Clock::time_point> in_flight;
+    result.latencies_us.reserve(requests);
+    size_t sent = 0;
+    string batch;
+    char buffer[1 << 16];
+
+    while (result.latencies_us.size() < requests) {
+        // Fenêtre complétée par un seul envoi
+        batch.clear();
+        auto now = Clock::now();
+        while (sent < requests && in_flight.size() < pipeline) {
+            batch += to_string(pick(rng));
+            batch += ' ';
+            batch += to_string(pick(rng));
+            batch += '\n';
+            in_flight.push_back(now);
+            sent++;
+        }
+        if (!batch.empty() && !send_all(fd, batch)) {
+            result.failed = true;
+            break;
+        }
+
+        ssize_t k = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (k < 0 && errno == EINTR) {
+            continue;
+        }
+        if (k <= 0) {
+            result.failed = true;
+            break;
+        }
+        auto received = Clock::now();
+        pending.append(buffer, static_cast<size_t>(k));
+        size_t line_begin = 0;
+        for (size_t nl; (nl = pending.find('\n', line_begin)) != string::npos; line_begin = nl + 1) {
+            if (pending.compare(line_begin, 3, "ERR") == 0) {
+                result.errors++;
+            }
+            result.latencies_us.push_back(chrono::duration<double, micro>(received - in_flight.front()).count());
+            in_flight.pop_front();
+        }
+        pending.erase(0, line_begin);
+    }
+
+    send_all(fd, "QUIT\n");
+    ::close(fd);
+}
+
+static double percentile(const vector<double> &sorted, double p)
+{
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = min(sorted.size() - 1, static_cast<size_t>(p / 100.0 * sorted.size()));
+    return sorted[index];
+}
+
+int main(int argc, char *argv[])
+{
+    string socket_path = "/tmp/graph_analysis.sock";
+    string mode, json;
+    size_t num_connections = 4, requests = 10000, pipeline = 32;
+    uint64_t seed = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--socket" && has_value) socket_path = argv[++i];
+        else if (arg == "--connections" && has_value) num_connections = max<size_t>(1, strtoull(argv[++i], nullptr, 10));
+        else if (arg == "--requests" && has_value) requests = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--pipeline" && has_value) pipeline = max<size_t>(1, strtoull(argv[++i], nullptr, 10));
+        else if (arg == "--mode" && has_value) mode = argv[++i];
+        else if (arg == "--seed" && has_value) seed = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--json" && has_value) json = argv[++i];
+        else {
+            cerr << "Usage : " << argv[0] << " [--socket P] [--connections C] [--requests R] [--pipeline W] [--mode M] [--seed G] [--json F]" << endl;
+            return 1;
+        }
+    }
+
+    // Taille du graph servi, pour tirer des couples valides
+    int fd = connect_to(socket_path);
+    if (fd < 0) {
+        cerr << "Connexion impossible à '" << socket_path << "' : " << strerror(errno) << endl;
+        return 1;
+    }
+    string pending, line;
+    size_t num_vertices = 0;
+    if (!send_all(fd, "STATS\nQUIT\n") || !read_line(fd, pending, line) || sscanf(line.c_str(), "OK vertices %zu", &num_vertices) != 1 || num_vertices == 0) {
+        cerr << "Réponse inattendue du serveur : " << line << endl;
+        ::close(fd);
+        return 1;
+    }
+    ::close(fd);
+
+    vector<ConnectionResult> results(num_connections);
+    vector<thread> clients;
+    auto start = Clock::now();
+    for (size_t c = 0; c < num_connections; ++c) {
+        clients.emplace_back(run_connection, socket_path, mode, num_vertices, requests, pipeline, seed + c, std::ref(results[c]));
+    }
+    for (auto &t : clients) {
+        t.join();
+    }
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    vector<double> latencies;
+    size_t errors = 0, failed = 0;
+    for (const auto &r : results) {
+        latencies.insert(latencies.end(), r.latencies_us.begin(), r.latencies_us.end());
+        errors += r.errors;
+        failed += r.failed;
+    }
+    sort(latencies.begin(), latencies.end());
+    double mean = 0;
+    for (double l : latencies) mean += l;
+    mean = latencies.empty() ? 0 : mean / latencies.size();
+
+    printf("%zu requests on %zu connections (pipeline %zu) in %.3f s: %.0f requests/s\n",
+           latencies.size(), num_connections, pipeline, seconds, latencies.size() / seconds);
+    printf("latency (us): mean %.1f  p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n", mean,
+           percentile(latencies, 50), percentile(latencies, 90), percentile(latencies, 99), latencies.empty() ? 0.0 : latencies.back());
+    if (errors || failed) {
+        printf("%zu error responses, %zu failed connections\n", errors, failed);
+    }
+
+    if (!json.empty()) {
+        ofstream file(json, ios::out | ios::trunc);
+        if (!file.is_open()) {
+            cerr << "Impossible d'ouvrir le fichier '" << json << "'" << endl;
+            return 1;
+        }
+        file.precision(9);
+        file << "{\n  \"socket\": \"" << socket_path << "\",\n  \"vertices\": " << num_vertices
+             << ",\n  \"connections\": " << num_connections << ",\n  \"pipeline\": " << pipeline
+             << ",\n  \"requests\": " << latencies.size() << ",\n  \"errors\": " << errors << ",\n  \"failed_connections\": " << failed
+             << ",\n  \"seconds\": " << seconds << ",\n  \"requests_per_second\": " << latencies.size() / seconds
+             << ",\n  \"latency_us\": {\"mean\": " << mean << ", \"p50\": " << percentile(latencies, 50)
+             << ", \"p90\": " << percentile(latencies, 90) << ", \"p99\": " << percentile(latencies, 99)
+             << ", \"max\": " << (latencies.empty() ? 0.0 : latencies.back()) << "}\n}\n";
+    }
+    return failed ? 1 : 0;
+}
+
+#else
+
+int main()
+{
+    cerr << "Le générateur de charge nécessite les sockets Unix, non disponibles sur cette plateforme" << endl;
+    return 1;
+}
+
+#endif
@@ -0,0 +1,235 @@
+#ifndef COMPACT_GRAPH_H
+#define COMPACT_GRAPH_H
+
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <cstdint>
+#include <cstddef>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+
+/**
+ * @brief graph non orienté économe en mémoire : chaque arête stockée une seule fois, sommets et arêtes sur 32 bits
+ *
+ * Les arêtes sont rangées par extrémité basse ; chacune garde le ou exclusif de ses deux extrémités et son poids
+ * (8 octets), ce qui donne sa cible depuis l'une comme depuis l'autre. L'extrémité haute retrouve ses arêtes par
+ * un index inverse de 4 octets par arête. Un bit par arc restitue l'ordre des arcs du graph CSR construit à partir
+ * des mêmes données, si bien que les parcours, et leurs départages entre chemins de même longueur, sont ceux du
+ * graph CSR. Soit 12 octets et 2 bits par arête et 8 octets par sommet, contre 16 et 8 pour le graph CSR.
+ *
+ * Vu par les algorithmes (interface Boost Graph) comme un graph orienté symétrique : num_edges compte les arcs,
+ * deux par arête, comme pour le graph CSR. Au plus 2^32 - 1 sommets et 2^32 - 1 arêtes.
+ */
+class CompactGraph
+{
+public:
+    /**
+     * @brief arc source -> target et poids de son arête (descripteur d'arc de l'interface Boost Graph)
+     */
+    struct Arc
+    {
+        uint32_t source;
+        uint32_t target;
+        float weight;
+    };
+
+    /**
+     * @brief arcs sortants d'un sommet, dans l'ordre du graph CSR
+     */
+    class OutArcIterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Arc;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Arc *;
+        using reference = Arc;
+
+        OutArcIterator() = default;
+        OutArcIterator(const CompactGraph *g, uint32_t source, uint64_t arc, uint32_t next_edge, uint32_t next_reverse)
+            : g(g), source(source), arc(arc), next_edge(next_edge), next_reverse(next_reverse) {}
+
+        Arc operator*() const
+        {
+            const EdgeRecord &edge = g->edge_records[forward() ? next_edge : g->reverse_edges[next_reverse]];
+            return {source, edge.ends ^ source, edge.weight};
+        }
+
+        OutArcIterator &operator++()
+        {
+            if (forward()) {
+                ++next_edge;
+            } else {
+                ++next_reverse;
+            }
+            ++arc;
+            return *this;
+        }
+
+        bool operator==(const OutArcIterator &other) const { return arc == other.arc; }
+        bool operator!=(const OutArcIterator &other) const { return arc != other.arc; }
+
+    protected:
+        // Arc rangé avec les arêtes de son sommet (extrémité basse) ou trouvé par l'index inverse
+        bool forward() const { return g->forward_arcs[arc >> 6] >> (arc & 63) & 1; }
+
+        const CompactGraph *g = nullptr;
+        uint32_t source = 0;
+        uint64_t arc = 0;
+        uint32_t next_edge = 0;
+        uint32_t next_reverse = 0;
+    };
+
+    /**
+     * @brief tous les arcs, sommet par sommet (interface EdgeListGraph)
+     */
+    class ArcIterator : public OutArcIterator
+    {
+    public:
+        ArcIterator() = default;
+        ArcIterator(const CompactGraph *g, uint64_t arc, uint32_t next_edge, uint32_t next_reverse)
+            : OutArcIterator(g, 0, arc, next_edge, next_reverse)
+        {
+            skip_finished_sources();
+        }
+
+        ArcIterator &operator++()
+        {
+            OutArcIterator::operator++();
+            skip_finished_sources();
+            return *this;
+        }
+
+    private:
+        void skip_finished_sources()
+        {
+            while (source + 1 < g->num_vertices() && g->arc_begin(source + 1) <= arc) {
+                ++source;
+            }
+        }
+    };
+
+    /**
+     * @brief poids des arcs (get(edge_weight, g))
+     */
+    struct WeightMap
+    {
+    };
+
+    using vertex_descriptor = uint32_t;
+    using edge_descriptor = Arc;
+    using directed_category = boost::directed_tag;
+    using edge_parallel_category = boost::allow_parallel_edge_tag;
+    struct traversal_category : boost::incidence_graph_tag, boost::vertex_list_graph_tag, boost::edge_list_graph_tag
+    {
+    };
+    using vertex_iterator = boost::counting_iterator<uint32_t>;
+    using out_edge_iterator = OutArcIterator;
+    using edge_iterator = ArcIterator;
+    using vertices_size_type = size_t;
+    using edges_size_type = size_t;
+    using degree_size_type = size_t;
+
+    static vertex_descriptor null_vertex() { return UINT32_MAX; }
+
+    CompactGraph() = default;
+
+    size_t num_vertices() const { return first_edge.empty() ? 0 : first_edge.size() - 1; }
+    size_t num_undirected_edges() const { return edge_records.size(); }
+    size_t num_arcs() const { return 2 * edge_records.size(); }
+
+    /**
+     * @brief premier arc de u, dans la numérotation globale des arcs
+     */
+    uint64_t arc_begin(uint32_t u) const { return uint64_t(first_edge[u]) + first_reverse[u]; }
+
+    std::pair<OutArcIterator, OutArcIterator> out_arcs(uint32_t u) const
+    {
+        return {OutArcIterator(this, u, arc_begin(u), first_edge[u], first_reverse[u]),
+                OutArcIterator(this, u, arc_begin(u + 1), first_edge[u + 1], first_reverse[u + 1])};
+    }
+
+    std::pair<ArcIterator, ArcIterator> arcs() const
+    {
+        uint32_t m = static_cast<uint32_t>(edge_records.size());
+        return {ArcIterator(this, 0, 0, 0), ArcIterator(this, num_arcs(), m, m)};
+    }
+
+    /**
+     * @brief mémoire occupée par composant (octets réservés)
+     */
+    size_t offsets_bytes() const { return (first_edge.capacity() + first_reverse.capacity()) * sizeof(uint32_t); }
+    size_t edges_bytes() const { return edge_records.capacity() * sizeof(EdgeRecord); }
+    size_t reverse_index_bytes() const { return reverse_edges.capacity() * sizeof(uint32_t); }
+    size_t arc_order_bytes() const { return forward_arcs.capacity() * sizeof(uint64_t); }
+    size_t memory_used() const { return offsets_bytes() + edges_bytes() + reverse_index_bytes() + arc_order_bytes(); }
+
+private:
+    friend CompactGraph build_compact(size_t num_vertices, const std::vector<std::pair<int, int>> &edge_list, const std::vector<float> &weights);
+    friend bool build_compact(size_t num_vertices, const uint64_t *offsets, const uint32_t *targets, const float *weights, CompactGraph &g);
+
+    // Arête : ou exclusif des extrémités (0 pour une boucle) et poids
+    struct EdgeRecord
+    {
+        uint32_t ends;
+        float weight;
+    };
+
+    void allocate(size_t num_vertices, size_t num_edges);
+
+    // Arêtes d'extrémité basse u : edge_records[first_edge[u]] .. edge_records[first_edge[u + 1] - 1]
+    std::vector<uint32_t> first_edge;
+    // Arêtes d'extrémité haute v (boucles comprises) : reverse_edges[first_reverse[v]] .. reverse_edges[first_reverse[v + 1] - 1]
+    std::vector<uint32_t> first_reverse;
+    std::vector<uint32_t> reverse_edges;
+    std::vector<EdgeRecord> edge_records;
+    // Bit par arc, arcs d'un sommet à partir de arc_begin : 1 si l'arc est lu dans les arêtes du sommet, 0 dans l'index inverse
+    std::vector<uint64_t> forward_arcs;
+};
+
+/**
+ * @brief construction à partir de la liste d'arêtes non orientées, arcs dans l'ordre de build_csr
+ *
+ * @param num_vertices
+ * @param edge_list arêtes (indices à partir de 0), au plus 2^32 - 1
+ * @param weights poids de chaque arête de edge_list
+ * @return CompactGraph
+ */
+CompactGraph build_compact(size_t num_vertices, const std::vector<std::pair<int, int>> &edge_list, const std::vector<float> &weights);
+
+/**
+ * @brief construction à partir d'arcs en lignes creuses (cache binaire, graph renuméroté), dans le même ordre
+ *
+ * Chaque arc u -> v doit avoir son arc v -> u de même poids ; entre deux sommets, le k-ième arc d'un sens est
+ * associé au k-ième de l'autre.
+ *
+ * @param num_vertices
+ * @param offsets décalages des arcs de chaque sommet (num_vertices + 1)
+ * @param targets cibles des arcs
+ * @param weights poids des arcs
+ * @param g
+ * @return false si les arcs ne sont pas symétriques ou dépassent la capacité du graph
+ */
+bool build_compact(size_t num_vertices, const uint64_t *offsets, const uint32_t *targets, const float *weights, CompactGraph &g);
+
+// Interface Boost Graph (IncidenceGraph, VertexListGraph, EdgeListGraph), trouvée par recherche dépendante des arguments
+
+inline size_t num_vertices(const CompactGraph &g) { return g.num_vertices(); }
+inline size_t num_edges(const CompactGraph &g) { return g.num_arcs(); }
+inline uint32_t source(const CompactGraph::Arc &a, const CompactGraph &) { return a.source; }
+inline uint32_t target(const CompactGraph::Arc &a, const CompactGraph &) { return a.target; }
+inline std::pair<CompactGraph::OutArcIterator, CompactGraph::OutArcIterator> out_edges(uint32_t u, const CompactGraph &g) { return g.out_arcs(u); }
+inline size_t out_degree(uint32_t u, const CompactGraph &g) { return g.arc_begin(u + 1) - g.arc_begin(u); }
+inline std::pair<CompactGraph::ArcIterator, CompactGraph::ArcIterator> edges(const CompactGraph &g) { return g.arcs(); }
+
+inline std::pair<CompactGraph::vertex_iterator, CompactGraph::vertex_iterator> vertices(const CompactGraph &g)
+{
+    return {CompactGraph::vertex_iterator(0), CompactGraph::vertex_iterator(static_cast<uint32_t>(g.num_vertices()))};
+}
+
+inline CompactGraph::WeightMap get(boost::edge_weight_t, const CompactGraph &) { return {}; }
+inline float get(CompactGraph::WeightMap, const CompactGraph::Arc &a) { return a.weight; }
+
+#endif // COMPACT_GRAPH_H
@@ -0,0 +1,121 @@
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "graph_analysis.h"
+#include "graph_cache.h"
+#include "path_search.h"
+
+/**
+ * @brief version du format de fichier de la hiérarchie de contraction
+ */
+const uint32_t CONTRACTION_HIERARCHY_VERSION = 3;
+
+/**
+ * @brief tampons de travail d'une requête sur la hiérarchie (une moitié par sens de recherche)
+ */
+struct CHQueryScratch
+{
+    struct Side
+    {
+        std::vector<double> distances;
+        std::vector<uint64_t> parent_arc;
+        std::vector<uint32_t> touched;
+        std::vector<std::pair<double, uint32_t>> heap;
+    };
+
+    Side forward;
+    Side backward;
+    std::vector<uint32_t> unpack_stack;
+};
+
+/**
+ * @brief hiérarchie de contraction d'un graph non orienté
+ *
+ * Les sommets sont contractés un à un (ordre par différence d'arêtes, mise à jour paresseuse) ; des raccourcis
+ * sont ajoutés entre voisins lorsque aucun chemin témoin n'est aussi court. Seul le graph « montant » est conservé :
+ * pour chaque sommet, ses arcs vers des sommets de rang supérieur (arêtes d'origine et raccourcis, avec le sommet
+ * intermédiaire de chaque raccourci pour pouvoir le déplier).
+ */
+class ContractionHierarchy
+{
+public:
+    static const uint32_t NO_MIDDLE = UINT32_MAX;
+
+    /**
+     * @brief prétraitement : contraction de tous les sommets du graph
+     *
+     * @param g graph symétrique (chaque arête présente dans les deux sens)
+     * @return ContractionHierarchy
+     */
+    static ContractionHierarchy build(const CSRGraph &g);
+    static ContractionHierarchy build(const CompactGraph &g);
+
+    /**
+     * @brief écriture de la hiérarchie, avec l'empreinte des CSV dont est issu le graph
+     */
+    bool save(const std::string &filename, const GraphCacheKey &key) const;
+
+    /**
+     * @brief relecture d'une hiérarchie enregistrée
+     *
+     * @return false si le fichier est absent, d'une autre version ou issu d'autres CSV
+     */
+    bool load(const std::string &filename, const GraphCacheKey &key);
+
+    /**
+     * @brief plus court chemin start -> goal (indices à partir de 0) par recherches montantes bidirectionnelles,
+     * raccourcis dépliés en chemin de sommets du graph d'origine
+     */
+    PathResult query(Vertex start, Vertex goal, CHQueryScratch &scratch) const;
+
+    size_t num_vertices() const { return rank.size(); }
+    size_t num_arcs() const { return up_targets.size(); }
+    size_t num_shortcuts() const;
+
+    /**
+     * @brief mémoire occupée par le graph montant et les rangs (octets réservés)
+     */
+    size_t memory_used() const;
+
+private:
+    template <typename G>
+    static ContractionHierarchy build_impl(const G &g);
+
+    void prepare(CHQueryScratch::Side &side) const;
+    void unpack(uint32_t from, uint32_t to, uint32_t middle, double weight, std::vector<Vertex> &path, double &length, std::vector<uint32_t> &stack) const;
+    uint64_t find_arc(uint32_t lower, uint32_t upper) const;
+
+    std::vector<uint32_t> rank;
+    std::vector<uint64_t> up_offsets;
+    std::vector<uint32_t> up_targets;
+    std::vector<double> up_weights;
+    std::vector<uint32_t> up_middle;
+};
+
+/**
+ * @brief chargement de la hiérarchie enregistrée si elle correspond aux CSV, sinon prétraitement et enregistrement
+ *
+ * @param g
+ * @param filename
+ * @param key
+ * @param ch
+ */
+void load_or_build_contraction_hierarchy(const CSRGraph &g, const std::string &filename, const GraphCacheKey &key, ContractionHierarchy &ch);
+void load_or_build_contraction_hierarchy(const CompactGraph &g, const std::string &filename, const GraphCacheKey &key, ContractionHierarchy &ch);
+
+/**
+ * @brief export CSV des plus courts chemins de list_Node au format "Start;End;Path Length;Path", requêtes sur la hiérarchie
+ *
+ * @param ch
+ * @param list_Node
+ * @param numbering numérotation des fichiers du graph de la hiérarchie
+ * @param filename
+ * @param num_threads nombre de threads de calcul (0 : tous les coeurs disponibles)
+ */
+void CSVOuptutFunction(const ContractionHierarchy &ch, const std::vector<std::pair<double, double>> &list_Node, const VertexNumbering &numbering,
+                       const std::string &filename, unsigned num_threads = 0);
+
+#endif // CONTRACTION_HIERARCHY_H
@@ -0,0 +1,162 @@
+#ifndef COORDINATES_H
+#define COORDINATES_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <new>
+
+/**
+ * @brief allocateur de tableaux alignés sur Alignment octets (début de ligne de cache, chargements vectoriels)
+ */
+template <typename T, std::size_t Alignment>
+struct AlignedAllocator
+{
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+    T *allocate(std::size_t n) { return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Alignment))); }
+    void deallocate(T *p, std::size_t) { ::operator delete(p, std::align_val_t(Alignment)); }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment> &) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment> &) const { return false; }
+};
+
+/**
+ * @brief coordonnées des sommets en structure de tableaux : x, y et z dans trois tableaux contigus alignés
+ *
+ * Les parcours séquentiels (boîte englobante, index de l'affichage, cache binaire, renumérotation) ne lisent
+ * que les axes dont ils ont besoin, par registres vectoriels entiers.
+ */
+class CoordinateStore
+{
+public:
+    using Array = std::vector<double, AlignedAllocator<double, 64>>;
+
+    CoordinateStore() = default;
+    explicit CoordinateStore(size_t n) { resize(n); }
+
+    size_t size() const { return xs.size(); }
+    bool empty() const { return xs.empty(); }
+
+    void resize(size_t n)
+    {
+        xs.resize(n);
+        ys.resize(n);
+        zs.resize(n);
+    }
+
+    void clear()
+    {
+        xs.clear();
+        ys.clear();
+        zs.clear();
+    }
+
+    /**
+     * @brief mémoire réservée par les trois tableaux (octets)
+     */
+    size_t memory_used() const { return (xs.capacity() + ys.capacity() + zs.capacity()) * sizeof(double); }
+
+    double x(size_t v) const { return xs[v]; }
+    double y(size_t v) const { return ys[v]; }
+    double z(size_t v) const { return zs[v]; }
+
+    void set(size_t v, double x, double y, double z)
+    {
+        xs[v] = x;
+        ys[v] = y;
+        zs[v] = z;
+    }
+
+    const double *x_data() const { return xs.data(); }
+    const double *y_data() const { return ys.data(); }
+    const double *z_data() const { return zs.data(); }
+    double *x_data() { return xs.data(); }
+    double *y_data() { return ys.data(); }
+    double *z_data() { return zs.data(); }
+
+    /**
+     * @brief distance euclidienne entre deux sommets
+     */
+    double distance(size_t a, size_t b) const
+    {
+        double dx = xs[a] - xs[b], dy = ys[a] - ys[b], dz = zs[a] - zs[b];
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    /**
+     * @brief permutation des sommets : le sommet i prend les coordonnées de l'ancien sommet order[i]
+     *
+     * @param order
+     */
+    void permute(const std::vector<uint32_t> &order);
+
+private:
+    Array xs, ys, zs;
+};
+
+/**
+ * @brief précision du calcul des poids des arêtes, stockés en float dans tous les cas
+ *
+ * Double : différences et racine en double puis arrondi, exactement la valeur de calcul_distance.
+ * Float : calcul en float, deux fois plus de voies par registre ; l'écart relatif (quelques 1e-7) reste couvert
+ * par la marge de l'heuristique d'A*.
+ */
+enum class WeightPrecision
+{
+    Double,
+    Float
+};
+
+/**
+ * @brief nom court d'une précision ("double", "float")
+ */
+const char *weight_precision_name(WeightPrecision precision);
+
+/**
+ * @brief précision correspondant à un nom court
+ *
+ * @param name
+ * @param precision
+ * @return false si le nom est inconnu
+ */
+bool parse_weight_precision(const std::string &name, WeightPrecision &precision);
+
+/**
+ * @brief calcul par lots des poids (distances euclidiennes) de toutes les arêtes
+ *
+ * Noyau AVX2 lorsque le processeur de compilation le permet (quatre arêtes par itération en double,
+ * huit en float), boucle scalaire sinon ; tranches d'arêtes réparties entre les threads. Les extrémités
+ * étant lues dans un ordre quelconque, le noyau AVX2 travaille sur une copie temporaire des coordonnées
+ * regroupées par sommet (32 octets alignés), une seule ligne de cache par extrémité au lieu de trois.
+ *
+ * @param coord_list
+ * @param edge_list arêtes (indices à partir de 0)
+ * @param weights redimensionné au nombre d'arêtes
+ * @param precision
+ * @param num_threads 0 : tous les coeurs disponibles
+ */
+void compute_edge_weights(const CoordinateStore &coord_list, const std::vector<std::pair<int, int>> &edge_list,
+                          std::vector<float> &weights, WeightPrecision precision = WeightPrecision::Double, unsigned num_threads = 0);
+
+/**
+ * @brief noyau de compute_edge_weights retenu à la compilation ("avx2" ou "scalar")
+ */
+const char *edge_weight_kernel_name();
+
+#endif // COORDINATES_H
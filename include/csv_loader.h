@@ -0,0 +1,91 @@
+#ifndef CSV_LOADER_H
+#define CSV_LOADER_H
+
+#include <string>
+#include <vector>
+#include "coordinates.h"
+#include <utility>
+#include <cstddef>
+
+/**
+ * @brief fichier projeté en mémoire en lecture seule
+ */
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string &filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool is_open() const { return opened; }
+    const char *data() const { return begin; }
+    size_t size() const { return length; }
+
+private:
+    const char *begin = nullptr;
+    size_t length = 0;
+    bool opened = false;
+#ifdef _WIN32
+    void *file_handle = nullptr;
+    void *mapping_handle = nullptr;
+#endif
+};
+
+/**
+ * @brief ligne mal formée d'un fichier CSV (numéro de ligne à partir de 1, en-tête compris)
+ */
+struct CSVError
+{
+    size_t line;
+    std::string message;
+};
+
+/**
+ * @brief bilan du chargement d'un fichier CSV
+ *
+ * errors ne conserve que les premières lignes fautives (MAX_REPORTED), malformed donne leur nombre total.
+ */
+struct CSVLoadResult
+{
+    static constexpr size_t MAX_REPORTED = 100;
+
+    bool opened = false;
+    size_t records = 0;
+    size_t malformed = 0;
+    std::vector<CSVError> errors;
+
+    bool ok() const { return opened && malformed == 0; }
+};
+
+/**
+ * @brief chargement de nodes.csv ("id;x;y;z") directement dans coord_list, par tranches analysées en parallèle
+ *
+ * @param filename
+ * @param coord_list coordonnées dans l'ordre des lignes du fichier
+ * @param num_threads nombre de threads d'analyse (0 : tous les coeurs disponibles)
+ * @return CSVLoadResult
+ */
+CSVLoadResult load_nodes_csv(const std::string &filename, CoordinateStore &coord_list, unsigned num_threads = 0);
+
+/**
+ * @brief chargement de edges.csv ("source;cible", identifiants à partir de 1) directement dans edge_list
+ *
+ * @param filename
+ * @param edge_list arêtes converties en indices à partir de 0
+ * @param num_vertices nombre de sommets pour la vérification des identifiants (0 : pas de vérification)
+ * @param num_threads nombre de threads d'analyse (0 : tous les coeurs disponibles)
+ * @return CSVLoadResult
+ */
+CSVLoadResult load_edges_csv(const std::string &filename, std::vector<std::pair<int, int>> &edge_list, size_t num_vertices = 0, unsigned num_threads = 0);
+
+/**
+ * @brief affichage des erreurs de chargement sur la sortie d'erreur
+ *
+ * @param filename
+ * @param result
+ */
+void report_csv_errors(const std::string &filename, const CSVLoadResult &result);
+
+#endif // CSV_LOADER_H
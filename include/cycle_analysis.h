@@ -0,0 +1,90 @@
+#ifndef CYCLE_ANALYSIS_H
+#define CYCLE_ANALYSIS_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include "graph_analysis.h"
+
+/**
+ * @brief ensembles disjoints (union par taille, compression de chemin par division)
+ */
+class UnionFind
+{
+public:
+    explicit UnionFind(size_t n = 0);
+
+    void reset(size_t n);
+
+    uint32_t find(uint32_t v);
+
+    /**
+     * @brief fusion des ensembles de a et b
+     *
+     * @return false si a et b étaient déjà dans le même ensemble
+     */
+    bool unite(uint32_t a, uint32_t b);
+
+    size_t size_of(uint32_t v) { return sizes[find(v)]; }
+
+private:
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> sizes;
+};
+
+/**
+ * @brief résultat d'une analyse de cycles et de composantes
+ *
+ * cycle est un témoin : suite de sommets (indices à partir de 0) dont chacun est relié au suivant
+ * et le dernier au premier ; vide s'il n'y a pas de cycle.
+ */
+struct CycleAnalysis
+{
+    bool has_cycle = false;
+    std::vector<Vertex> cycle;
+    size_t num_components = 0;
+    std::vector<uint32_t> component;
+    std::vector<size_t> component_sizes;
+
+    size_t largest_component() const;
+};
+
+/**
+ * @brief composantes fortement connexes (Tarjan, pile explicite) et cycle orienté témoin
+ *
+ * Un graph orienté a un cycle si une composante contient au moins deux sommets ou si un sommet a une boucle.
+ * Les composantes sont numérotées dans l'ordre où Tarjan les termine (ordre topologique inverse).
+ *
+ * @param g
+ * @return CycleAnalysis
+ */
+CycleAnalysis directed_cycle_analysis(const Graph &g);
+CycleAnalysis directed_cycle_analysis(const CSRGraph &g);
+CycleAnalysis directed_cycle_analysis(const CompactGraph &g);
+
+/**
+ * @brief détection de cycle dans une liste d'arêtes non orientées par union-find, en un seul passage
+ *
+ * La première arête dont les extrémités sont déjà reliées ferme un cycle (boucles et arêtes multiples comprises) ;
+ * le témoin est complété par le chemin entre ses extrémités dans la forêt des arêtes précédentes.
+ * Utilisable dès le chargement, sans construire le graph : les arêtes sont lues par extrémité basse croissante
+ * (ordre du graph CSR construit à partir de la liste), si bien que le résultat est celui de l'analyse du graph.
+ *
+ * @param num_vertices
+ * @param edge_list arêtes (indices à partir de 0)
+ * @return CycleAnalysis
+ */
+CycleAnalysis undirected_cycle_analysis(size_t num_vertices, const std::vector<std::pair<int, int>> &edge_list);
+
+/**
+ * @brief détection de cycle non orienté sur un graph dont chaque arête est stockée dans les deux sens
+ * (seuls les arcs u <= v sont lus)
+ *
+ * @param g
+ * @return CycleAnalysis
+ */
+CycleAnalysis undirected_cycle_analysis(const Graph &g);
+CycleAnalysis undirected_cycle_analysis(const CSRGraph &g);
+CycleAnalysis undirected_cycle_analysis(const CompactGraph &g);
+
+#endif // CYCLE_ANALYSIS_H
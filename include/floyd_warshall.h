@@ -0,0 +1,129 @@
+#ifndef FLOYD_WARSHALL_H
+#define FLOYD_WARSHALL_H
+
+#include <vector>
+#include <cstdint>
+#include "graph_analysis.h"
+
+/**
+ * @brief nombre maximal de sommets d'une matrice de Floyd-Warshall (distances, sommets suivants et poids directs)
+ */
+const size_t FLOYD_WARSHALL_MAX_VERTICES = 4096;
+
+/**
+ * @brief plus courts chemins entre tous les couples par Floyd-Warshall par tuiles
+ *
+ * La matrice des distances est découpée en tuiles carrées ; pour chaque bloc de sommets intermédiaires,
+ * la tuile diagonale, puis les tuiles de sa ligne et de sa colonne, puis toutes les autres sont relâchées,
+ * les deux dernières étapes en parallèle. Le noyau min-plus traite quatre distances à la fois en AVX2 si le
+ * compilateur le permet (-march=native), une boucle scalaire sinon.
+ *
+ * Les chemins se reconstruisent par la matrice des sommets suivants ; leur longueur est la somme, dans
+ * l'ordre du chemin, des poids des arcs, comme dans un Dijkstra depuis le départ. Entre plusieurs plus courts
+ * chemins de même longueur, la matrice et un Dijkstra ne retiennent pas forcément le même : l'export écarte
+ * la matrice si sampled_equal_length_paths trouve ce cas sur quelques départs, puis vérifie avec
+ * has_equal_length_paths qu'il ne se présente depuis aucun.
+ */
+class AllPairsMatrix
+{
+public:
+    /**
+     * @brief calcul de la matrice complète
+     *
+     * @param g
+     * @param num_threads nombre de threads (0 : tous les coeurs disponibles)
+     * @return AllPairsMatrix
+     */
+    static AllPairsMatrix build(const Graph &g, unsigned num_threads = 0);
+    static AllPairsMatrix build(const CSRGraph &g, unsigned num_threads = 0);
+    static AllPairsMatrix build(const CompactGraph &g, unsigned num_threads = 0);
+
+    /**
+     * @brief chemin start -> goal (indices à partir de 0)
+     *
+     * @param start
+     * @param goal
+     * @param path sommets dans l'ordre start -> goal
+     * @return false si goal n'est pas atteignable
+     */
+    bool extract_path(Vertex start, Vertex goal, std::vector<Vertex> &path) const;
+
+    /**
+     * @brief longueur d'un chemin, poids des arcs additionnés dans l'ordre du chemin
+     */
+    double path_length(const std::vector<Vertex> &path) const;
+
+    /**
+     * @brief recherche, depuis chaque départ, d'un sommet atteint par deux arcs tendus (d(s, u) + w(u, v) = d(s, v),
+     * à l'arrondi près) : deux plus courts chemins de même longueur existent alors, par exemple sur une grille
+     * à coordonnées entières, et le chemin de la matrice peut différer de celui d'une recherche depuis s
+     *
+     * @param starts départs (indices à partir de 0)
+     * @param num_threads nombre de threads (0 : tous les coeurs disponibles)
+     * @return true dès qu'un tel sommet est trouvé
+     */
+    bool has_equal_length_paths(const std::vector<Vertex> &starts, unsigned num_threads = 0) const;
+
+    size_t num_vertices() const { return n; }
+
+    /**
+     * @brief mémoire occupée par la matrice d'un graph de n sommets
+     */
+    static size_t memory_bytes(size_t n);
+
+    /**
+     * @brief noyau min-plus compilé ("avx2" ou "scalar")
+     */
+    static const char *kernel_name();
+
+private:
+    template <class G>
+    static AllPairsMatrix build_impl(const G &g, unsigned num_threads);
+    void run(unsigned num_threads);
+
+    size_t n = 0;
+    // Lignes complétées à un multiple de la taille de tuile, plus quelques colonnes inutilisées
+    size_t stride = 0;
+    std::vector<double> distances;
+    std::vector<uint32_t> next;
+    // Plus petit poids des arcs u -> v, pour la longueur des chemins
+    std::vector<float> direct;
+    // Prédécesseurs distincts de chaque sommet et poids directs depuis eux, pour la recherche des chemins de même longueur
+    std::vector<uint32_t> in_offsets;
+    std::vector<uint32_t> in_sources;
+    std::vector<float> in_weights;
+};
+
+/**
+ * @brief recherche, avant tout calcul de matrice, de plus courts chemins de même longueur depuis quelques départs
+ *
+ * Dijkstra complet depuis au plus samples départs répartis dans starts : un sommet atteint par des arcs tendus
+ * depuis deux prédécesseurs distincts signale des chemins de même longueur (coordonnées entières, grilles), et
+ * la matrice serait calculée pour rien. Un échantillon sans égalité ne prouve rien pour les autres départs :
+ * has_equal_length_paths les vérifie tous une fois la matrice calculée.
+ *
+ * @param g
+ * @param starts départs de l'export (indices à partir de 0)
+ * @param samples nombre de départs examinés
+ * @param num_threads nombre de threads (0 : tous les coeurs disponibles)
+ * @return true dès qu'un tel sommet est trouvé
+ */
+bool sampled_equal_length_paths(const Graph &g, const std::vector<Vertex> &starts, size_t samples = 8, unsigned num_threads = 0);
+bool sampled_equal_length_paths(const CSRGraph &g, const std::vector<Vertex> &starts, size_t samples = 8, unsigned num_threads = 0);
+bool sampled_equal_length_paths(const CompactGraph &g, const std::vector<Vertex> &starts, size_t samples = 8, unsigned num_threads = 0);
+
+/**
+ * @brief choix entre Floyd-Warshall et une recherche par source pour l'export de couples
+ *
+ * Floyd-Warshall coûte n^3 relâchements quel que soit le nombre de couples, une recherche par source environ
+ * m + n log n ; la matrice n'est retenue que si elle tient en mémoire et revient moins cher.
+ *
+ * @param n nombre de sommets
+ * @param arcs nombre d'arcs
+ * @param sources nombre de sources distinctes de l'export
+ * @return true
+ * @return false
+ */
+bool prefer_floyd_warshall(size_t n, size_t arcs, size_t sources);
+
+#endif // FLOYD_WARSHALL_H
@@ -5,7 +5,6 @@
 #include <fstream>
 #include <vector>
 #include <string>
-#include <tuple>
 #include <cmath>
 #include <limits>
 #include <boost/graph/adjacency_list.hpp>
@@ -13,6 +12,9 @@
 #include <boost/graph/topological_sort.hpp>
 #include <boost/graph/dijkstra_shortest_paths.hpp>
 #include <boost/graph/graph_traits.hpp>
+#include <boost/graph/compressed_sparse_row_graph.hpp>
+#include "coordinates.h"
+#include "compact_graph.h"
 
 using Graph = boost::adjacency_list<
     boost::vecS, boost::vecS, boost::bidirectionalS,
@@ -23,6 +25,18 @@ using Graph = boost::adjacency_list<
 using Vertex = boost::graph_traits<Graph>::vertex_descriptor;
 using Edge = boost::graph_traits<Graph>::edge_descriptor;
 
+/**
+ * @brief représentation figée du graph en lignes creuses compressées (CSR) : tableaux contigus
+ * des décalages, des cibles (32 bits) et des poids (float), chaque arête non orientée donnant un arc par sens
+ */
+using CSRGraph = boost::compressed_sparse_row_graph<
+    boost::directedS,
+    boost::no_property,
+    boost::property<boost::edge_weight_t, float>,
+    boost::no_property,
+    uint32_t, uint64_t
+>;
+
 /**
  * @brief lecture du fichier CSV et stockage des données dans un vecteur
  * 
@@ -39,7 +53,54 @@ void readCSV(const std::string &filename, std::vector<std::string> &data);
  * @param coord_list 
  * @return double 
  */
-double calcul_distance(int first, int second, const std::vector<std::tuple<double, double, double>> &coord_list);
+double calcul_distance(int first, int second, const CoordinateStore &coord_list);
+
+/**
+ * @brief algorithme utilisé pour une requête point à point
+ */
+enum class SearchMode
+{
+    Dijkstra,
+    AStar,
+    Bidirectional
+};
+
+/**
+ * @brief format de l'export de tous les plus courts chemins
+ */
+enum class ExportFormat
+{
+    CSV,
+    PathMatrix
+};
+
+class ContractionHierarchy;
+class ShortestPathTreeCache;
+class VertexNumbering;
+struct CycleAnalysis;
+
+/**
+ * @brief construction du graph CSR à partir de la liste d'arêtes non orientées et de leurs poids
+ * 
+ * @param num_vertices 
+ * @param edge_list arêtes (indices à partir de 0)
+ * @param weights poids de chaque arête de edge_list
+ * @return CSRGraph 
+ */
+CSRGraph build_csr(size_t num_vertices, const std::vector<std::pair<int, int>> &edge_list, const std::vector<float> &weights);
+
+/**
+ * @brief construction du graph CSR à partir d'un graph Boost existant
+ * 
+ * @param g 
+ * @return CSRGraph 
+ */
+CSRGraph build_csr(const Graph &g);
+
+/**
+ * @brief mémoire du graph CSR (octets) : décalages des sommets, cibles et poids des arcs
+ */
+size_t csr_memory_used(const CSRGraph &g);
 
 /**
  * @brief recherche du plus court chemin entre deux noeuds d'un graph non-orienté avec l'algorithme de Dijkstra
@@ -49,36 +110,91 @@ double calcul_distance(int first, int second, const std::vector<std::tuple<doubl
  * @param goal 
  */
 void find_shortest_path(Graph &g, Vertex start, Vertex goal);
+void find_shortest_path(CSRGraph &g, Vertex start, Vertex goal);
+void find_shortest_path(CompactGraph &g, Vertex start, Vertex goal);
 
 /**
- * @brief calcul du degré des noeuds du graph, degré du graph, connectivité du graph, détection de cycle et affichage du plus court chemin
+ * @brief recherche du plus court chemin entre deux noeuds avec l'algorithme choisi et affichage du nombre de sommets fixés
+ * 
+ * Sommets lus et affichés dans la numérotation de g (compute_graph traduit ceux d'un graph renuméroté).
  * 
  * @param g 
- * @param coord_list 
+ * @param coord_list coordonnées utilisées par l'heuristique de A*
+ * @param start 
+ * @param goal 
+ * @param mode 
+ * @param cache arbres de plus courts chemins déjà calculés, complété en mode Dijkstra
+ */
+void find_shortest_path(Graph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, ShortestPathTreeCache *cache = nullptr);
+void find_shortest_path(CSRGraph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, ShortestPathTreeCache *cache = nullptr);
+void find_shortest_path(CompactGraph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, ShortestPathTreeCache *cache = nullptr);
+
+/**
+ * @brief options de compute_graph
  */
-void compute_graph(Graph &g, const std::vector<std::tuple<double, double, double>> &coord_list);
+struct ComputeOptions
+{
+    // Hiérarchie de contraction utilisée pour l'export CSV si elle est fournie
+    const ContractionHierarchy *ch = nullptr;
+    // Arbres de plus courts chemins partagés avec l'interface
+    ShortestPathTreeCache *cache = nullptr;
+    // CSV (output.csv) ou matrice de prédécesseurs binaire (output_paths.bin)
+    ExportFormat format = ExportFormat::CSV;
+    // Affichage du degré de chaque sommet en plus du résumé
+    bool per_vertex = false;
+    // Fichier JSON des métriques (vide : pas d'écriture)
+    std::string metrics_json;
+    // Nombre de threads de calcul (0 : tous les coeurs disponibles)
+    unsigned num_threads = 0;
+
+    // Analyses exécutées : métriques (étapes 1 à 3), cycles (étape 4), export (étape 8)
+    bool run_metrics = true;
+    bool run_cycles = true;
+    bool run_export = true;
+    // Analyse de cycles non orientée faite au chargement (load_graph), sommets dans la numérotation des fichiers :
+    // reprise à l'étape 4 au lieu d'être recalculée sur le graph
+    const CycleAnalysis *cycles = nullptr;
+    // Correspondance des sommets du graph avec les identifiants des fichiers, renvoyée par reorder_vertices
+    // (nullptr : graph dans l'ordre des CSV)
+    const VertexNumbering *numbering = nullptr;
+    // Requêtes affichées à l'étape 5, en numérotation 1..n
+    std::vector<std::pair<Vertex, Vertex>> queries = {{1, 6}};
+    SearchMode query_mode = SearchMode::AStar;
+    // Couples exportés en numérotation 1..n (vide : tous les couples i < j)
+    std::vector<std::pair<double, double>> pairs;
+    // Fichier d'export (vide : output.csv ou output_paths.bin selon le format)
+    std::string output;
+};
 
 /**
- * @brief vérification de la présence de cycle dans un graph orienté
+ * @brief calcul des métriques du graph (degrés, connectivité), détection de cycle, affichage des plus courts chemins
+ * demandés et export des plus courts chemins, chaque étape pouvant être désactivée par les options
  * 
- * @param v 
- * @param visited 
- * @param recStack 
  * @param g 
- * @return true 
- * @return false 
+ * @param coord_list 
+ * @param options
  */
-bool isCyclicUtil(int v, bool visited[], bool *recStack, Graph &g);
+void compute_graph(Graph &g, const CoordinateStore &coord_list);
+void compute_graph(CSRGraph &g, const CoordinateStore &coord_list, const ComputeOptions &options = ComputeOptions());
+void compute_graph(CompactGraph &g, const CoordinateStore &coord_list, const ComputeOptions &options = ComputeOptions());
 
 /**
  * @brief Calcul de tous les chemins les plus courts entre tous les noeuds du graph et écriture dans un fichier CSV
  * 
+ * Les sources sont réparties entre num_threads threads ; les lignes sont écrites dans l'ordre de list_Node
+ * quel que soit le nombre de threads.
+ * 
  * @param g 
  * @param list_Node 
  * @param coord_list 
+ * @param numbering numérotation des fichiers du graph, utilisée pour écrire les lignes
  * @param filename 
+ * @param num_threads nombre de threads de calcul (0 : tous les coeurs disponibles)
+ * @param cache si fourni, chaque source est servie par son arbre en cache ou calculée entièrement puis mise en cache
  */
-void CSVOuptutFunction(Graph &g, const std::vector<std::pair<double, double>> &list_Node, const std::vector<std::tuple<double, double, double>> &coord_list, const std::string &filename);
+void CSVOuptutFunction(Graph &g, const std::vector<std::pair<double, double>> &list_Node, const CoordinateStore &coord_list, const VertexNumbering &numbering, const std::string &filename, unsigned num_threads = 0, ShortestPathTreeCache *cache = nullptr);
+void CSVOuptutFunction(CSRGraph &g, const std::vector<std::pair<double, double>> &list_Node, const CoordinateStore &coord_list, const VertexNumbering &numbering, const std::string &filename, unsigned num_threads = 0, ShortestPathTreeCache *cache = nullptr);
+void CSVOuptutFunction(CompactGraph &g, const std::vector<std::pair<double, double>> &list_Node, const CoordinateStore &coord_list, const VertexNumbering &numbering, const std::string &filename, unsigned num_threads = 0, ShortestPathTreeCache *cache = nullptr);
 
 
 /**
@@ -87,9 +203,15 @@ void CSVOuptutFunction(Graph &g, const std::vector<std::pair<double, double>> &l
  * @param g 
  * @param list_Node 
  * @param coord_list 
+ * @param numbering
  * @param filename 
+ * @param num_threads nombre de threads de calcul (0 : tous les coeurs disponibles)
+ * @param cache
  */
-void calculate_and_write_paths(Graph &g, const std::vector<std::pair<double, double>> &list_Node, const std::vector<std::tuple<double, double, double>> &coord_list, const std::string &filename);
+void calculate_and_write_paths(Graph &g, const std::vector<std::pair<double, double>> &list_Node, const CoordinateStore &coord_list, const VertexNumbering &numbering, const std::string &filename, unsigned num_threads = 0, ShortestPathTreeCache *cache = nullptr);
+void calculate_and_write_paths(CSRGraph &g, const std::vector<std::pair<double, double>> &list_Node, const CoordinateStore &coord_list, const VertexNumbering &numbering, const std::string &filename, unsigned num_threads = 0, ShortestPathTreeCache *cache = nullptr);
+void calculate_and_write_paths(CompactGraph &g, const std::vector<std::pair<double, double>> &list_Node, const CoordinateStore &coord_list, const VertexNumbering &numbering, const std::string &filename, unsigned num_threads = 0, ShortestPathTreeCache *cache = nullptr);
+void calculate_and_write_paths(const ContractionHierarchy &ch, const std::vector<std::pair<double, double>> &list_Node, const VertexNumbering &numbering, const std::string &filename, unsigned num_threads = 0);
 
 
 #endif // GRAPH_ANALYSIS_H
\ No newline at end of file
@@ -0,0 +1,120 @@
+#ifndef GRAPH_CACHE_H
+#define GRAPH_CACHE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "graph_analysis.h"
+
+/**
+ * @brief version du format binaire, à incrémenter à chaque changement de disposition du fichier
+ */
+const uint32_t GRAPH_CACHE_VERSION = 2;
+
+/**
+ * @brief empreinte des fichiers CSV source (taille et date de modification) enregistrée dans le cache
+ */
+struct GraphCacheKey
+{
+    uint64_t nodes_size = 0;
+    int64_t nodes_mtime = 0;
+    uint64_t edges_size = 0;
+    int64_t edges_mtime = 0;
+    // Renumérotation des sommets (VertexOrdering) appliquée après chargement, pour les prétraitements
+    // qui dépendent des numéros internes ; le cache du graph lui-même reste dans l'ordre des fichiers
+    uint32_t ordering = 0;
+    // Précision du calcul des poids (WeightPrecision), dont dépendent le graph en cache et ses prétraitements
+    uint32_t weight_precision = 0;
+    bool valid = false;
+
+    bool operator==(const GraphCacheKey &other) const
+    {
+        return nodes_size == other.nodes_size && nodes_mtime == other.nodes_mtime &&
+               edges_size == other.edges_size && edges_mtime == other.edges_mtime && ordering == other.ordering &&
+               weight_precision == other.weight_precision;
+    }
+};
+
+/**
+ * @brief en-tête du fichier cache, suivi des sections alignées sur 8 octets :
+ * coordonnées (tableaux x, y puis z de n double), décalages CSR (n + 1 uint64), cibles (uint32) et poids (float) des arcs
+ */
+struct GraphCacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t nodes_size;
+    int64_t nodes_mtime;
+    uint64_t edges_size;
+    int64_t edges_mtime;
+    uint64_t num_vertices;
+    uint64_t num_arcs;
+    uint32_t weight_precision;
+    uint32_t reserved;
+};
+
+/**
+ * @brief calcul de l'empreinte des fichiers CSV (valid à false si l'un d'eux est inaccessible)
+ *
+ * @param filename_nodes
+ * @param filename_edges
+ * @return GraphCacheKey
+ */
+GraphCacheKey make_cache_key(const std::string &filename_nodes, const std::string &filename_edges);
+
+/**
+ * @brief chargement du graph depuis le cache binaire projeté en mémoire, sans analyse ni allocation par arête
+ *
+ * @param filename
+ * @param key empreinte attendue des CSV
+ * @param coord_list
+ * @param g
+ * @return false si le cache est absent, d'une autre version, corrompu ou périmé
+ */
+bool load_graph_cache(const std::string &filename, const GraphCacheKey &key, CoordinateStore &coord_list, CSRGraph &g);
+bool load_graph_cache(const std::string &filename, const GraphCacheKey &key, CoordinateStore &coord_list, CompactGraph &g);
+
+/**
+ * @brief écriture du cache binaire (fichier temporaire puis renommage)
+ *
+ * @param filename
+ * @param key
+ * @param coord_list
+ * @param g
+ * @return true
+ * @return false
+ */
+bool save_graph_cache(const std::string &filename, const GraphCacheKey &key, const CoordinateStore &coord_list, const CSRGraph &g);
+bool save_graph_cache(const std::string &filename, const GraphCacheKey &key, const CoordinateStore &coord_list, const CompactGraph &g);
+
+/**
+ * @brief chargement du graph : cache binaire s'il est à jour, sinon analyse des CSV, calcul des poids,
+ * construction du graph CSR et écriture du cache
+ *
+ * @param filename_nodes
+ * @param filename_edges
+ * @param filename_cache cache binaire (vide : pas de cache)
+ * @param coord_list
+ * @param g
+ * @param key empreinte des CSV, utilisable pour les fichiers dérivés (hiérarchie de contraction)
+ * @param num_threads nombre de threads d'analyse des CSV et du calcul des poids (0 : tous les coeurs disponibles)
+ * @param precision précision du calcul des poids ; un cache calculé avec l'autre précision est ignoré
+ * @param cycles si fourni, détection de cycle non orientée faite au chargement, sur la liste d'arêtes des CSV
+ * (ou sur le graph relu du cache), sommets dans la numérotation des fichiers
+ * @return false si les CSV sont illisibles ou contiennent des lignes invalides
+ */
+bool load_graph(const std::string &filename_nodes, const std::string &filename_edges, const std::string &filename_cache,
+                CoordinateStore &coord_list, CSRGraph &g, GraphCacheKey &key, unsigned num_threads = 0,
+                WeightPrecision precision = WeightPrecision::Double, CycleAnalysis *cycles = nullptr);
+
+/**
+ * @brief chargement dans le graph compact, même cache binaire que le graph CSR
+ *
+ * @return false également si le graph dépasse 2^32 - 1 arêtes
+ */
+bool load_graph(const std::string &filename_nodes, const std::string &filename_edges, const std::string &filename_cache,
+                CoordinateStore &coord_list, CompactGraph &g, GraphCacheKey &key, unsigned num_threads = 0,
+                WeightPrecision precision = WeightPrecision::Double, CycleAnalysis *cycles = nullptr);
+
+#endif // GRAPH_CACHE_H
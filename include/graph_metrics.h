@@ -0,0 +1,82 @@
+#ifndef GRAPH_METRICS_H
+#define GRAPH_METRICS_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include "graph_analysis.h"
+
+/**
+ * @brief métriques globales d'un graph (pour un graph non orienté, chaque arête est comptée dans les deux sens)
+ */
+struct GraphMetrics
+{
+    size_t num_vertices = 0;
+    size_t num_arcs = 0;
+
+    // Degrés (arcs sortants) : extrêmes, moyenne, écart type, médiane et histogramme (indice = degré)
+    size_t min_degree = 0;
+    size_t max_degree = 0;
+    double mean_degree = 0;
+    double degree_stddev = 0;
+    size_t median_degree = 0;
+    size_t isolated_vertices = 0;
+    std::vector<size_t> degree_histogram;
+
+    // Poids des arcs
+    double min_weight = 0;
+    double max_weight = 0;
+    double mean_weight = 0;
+
+    // Composantes connexes, tailles par ordre décroissant
+    size_t num_components = 0;
+    std::vector<size_t> component_sizes;
+
+    // Degré de chaque sommet, rempli seulement si demandé
+    std::vector<uint32_t> degrees;
+
+    bool connected() const { return num_components == 1; }
+};
+
+/**
+ * @brief calcul parallèle des métriques : degrés et poids par tranches de sommets, composantes par union-find
+ * concurrent (liens par compare-and-swap, toujours du plus grand indice de racine vers le plus petit)
+ *
+ * @param g
+ * @param num_threads nombre de threads (0 : tous les coeurs disponibles)
+ * @param keep_degrees conserver le degré de chaque sommet dans degrees
+ * @return GraphMetrics
+ */
+GraphMetrics compute_metrics(const Graph &g, unsigned num_threads = 0, bool keep_degrees = false);
+GraphMetrics compute_metrics(const CSRGraph &g, unsigned num_threads = 0, bool keep_degrees = false);
+GraphMetrics compute_metrics(const CompactGraph &g, unsigned num_threads = 0, bool keep_degrees = false);
+
+/**
+ * @brief affichage du résumé des métriques
+ *
+ * @param out
+ * @param metrics
+ */
+void print_metrics_summary(std::ostream &out, const GraphMetrics &metrics);
+
+/**
+ * @brief affichage du degré de chaque sommet au format "Node degree: {1:3, 2:4, ...}" (degrees doit être rempli)
+ *
+ * @param out
+ * @param metrics
+ * @param numbering numérotation des fichiers du graph : degrés listés dans l'ordre des CSV
+ */
+void print_vertex_degrees(std::ostream &out, const GraphMetrics &metrics, const VertexNumbering &numbering);
+
+/**
+ * @brief écriture des métriques au format JSON (degrés par sommet inclus s'ils ont été conservés)
+ *
+ * @param filename
+ * @param metrics
+ * @param numbering numérotation des fichiers du graph
+ * @return false si le fichier ne peut pas être écrit
+ */
+bool write_metrics_json(const std::string &filename, const GraphMetrics &metrics, const VertexNumbering &numbering);
+
+#endif // GRAPH_METRICS_H
@@ -0,0 +1,228 @@
+#ifndef GRAPH_UPDATES_H
+#define GRAPH_UPDATES_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "graph_analysis.h"
+#include "graph_cache.h"
+#include "graph_metrics.h"
+#include "csv_loader.h"
+#include "sssp_cache.h"
+
+/**
+ * @brief nature d'une modification d'arête non orientée
+ */
+enum class EdgeUpdateKind
+{
+    Insert,    // ouverture d'une arête (une arête parallèle s'ajoute aux arêtes existantes)
+    Delete,    // fermeture de toutes les arêtes entre les deux sommets
+    Reweight   // nouveau poids de toutes les arêtes entre les deux sommets
+};
+
+/**
+ * @brief modification lue dans un fichier de mises à jour (indices à partir de 0)
+ */
+struct EdgeUpdate
+{
+    EdgeUpdateKind kind = EdgeUpdateKind::Insert;
+    Vertex u = 0;
+    Vertex v = 0;
+    // Poids de l'arête ouverte ou modifiée (ouverture sans poids : distance euclidienne)
+    double weight = 0;
+    // Ligne du fichier, pour les messages d'erreur
+    size_t line = 0;
+};
+
+/**
+ * @brief effet net d'un lot sur une paire de sommets : nombre d'arêtes parallèles et poids effectif
+ * (le plus petit d'entre elles, numeric_limits<double>::max() s'il n'y en a aucune) avant et après
+ */
+struct ArcChange
+{
+    Vertex u = 0;
+    Vertex v = 0;
+    double old_weight = 0;
+    double new_weight = 0;
+    uint32_t old_count = 0;
+    uint32_t new_count = 0;
+
+    bool weight_changed() const { return old_weight != new_weight; }
+};
+
+/**
+ * @brief lecture d'un lot de modifications "operation;source;target[;weight]" (identifiants à partir de 1, en-tête ignoré)
+ *
+ * operation vaut insert, delete ou reweight ; le poids est obligatoire pour reweight et vaut par défaut la
+ * distance euclidienne pour insert. Un poids inférieur à la distance euclidienne est refusé : l'heuristique
+ * de A* ne serait plus admissible.
+ *
+ * @param filename
+ * @param coord_list coordonnées des sommets (nombre de sommets et distances euclidiennes)
+ * @param numbering numérotation des fichiers du graph : identifiants traduits en sommets internes
+ * @param updates modifications dans l'ordre du fichier
+ * @return CSVLoadResult
+ */
+CSVLoadResult load_edge_updates(const std::string &filename, const CoordinateStore &coord_list, const VertexNumbering &numbering,
+                                std::vector<EdgeUpdate> &updates);
+
+/**
+ * @brief application d'un lot au graph CSR, sans relecture des CSV
+ *
+ * Un lot qui ne fait que modifier des poids est écrit en place dans le tableau des poids ; s'il ouvre ou
+ * ferme des arêtes, les tableaux du graph sont reconstruits une seule fois pour tout le lot, les arcs des
+ * paires modifiées étant placés après les autres arcs de leur source. Les modifications sans objet
+ * (fermeture ou changement de poids d'une arête absente) sont signalées et ignorées.
+ *
+ * @param g
+ * @param updates
+ * @param numbering numérotation des fichiers du graph, pour signaler les modifications sans objet
+ * @return std::vector<ArcChange> une entrée par paire dont le nombre d'arêtes ou le poids effectif a changé
+ */
+std::vector<ArcChange> apply_edge_updates(CSRGraph &g, const std::vector<EdgeUpdate> &updates, const VertexNumbering &numbering);
+
+/**
+ * @brief réparation d'un arbre de plus courts chemins après un lot, sans nouveau Dijkstra complet
+ *
+ * Les sous-arbres suspendus à un arc allongé ou fermé sont détachés puis raccrochés depuis leur bord,
+ * les arcs raccourcis ou ouverts propagent leurs améliorations ; seuls les sommets concernés sont revisités.
+ *
+ * @param g graph après le lot
+ * @param changes
+ * @param tree
+ * @return nombre de sommets dont la distance ou le prédécesseur a changé
+ */
+size_t repair_shortest_path_tree(const CSRGraph &g, const std::vector<ArcChange> &changes, ShortestPathTree &tree);
+
+/**
+ * @brief réparation de tous les arbres du cache touchés par le lot (les autres sont conservés tels quels)
+ *
+ * @param g graph après le lot
+ * @param changes
+ * @param cache
+ * @return nombre d'arbres modifiés
+ */
+size_t repair_tree_cache(const CSRGraph &g, const std::vector<ArcChange> &changes, ShortestPathTreeCache &cache);
+
+/**
+ * @brief métriques maintenues d'un lot à l'autre sans nouveau calcul complet
+ *
+ * Degrés et histogramme sont corrigés pour les seuls sommets touchés. Chaque sommet porte l'étiquette de
+ * sa composante : une fermeture lance des parcours en largeur alternés depuis les extrémités des arêtes
+ * fermées, arrêtés dès qu'ils se rejoignent tous (cas courant) ; une ouverture entre deux composantes
+ * réétiquette la plus petite. Les statistiques de poids sont recalculées en un passage sur les poids.
+ */
+class IncrementalMetrics
+{
+public:
+    /**
+     * @brief calcul initial (compute_metrics, degrés conservés) et étiquetage des composantes
+     *
+     * @param g
+     * @param num_threads
+     */
+    explicit IncrementalMetrics(const CSRGraph &g, unsigned num_threads = 0);
+
+    /**
+     * @brief prise en compte d'un lot déjà appliqué à g
+     *
+     * @param g graph après le lot
+     * @param changes
+     */
+    void apply(const CSRGraph &g, const std::vector<ArcChange> &changes);
+
+    const GraphMetrics &metrics() const { return current; }
+
+    /**
+     * @brief étiquette de composante d'un sommet (deux sommets sont connectés si leurs étiquettes sont égales)
+     */
+    uint32_t component(Vertex v) const { return label[v]; }
+
+private:
+    void split_components(const CSRGraph &g, uint32_t old_label, std::vector<Vertex> &endpoints);
+    void merge_components(uint32_t a, uint32_t b);
+    uint32_t new_label();
+    void update_summary(const CSRGraph &g);
+
+    GraphMetrics current;
+    std::vector<uint32_t> label;
+    std::vector<size_t> label_size;
+    // Sommets de chaque étiquette ; les entrées dont l'étiquette a changé depuis sont ignorées puis compactées
+    std::vector<std::vector<uint32_t>> members;
+    std::vector<uint32_t> free_labels;
+    std::vector<uint32_t> owner;
+};
+
+/**
+ * @brief bilan de la mise à jour d'un export CSV
+ */
+struct ExportUpdateResult
+{
+    bool ok = false;
+    size_t rows = 0;
+    size_t recomputed = 0;
+    size_t rewritten = 0;
+    size_t sources = 0;
+};
+
+/**
+ * @brief mise à jour d'un export CSV existant après un lot : seules les lignes dont le chemin a pu changer sont recalculées
+ *
+ * Une ligne est recalculée si son chemin emprunte une arête allongée ou fermée, ou si une arête raccourcie
+ * ou ouverte (u, v, w) donne d(s, u) + w + d(v, t) plus court que sa longueur (distances depuis u et v par
+ * un Dijkstra complet chacune). Les autres lignes restent des plus courts chemins et sont recopiées
+ * telles quelles ; le fichier est réécrit via un fichier temporaire puis renommé.
+ *
+ * @param g graph après le lot
+ * @param numbering numérotation des fichiers du graph, celle de l'export
+ * @param changes
+ * @param filename export au format "Start;End;Path Length;Path" calculé sur le graph d'avant le lot
+ * @param num_threads nombre de threads de recalcul (0 : tous les coeurs disponibles)
+ * @param cache arbres de plus courts chemins déjà réparés, utilisés pour les sources qu'ils contiennent
+ * @return ExportUpdateResult
+ */
+ExportUpdateResult update_export_csv(const CSRGraph &g, const VertexNumbering &numbering, const std::vector<ArcChange> &changes, const std::string &filename,
+                                     unsigned num_threads = 0, ShortestPathTreeCache *cache = nullptr);
+
+/**
+ * @brief empreinte d'un export CSV, enregistrée à côté de lui ("<export>.key") : un export n'est corrigé par des lots
+ * que s'il a été produit sur les mêmes CSV, avec la même renumérotation et les mêmes couples, après les mêmes lots,
+ * et s'il n'a pas été modifié depuis
+ */
+struct ExportFingerprint
+{
+    // CSV d'entrée, renumérotation et précision des poids
+    GraphCacheKey graph;
+    // Couples exportés (ComputeOptions::pairs, vide : tous les couples)
+    uint64_t pairs_hash = 0;
+    // Lots appliqués au graph avant l'export, chaînés dans l'ordre (0 : aucun)
+    uint64_t updates_hash = 0;
+};
+
+/**
+ * @brief empreinte des couples exportés, dans leur ordre
+ */
+uint64_t hash_export_pairs(const std::vector<std::pair<double, double>> &pairs);
+
+/**
+ * @brief ajout d'un lot à l'empreinte des lots appliqués, d'après le contenu du fichier
+ *
+ * @return false si le fichier est illisible
+ */
+bool chain_update_batch(ExportFingerprint &fingerprint, const std::string &filename);
+
+/**
+ * @brief écriture de l'empreinte de l'export, avec sa taille et sa date de modification actuelles
+ */
+bool save_export_fingerprint(const std::string &filename, const ExportFingerprint &fingerprint);
+
+/**
+ * @brief vérification qu'un export existant a été produit avec cette empreinte et n'a pas été modifié depuis
+ *
+ * @param filename export CSV
+ * @param fingerprint empreinte attendue
+ * @return false si l'export, son empreinte ou l'une des clés manque ou diffère
+ */
+bool export_matches_fingerprint(const std::string &filename, const ExportFingerprint &fingerprint);
+
+#endif // GRAPH_UPDATES_H
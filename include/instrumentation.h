@@ -0,0 +1,166 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <ostream>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief phases chronométrées (temps cumulé et nombre d'appels)
+ *
+ * Search et Write sont mesurées dans les threads d'export : leur temps est la somme des threads.
+ */
+enum class Phase
+{
+    Load,        // projection des CSV et premier passage (comptage des lignes)
+    Parse,       // analyse des champs
+    Weights,     // calcul des poids des arêtes
+    Build,       // construction du graph CSR
+    CacheLoad,   // lecture du cache binaire
+    CacheSave,   // écriture du cache binaire
+    Preprocess,  // hiérarchie de contraction
+    Metrics,     // étapes 1 à 3 de compute_graph
+    Cycles,      // étape 4
+    SinglePath,  // étape 5
+    Export,      // étape 8, écriture comprise
+    Search,      // recherches de plus courts chemins
+    Write,       // écriture des tranches de sortie
+    Update,      // application d'un lot de modifications d'arêtes et réparations associées
+    Count
+};
+
+/**
+ * @brief compteurs d'événements cumulés
+ */
+enum class Counter
+{
+    Searches,
+    HeapPushes,
+    HeapPops,
+    Relaxations,
+    SettledVertices,
+    BytesWritten,
+    Count
+};
+
+/**
+ * @brief compteurs d'une recherche, accumulés localement puis ajoutés une seule fois aux totaux
+ */
+struct SearchCounters
+{
+    uint64_t pushes = 0;
+    uint64_t pops = 0;
+    uint64_t relaxations = 0;
+    uint64_t settled = 0;
+};
+
+/**
+ * @brief ajout d'une durée au total d'une phase (compteurs atomiques, utilisable depuis plusieurs threads)
+ *
+ * @param phase
+ * @param nanoseconds
+ */
+void add_phase_time(Phase phase, uint64_t nanoseconds);
+
+/**
+ * @brief ajout à un compteur
+ *
+ * @param counter
+ * @param value
+ */
+void add_counter(Counter counter, uint64_t value = 1);
+
+/**
+ * @brief ajout des compteurs d'une recherche terminée
+ *
+ * @param counters
+ */
+void record_search(const SearchCounters &counters);
+
+uint64_t phase_nanoseconds(Phase phase);
+uint64_t phase_calls(Phase phase);
+uint64_t counter_value(Counter counter);
+const char *phase_name(Phase phase);
+const char *counter_name(Counter counter);
+
+/**
+ * @brief remise à zéro de toutes les phases et de tous les compteurs
+ */
+void reset_instrumentation();
+
+/**
+ * @brief écriture des mesures : format texte Prometheus si filename se termine par ".prom", JSON sinon
+ *
+ * Mémoire résidente actuelle et maximale jointes lorsque la plateforme les fournit.
+ *
+ * @param filename
+ * @return false si le fichier ne peut pas être écrit
+ */
+bool write_instrumentation(const std::string &filename);
+
+/**
+ * @brief mémoire résidente du processus : actuelle et maximale depuis le lancement (octets)
+ *
+ * Linux : VmRSS et VmHWM de /proc/self/status ; Windows : GetProcessMemoryInfo.
+ *
+ * @param current
+ * @param peak
+ * @return false si la plateforme ne fournit pas ces mesures
+ */
+bool resident_memory(uint64_t &current, uint64_t &peak);
+
+/**
+ * @brief mémoire occupée par chaque structure (octets réservés), pour --memory-report
+ */
+struct MemoryReport
+{
+    std::vector<std::pair<std::string, uint64_t>> components;
+
+    void add(const std::string &name, uint64_t bytes) { components.emplace_back(name, bytes); }
+};
+
+/**
+ * @brief affichage des composants, de leur total et de la mémoire résidente du processus
+ *
+ * @param out
+ * @param report
+ */
+void print_memory_report(std::ostream &out, const MemoryReport &report);
+
+/**
+ * @brief chronomètre d'une portée : deux lectures d'horloge et deux additions atomiques par mesure
+ */
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(Phase phase) : phase(phase), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() { record(std::chrono::steady_clock::now()); }
+
+    /**
+     * @brief fin de la mesure en cours et début d'une mesure de la phase next
+     */
+    void restart(Phase next)
+    {
+        auto now = std::chrono::steady_clock::now();
+        record(now);
+        phase = next;
+        start = now;
+    }
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+    void record(std::chrono::steady_clock::time_point end)
+    {
+        add_phase_time(phase, std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+
+    Phase phase;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif // INSTRUMENTATION_H
@@ -0,0 +1,124 @@
+#ifndef ORDERED_WRITER_H
+#define ORDERED_WRITER_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include "instrumentation.h"
+
+/**
+ * @brief nombre de threads effectif (0 : tous les coeurs disponibles), borné par la quantité de travail
+ *
+ * @param num_threads
+ * @param work_items
+ * @return unsigned
+ */
+inline unsigned resolve_num_threads(unsigned num_threads, size_t work_items)
+{
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return static_cast<unsigned>(std::min<size_t>(num_threads, std::max<size_t>(1, work_items)));
+}
+
+/**
+ * @brief écriture d'une tranche, comptée dans la phase Write et le compteur BytesWritten
+ *
+ * @param file
+ * @param text
+ */
+inline void write_chunk(std::ostream &file, const std::string &text)
+{
+    ScopedTimer timer(Phase::Write);
+    file.write(text.data(), text.size());
+    add_counter(Counter::BytesWritten, text.size());
+}
+
+/**
+ * @brief production parallèle de tranches de texte écrites dans l'ordre des tranches
+ *
+ * Chaque thread possède son propre état (State, construit par défaut) et produit les tranches qu'il prend
+ * dans l'ordre croissant ; le thread appelant écrit les tranches terminées dans l'ordre. Le nombre de tranches
+ * produites mais pas encore écrites est borné pour limiter la mémoire.
+ *
+ * @param file
+ * @param num_chunks
+ * @param num_threads nombre de threads déjà résolu (au moins 1)
+ * @param produce appelée comme produce(State &, size_t chunk, std::string &text)
+ */
+template <class State, class Produce>
+void write_chunks_in_order(std::ostream &file, size_t num_chunks, unsigned num_threads, Produce &&produce)
+{
+    if (num_threads <= 1) {
+        State state;
+        std::string text;
+        for (size_t c = 0; c < num_chunks; ++c) {
+            text.clear();
+            produce(state, c, text);
+            write_chunk(file, text);
+        }
+        return;
+    }
+
+    size_t window = num_threads * 4;
+    std::vector<std::string> chunk_text(num_chunks);
+    std::vector<char> chunk_ready(num_chunks, 0);
+    size_t next_chunk = 0, written = 0;
+    std::mutex m;
+    std::condition_variable cv_ready, cv_space;
+
+    auto worker = [&]() {
+        State state;
+        for (;;) {
+            size_t c;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv_space.wait(lock, [&] { return next_chunk >= num_chunks || next_chunk < written + window; });
+                if (next_chunk >= num_chunks) {
+                    return;
+                }
+                c = next_chunk++;
+            }
+
+            std::string text;
+            produce(state, c, text);
+
+            {
+                std::lock_guard<std::mutex> lock(m);
+                chunk_text[c] = std::move(text);
+                chunk_ready[c] = 1;
+            }
+            cv_ready.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < num_threads; ++t) {
+        pool.emplace_back(worker);
+    }
+
+    for (size_t c = 0; c < num_chunks; ++c) {
+        std::string text;
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv_ready.wait(lock, [&] { return chunk_ready[c] != 0; });
+            text.swap(chunk_text[c]);
+        }
+        write_chunk(file, text);
+        {
+            std::lock_guard<std::mutex> lock(m);
+            written = c + 1;
+        }
+        cv_space.notify_all();
+    }
+
+    for (auto &t : pool) {
+        t.join();
+    }
+}
+
+#endif // ORDERED_WRITER_H
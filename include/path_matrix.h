@@ -0,0 +1,103 @@
+#ifndef PATH_MATRIX_H
+#define PATH_MATRIX_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "graph_analysis.h"
+#include "csv_loader.h"
+
+/**
+ * @brief version du format binaire des matrices de prédécesseurs
+ */
+const uint32_t PATH_MATRIX_VERSION = 1;
+
+/**
+ * @brief en-tête du fichier, suivi de l'index (num_sources entrées triées par source) puis des lignes
+ *
+ * Chaque ligne contient l'arbre des plus courts chemins complet d'une source : prédécesseurs (n uint32, un sommet
+ * non atteint est son propre prédécesseur) complétés à 8 octets, puis distances (n double, infini si non atteint).
+ */
+struct PathMatrixHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t num_vertices;
+    uint64_t num_sources;
+    uint64_t index_offset;
+    uint64_t row_size;
+};
+
+/**
+ * @brief entrée de l'index : source (indice à partir de 0) et position de sa ligne dans le fichier
+ */
+struct PathMatrixIndexEntry
+{
+    uint32_t source;
+    uint32_t reserved;
+    uint64_t offset;
+};
+
+/**
+ * @brief export binaire des arbres de plus courts chemins des sources de list_Node (une ligne par source,
+ * quel que soit le nombre d'arrivées), tout chemin pouvant être reconstruit à la lecture
+ *
+ * @param g
+ * @param list_Node couples (départ, arrivée) en numérotation 1..n, seuls les départs sont utilisés
+ * @param numbering numérotation des fichiers du graph : sources, prédécesseurs et distances y sont écrits
+ * @param filename
+ * @param num_threads nombre de threads de calcul (0 : tous les coeurs disponibles)
+ */
+void write_path_matrix(const Graph &g, const std::vector<std::pair<double, double>> &list_Node, const VertexNumbering &numbering,
+                       const std::string &filename, unsigned num_threads = 0);
+void write_path_matrix(const CSRGraph &g, const std::vector<std::pair<double, double>> &list_Node, const VertexNumbering &numbering,
+                       const std::string &filename, unsigned num_threads = 0);
+void write_path_matrix(const CompactGraph &g, const std::vector<std::pair<double, double>> &list_Node, const VertexNumbering &numbering,
+                       const std::string &filename, unsigned num_threads = 0);
+
+/**
+ * @brief lecture d'une matrice de prédécesseurs projetée en mémoire
+ */
+class PathMatrixReader
+{
+public:
+    /**
+     * @brief ouverture et vérification de l'en-tête et de la taille du fichier
+     *
+     * @param filename
+     * @return false si le fichier est absent, d'une autre version ou tronqué
+     */
+    bool open(const std::string &filename);
+
+    size_t num_vertices() const { return n; }
+    size_t num_sources() const { return index.size(); }
+
+    /**
+     * @brief sources présentes dans le fichier (indices à partir de 0), dans l'ordre croissant
+     */
+    std::vector<Vertex> sources() const;
+
+    bool has_source(Vertex source) const;
+
+    /**
+     * @brief reconstruction du chemin source -> goal (indices à partir de 0)
+     *
+     * @param source
+     * @param goal
+     * @param path sommets dans l'ordre source -> goal
+     * @param length
+     * @return false si goal n'est pas atteignable ou si la source n'est pas dans le fichier
+     */
+    bool path(Vertex source, Vertex goal, std::vector<Vertex> &path, double &length) const;
+
+private:
+    const PathMatrixIndexEntry *find(Vertex source) const;
+
+    std::unique_ptr<MappedFile> file;
+    std::vector<PathMatrixIndexEntry> index;
+    size_t n = 0;
+};
+
+#endif // PATH_MATRIX_H
@@ -0,0 +1,277 @@
+#ifndef PATH_SEARCH_H
+#define PATH_SEARCH_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <memory>
+#include <atomic>
+#include <string>
+#include <istream>
+#include "graph_analysis.h"
+#include "search_engines.h"
+#include "csv_loader.h"
+
+/**
+ * @brief tampons de travail d'une recherche de plus courts chemins, réutilisés d'une source à l'autre
+ *
+ * Seuls les sommets touchés par la recherche précédente sont remis à zéro, ce qui évite
+ * un parcours complet des tableaux lorsque la recherche s'arrête tôt. Sommets sur 32 bits, comme dans les
+ * graphs CSR et compact : 16 octets par sommet du graph (distance, prédécesseur, marque d'arrivée).
+ */
+struct SearchScratch
+{
+    std::vector<double> distances;
+    std::vector<uint32_t> predecessors;
+    std::vector<uint32_t> touched;
+    std::vector<uint32_t> goal_epoch;
+    std::vector<std::pair<double, Vertex>> heap;
+    uint32_t epoch = 0;
+    size_t settled = 0;
+
+    // File de priorité de dijkstra_to_goals et threads de delta-stepping (0 : tous les coeurs disponibles)
+    SearchEngine engine = default_search_engine();
+    unsigned engine_threads = 0;
+    EngineBuffers queues;
+
+    // Tampons de la recherche arrière (Dijkstra bidirectionnel), alloués à la première utilisation
+    std::unique_ptr<SearchScratch> backward;
+
+    // Demande d'abandon posée par un autre thread (interface) ; cancelled indique que la dernière recherche
+    // s'est arrêtée avant d'aboutir, ses distances et prédécesseurs sont alors incomplets
+    const std::atomic<bool> *cancel = nullptr;
+    bool cancelled = false;
+
+    void resize(size_t n);
+    void reset();
+    void prepare(size_t n);
+
+    /**
+     * @brief mémoire réservée par ces tampons (octets), recherche arrière et moteurs compris
+     */
+    size_t memory_used() const;
+
+    /**
+     * @brief marquage des sommets à atteindre pour une nouvelle recherche
+     *
+     * @param goals
+     * @return nombre de sommets distincts marqués
+     */
+    size_t mark_goals(const std::vector<Vertex> &goals);
+
+    /**
+     * @brief lecture de la demande d'abandon, mémorisée dans cancelled
+     */
+    bool cancel_requested()
+    {
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            cancelled = true;
+        }
+        return cancelled;
+    }
+
+    /**
+     * @brief lecture espacée de la demande d'abandon dans une boucle de recherche
+     *
+     * @param step compteur croissant de la boucle (sommets fixés, extractions)
+     */
+    bool poll_cancel(size_t step)
+    {
+        return cancel && step % 1024 == 0 && cancel_requested();
+    }
+};
+
+/**
+ * @brief résultat d'une requête point à point (indices à partir de 0)
+ */
+struct PathResult
+{
+    bool found = false;
+    double length = 0;
+    std::vector<Vertex> path;
+    size_t settled = 0;
+    // Recherche abandonnée sur demande (SearchScratch::cancel) : found est faux, sans conclure à l'absence de chemin
+    bool cancelled = false;
+};
+
+/**
+ * @brief regroupement des couples (départ, arrivée) par sommet de départ
+ *
+ * Les sources apparaissent dans l'ordre de leur première occurrence dans la liste.
+ * Si chaque source occupe une plage contiguë de la liste (cas de compute_graph), les plages
+ * sont référencées directement (rows vide) ; sinon les indices de lignes sont triés par source
+ * dans rows, en conservant leur ordre d'origine au sein d'une même source.
+ */
+struct PairBatches
+{
+    std::vector<Vertex> sources;
+    std::vector<size_t> offsets;
+    std::vector<size_t> rows;
+    size_t n = 0;
+    bool contiguous = true;
+
+    size_t size() const { return sources.size(); }
+};
+
+/**
+ * @brief vérifie qu'un couple (départ, arrivée) en numérotation 1..n est valide
+ *
+ * @param start
+ * @param goal
+ * @param n
+ * @return true
+ * @return false
+ */
+inline bool valid_pair(double start, double goal, size_t n)
+{
+    return start >= 1 && goal >= 1 && start <= n && goal <= n;
+}
+
+/**
+ * @brief lecture de couples "départ;arrivée" (numérotation 1..n), une ligne par couple, lignes vides ignorées
+ *
+ * Un en-tête "Start;End" en première ligne est sauté et les colonnes suivantes d'une ligne d'export sont ignorées ;
+ * toute autre ligne qui ne commence pas par deux nombres séparés par ';' est signalée avec son numéro.
+ *
+ * @param in
+ * @param list_Node couples ajoutés à la fin ; les lignes invalides sont signalées dans le résultat, sans être ajoutées
+ * @return CSVLoadResult
+ */
+CSVLoadResult read_pairs(std::istream &in, std::vector<std::pair<double, double>> &list_Node);
+
+/**
+ * @brief construction des lots de requêtes par source, les couples invalides sont signalés et ignorés
+ *
+ * @param list_Node
+ * @param n
+ * @return PairBatches
+ */
+PairBatches group_pairs_by_source(const std::vector<std::pair<double, double>> &list_Node, size_t n);
+
+/**
+ * @brief parcours, dans l'ordre de list_Node, des lignes valides du lot b
+ *
+ * @param batches
+ * @param list_Node
+ * @param b
+ * @param f appelée avec l'indice de chaque ligne
+ */
+template <typename F>
+void for_each_batch_row(const PairBatches &batches, const std::vector<std::pair<double, double>> &list_Node, size_t b, F &&f)
+{
+    if (!batches.contiguous) {
+        for (size_t i = batches.offsets[b]; i < batches.offsets[b + 1]; ++i) {
+            f(batches.rows[i]);
+        }
+        return;
+    }
+
+    // Plage contiguë : les lignes invalides intercalées ont déjà été signalées
+    for (size_t r = batches.offsets[b]; r < batches.offsets[b + 1]; ++r) {
+        if (valid_pair(list_Node[r].first, list_Node[r].second, batches.n)) {
+            f(r);
+        }
+    }
+}
+
+/**
+ * @brief algorithme de Dijkstra depuis une source, arrêté dès que tous les sommets de goals sont fixés
+ *
+ * Si goals est vide, la recherche parcourt toute la composante de la source. La file de priorité est
+ * celle de scratch.engine.
+ *
+ * @param g
+ * @param source
+ * @param goals
+ * @param scratch
+ */
+void dijkstra_to_goals(const Graph &g, Vertex source, const std::vector<Vertex> &goals, SearchScratch &scratch);
+void dijkstra_to_goals(const CSRGraph &g, Vertex source, const std::vector<Vertex> &goals, SearchScratch &scratch);
+void dijkstra_to_goals(const CompactGraph &g, Vertex source, const std::vector<Vertex> &goals, SearchScratch &scratch);
+
+/**
+ * @brief recherche A* de start vers goal, guidée par la distance euclidienne 3D au but, arrêtée dès que goal est fixé
+ *
+ * Les poids des arêtes étant les distances euclidiennes entre extrémités (calcul_distance), l'heuristique
+ * est admissible et consistante ; elle est très légèrement minorée pour absorber l'arrondi des poids en float.
+ *
+ * @param g
+ * @param coord_list
+ * @param source
+ * @param goal
+ * @param scratch
+ */
+void astar_to_goal(const Graph &g, const CoordinateStore &coord_list, Vertex source, Vertex goal, SearchScratch &scratch);
+void astar_to_goal(const CSRGraph &g, const CoordinateStore &coord_list, Vertex source, Vertex goal, SearchScratch &scratch);
+void astar_to_goal(const CompactGraph &g, const CoordinateStore &coord_list, Vertex source, Vertex goal, SearchScratch &scratch);
+
+/**
+ * @brief Dijkstra bidirectionnel : recherches avant depuis source et arrière depuis goal, arrêtées dès que
+ * la somme des deux minima de file dépasse la meilleure longueur trouvée (règle du point de rencontre)
+ *
+ * La recherche arrière suit les arcs entrants pour un graph bidirectionnel ; pour les graphs CSR et compact,
+ * qui ne donnent que les arcs sortants, elle s'appuie sur la symétrie du graph (chaque arête est présente dans les deux sens).
+ *
+ * @param g
+ * @param source
+ * @param goal
+ * @param scratch
+ * @param meeting sommet de rencontre des deux recherches
+ * @return false si goal n'est pas atteignable
+ */
+bool bidirectional_dijkstra(const Graph &g, Vertex source, Vertex goal, SearchScratch &scratch, Vertex &meeting);
+bool bidirectional_dijkstra(const CSRGraph &g, Vertex source, Vertex goal, SearchScratch &scratch, Vertex &meeting);
+bool bidirectional_dijkstra(const CompactGraph &g, Vertex source, Vertex goal, SearchScratch &scratch, Vertex &meeting);
+
+/**
+ * @brief requête point à point avec l'algorithme choisi
+ *
+ * @param g
+ * @param coord_list
+ * @param start indice à partir de 0
+ * @param goal indice à partir de 0
+ * @param mode
+ * @param scratch
+ * @return PathResult
+ */
+PathResult shortest_path_query(const Graph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, SearchScratch &scratch);
+PathResult shortest_path_query(const CSRGraph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, SearchScratch &scratch);
+PathResult shortest_path_query(const CompactGraph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, SearchScratch &scratch);
+
+/**
+ * @brief nom lisible d'un mode de recherche
+ *
+ * @param mode
+ * @return const char*
+ */
+const char *search_mode_name(SearchMode mode);
+
+/**
+ * @brief reconstruction du chemin source -> goal à partir des prédécesseurs de la dernière recherche
+ *
+ * @param scratch
+ * @param source
+ * @param goal
+ * @param path sommets dans l'ordre source -> goal
+ * @return false si goal n'est pas atteignable
+ */
+bool extract_path(const SearchScratch &scratch, Vertex source, Vertex goal, std::vector<Vertex> &path);
+
+/**
+ * @brief ajout d'une ligne d'export "Start;End;Path Length;Path" (identifiants à partir de 1) à un tampon texte
+ *
+ * Nombres convertis par std::to_chars, au même format que l'écriture par flux (6 chiffres significatifs).
+ * Départ, arrivée et chemin sont des sommets internes, écrits dans la numérotation des fichiers.
+ *
+ * @param out
+ * @param start
+ * @param goal
+ * @param found
+ * @param length
+ * @param path sommets (indices à partir de 0) dans l'ordre start -> goal
+ * @param numbering numérotation des fichiers du graph
+ */
+void write_path_row(std::string &out, double start, double goal, bool found, double length, const std::vector<Vertex> &path,
+                    const VertexNumbering &numbering);
+
+#endif // PATH_SEARCH_H
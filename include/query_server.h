@@ -0,0 +1,135 @@
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include "graph_analysis.h"
+#include "contraction_hierarchy.h"
+#include "search_engines.h"
+#include "vertex_order.h"
+
+/**
+ * @brief graph servi par le démon : remplacé en bloc au rechargement, les requêtes en cours gardent l'ancien
+ */
+struct GraphSnapshot
+{
+    CoordinateStore coord_list;
+    CSRGraph g;
+    // Sommets dans l'ordre des CSV : le démon ne renumérote pas le graph
+    VertexNumbering numbering;
+    ContractionHierarchy ch;
+    bool has_ch = false;
+    uint64_t generation = 0;
+};
+
+/**
+ * @brief configuration du démon de requêtes
+ */
+struct QueryServerConfig
+{
+    std::string filename_nodes = "data/nodes.csv";
+    std::string filename_edges = "data/edges.csv";
+    // Cache binaire du graph (vide : pas de cache)
+    std::string filename_cache;
+    // Hiérarchie de contraction (vide : pas de mode "ch")
+    std::string filename_ch;
+    std::string socket_path = "/tmp/graph_analysis.sock";
+    // Threads du pool qui servent les requêtes de toutes les connexions (0 : tous les coeurs disponibles)
+    unsigned num_threads = 0;
+    // Algorithme des requêtes tant que le client n'en choisit pas un autre
+    SearchMode default_mode = SearchMode::AStar;
+
+    // File de priorité des recherches de Dijkstra tant que le client n'en choisit pas une autre
+    SearchEngine default_engine = SearchEngine::BinaryHeap;
+
+    // Précision du calcul des poids au chargement et à chaque RELOAD
+    WeightPrecision weight_precision = WeightPrecision::Double;
+};
+
+struct ServerWorker;
+struct ServerTask;
+struct ServerReply;
+struct ServerConnection;
+class ServerTaskQueue;
+
+/**
+ * @brief démon de requêtes de plus courts chemins sur une socket Unix locale
+ *
+ * Protocole texte, une requête par ligne, réponses dans l'ordre des requêtes de chaque connexion
+ * (les requêtes peuvent être envoyées par lots sans attendre les réponses) :
+ *   "départ arrivée" ou "départ;arrivée" -> ligne d'export "départ;arrivée;longueur;[chemin]" ou "départ;arrivée;Inf;No Path"
+ *   MODE dijkstra|astar|bidirectional|ch   -> "OK", algorithme des requêtes suivantes de la connexion
+ *   ENGINE binary|radix|buckets|delta      -> "OK", file de priorité du mode dijkstra pour la connexion
+ *   STATS    -> "OK vertices <n> arcs <m> generation <g> queries <q> connections <c>"
+ *   RELOAD   -> "OK vertices <n> arcs <m> generation <g>" : relecture des fichiers et remplacement atomique du graph
+ *   UPDATE <fichier> -> "OK vertices <n> arcs <m> generation <g> changed <k>" : lot de modifications d'arêtes
+ *              (format de load_edge_updates) appliqué à une copie du graph servi, puis remplacement atomique ;
+ *              un RELOAD ultérieur revient aux fichiers de la configuration
+ *   QUIT     -> fermeture de la connexion
+ *   SHUTDOWN -> arrêt du démon
+ * Les erreurs sont signalées par une ligne commençant par "ERR".
+ *
+ * Un seul thread lit toutes les connexions (poll) et confie les requêtes au pool, par blocs de lignes
+ * consécutives d'une même connexion ; les réponses sont remises dans l'ordre des requêtes de chaque connexion,
+ * si bien qu'une connexion inactive n'occupe aucun thread et qu'un lot se répartit entre les threads.
+ * MODE et ENGINE s'appliquent aux requêtes qui les suivent ; les autres commandes attendent les réponses
+ * des requêtes qui les précèdent, et les requêtes qui suivent RELOAD ou UPDATE sont servies sur le nouveau graph.
+ */
+class QueryServer
+{
+public:
+    explicit QueryServer(const QueryServerConfig &config);
+    ~QueryServer();
+
+    QueryServer(const QueryServer &) = delete;
+    QueryServer &operator=(const QueryServer &) = delete;
+
+    /**
+     * @brief chargement (ou rechargement) du graph depuis les fichiers de la configuration
+     *
+     * @return false si le chargement échoue (le graph courant est conservé)
+     */
+    bool reload();
+
+    /**
+     * @brief application d'un lot de modifications d'arêtes au graph servi, sans relecture des CSV
+     *
+     * La hiérarchie de contraction éventuelle est reconstruite en mémoire pour le graph modifié.
+     *
+     * @param filename lot au format de load_edge_updates
+     * @param changed nombre de paires de sommets modifiées
+     * @return false si le lot est illisible ou contient des lignes invalides (le graph courant est conservé)
+     */
+    bool apply_updates(const std::string &filename, size_t &changed);
+
+    /**
+     * @brief écoute de la socket et service des connexions jusqu'à stop() ou SHUTDOWN
+     *
+     * @return false si la socket ne peut pas être créée
+     */
+    bool run();
+
+    /**
+     * @brief demande d'arrêt, utilisable depuis un autre thread ou un gestionnaire de signal
+     */
+    void stop() { stopping.store(true); }
+
+    std::shared_ptr<const GraphSnapshot> snapshot() const;
+
+private:
+    void run_task(const ServerTask &task, ServerWorker &worker, ServerReply &reply);
+    void dispatch_lines(uint64_t id, ServerConnection &connection, ServerTaskQueue &tasks);
+
+    QueryServerConfig config;
+    std::shared_ptr<const GraphSnapshot> current;
+    std::mutex reload_mutex;
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> queries{0};
+    std::atomic<uint64_t> connections{0};
+};
+
+#endif // QUERY_SERVER_H
@@ -0,0 +1,150 @@
+#ifndef RENDER_INDEX_H
+#define RENDER_INDEX_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "graph_analysis.h"
+
+/**
+ * @brief rectangle du plan (x, y) de l'affichage
+ */
+struct RenderRect
+{
+    double x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+
+    bool contains(double x, double y) const { return x >= x0 && x <= x1 && y >= y0 && y <= y1; }
+};
+
+/**
+ * @brief index spatial de l'affichage : grille uniforme sur le plan (x, y), sans dépendance à Qt
+ *
+ * Les sommets sont rangés par case (environ quatre par case). Chaque arête non orientée est conservée une
+ * seule fois (u < v, arcs parallèles fusionnés), dans une hiérarchie de grilles lâches : elle va dans la case
+ * de son milieu au premier niveau dont les cases (de côté double à chaque niveau) sont plus grandes qu'elle.
+ * L'interface ne parcourt ainsi que les cases qui recouvrent la zone visible, quelle que soit la longueur des arêtes.
+ * Les positions sont lues directement dans les tableaux x et y des coordonnées, qui doivent survivre à l'index.
+ */
+class RenderIndex
+{
+public:
+    static RenderIndex build(const Graph &g, const CoordinateStore &coord_list);
+    static RenderIndex build(const CSRGraph &g, const CoordinateStore &coord_list);
+
+    /**
+     * @brief boîte englobante des sommets
+     */
+    const RenderRect &bounds() const { return box; }
+
+    /**
+     * @brief côté d'une case de la grille
+     */
+    double cell_size() const { return cell; }
+
+    /**
+     * @brief position d'un sommet dans le plan de l'affichage
+     */
+    double x(uint32_t v) const { return xs[v]; }
+    double y(uint32_t v) const { return ys[v]; }
+
+    /**
+     * @brief arêtes non orientées (u < v), chacune une fois
+     */
+    const std::vector<std::pair<uint32_t, uint32_t>> &edges() const { return edge_list; }
+
+    /**
+     * @brief sommets situés dans r
+     *
+     * @param r
+     * @param one_per_cell un seul sommet par case, lorsque la case est plus petite qu'un pixel
+     * @param visit appelée comme visit(uint32_t sommet)
+     */
+    template <typename F>
+    void for_each_vertex(const RenderRect &r, bool one_per_cell, F &&visit) const
+    {
+        size_t c0, c1, r0, r1;
+        if (!cell_range(r, 0, c0, c1, r0, r1)) {
+            return;
+        }
+        for (size_t row = r0; row <= r1; ++row) {
+            for (size_t col = c0; col <= c1; ++col) {
+                size_t c = row * cols + col;
+                for (uint64_t i = vertex_start[c]; i < vertex_start[c + 1]; ++i) {
+                    uint32_t v = cell_vertices[i];
+                    if (r.contains(xs[v], ys[v])) {
+                        visit(v);
+                        if (one_per_cell) {
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief arêtes dont la boîte englobante rencontre r et dont la longueur dans le plan atteint min_length
+     *
+     * @param r
+     * @param min_length arêtes plus courtes ignorées (moins d'un pixel : confondues avec leurs extrémités)
+     * @param visit appelée comme visit(uint32_t u, uint32_t v)
+     */
+    template <typename F>
+    void for_each_edge(const RenderRect &r, double min_length, F &&visit) const
+    {
+        auto test = [&](uint32_t e) {
+            if (edge_length[e] < min_length) {
+                return;
+            }
+            auto [u, v] = edge_list[e];
+            if (std::max(xs[u], xs[v]) >= r.x0 && std::min(xs[u], xs[v]) <= r.x1 &&
+                std::max(ys[u], ys[v]) >= r.y0 && std::min(ys[u], ys[v]) <= r.y1) {
+                visit(u, v);
+            }
+        };
+        // Arêtes d'une case : à moins d'une demi-case de son milieu
+        for (const EdgeLevel &level : edge_levels) {
+            size_t c0, c1, r0, r1;
+            if (!level_range(level, r, c0, c1, r0, r1)) {
+                continue;
+            }
+            for (size_t row = r0; row <= r1; ++row) {
+                for (size_t col = c0; col <= c1; ++col) {
+                    size_t c = row * level.cols + col;
+                    for (uint64_t i = level.start[c]; i < level.start[c + 1]; ++i) {
+                        test(level.edges[i]);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    // Grille d'arêtes d'un niveau, arêtes triées par case (décalages de type CSR)
+    struct EdgeLevel
+    {
+        double cell = 1;
+        size_t cols = 1, rows = 1;
+        std::vector<uint64_t> start;
+        std::vector<uint32_t> edges;
+    };
+
+    template <class G>
+    static RenderIndex build_impl(const G &g, const CoordinateStore &coord_list);
+    bool cell_range(const RenderRect &r, double margin, size_t &c0, size_t &c1, size_t &r0, size_t &r1) const;
+    bool level_range(const EdgeLevel &level, const RenderRect &r, size_t &c0, size_t &c1, size_t &r0, size_t &r1) const;
+
+    RenderRect box;
+    double cell = 1;
+    size_t cols = 1, rows = 1;
+    size_t n = 0;
+    const double *xs = nullptr, *ys = nullptr;
+    // Sommets triés par case
+    std::vector<uint64_t> vertex_start;
+    std::vector<uint32_t> cell_vertices;
+    std::vector<EdgeLevel> edge_levels;
+    std::vector<std::pair<uint32_t, uint32_t>> edge_list;
+    std::vector<float> edge_length;
+};
+
+#endif // RENDER_INDEX_H
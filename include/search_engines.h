@@ -0,0 +1,94 @@
+#ifndef SEARCH_ENGINES_H
+#define SEARCH_ENGINES_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <string>
+#include <utility>
+#include <cstdint>
+#include "graph_analysis.h"
+
+/**
+ * @brief file de priorité des recherches de Dijkstra (dijkstra_to_goals), choisie à l'exécution
+ *
+ * Tous les moteurs calculent exactement les mêmes distances ; seuls les prédécesseurs peuvent différer
+ * entre chemins de même longueur.
+ */
+enum class SearchEngine
+{
+    BinaryHeap,     // tas binaire sur (distance, sommet)
+    RadixHeap,      // tas radix sur la représentation binaire des distances (positives, donc monotone)
+    BucketQueue,    // seaux de largeur fixe (Dial), distances quantifiées par la largeur des seaux
+    DeltaStepping   // seaux de largeur delta traités en parallèle, pour les recherches sur tout le graph
+};
+
+/**
+ * @brief nom court d'un moteur ("binary", "radix", "buckets", "delta")
+ *
+ * @param engine
+ * @return const char*
+ */
+const char *search_engine_name(SearchEngine engine);
+
+/**
+ * @brief moteur correspondant à un nom court
+ *
+ * @param name
+ * @param engine
+ * @return false si le nom est inconnu
+ */
+bool parse_search_engine(const std::string &name, SearchEngine &engine);
+
+/**
+ * @brief moteur des tampons de recherche créés ensuite (tas binaire par défaut)
+ *
+ * @param engine
+ */
+void set_default_search_engine(SearchEngine engine);
+SearchEngine default_search_engine();
+
+/**
+ * @brief tampons propres aux moteurs autres que le tas binaire, alloués à leur première utilisation
+ */
+struct EngineBuffers
+{
+    // Tas radix : seau 0 pour la dernière clé extraite, seau i pour les clés dont le bit de poids fort
+    // différent de cette clé est le bit i - 1
+    std::vector<std::pair<uint64_t, Vertex>> radix[65];
+
+    // Seaux circulaires (Dial) et entrées au-delà de la fenêtre
+    std::vector<std::vector<std::pair<double, Vertex>>> buckets;
+    std::vector<std::pair<double, Vertex>> overflow;
+
+    // Delta-stepping : distances atomiques, distance des sommets déjà relâchés, seaux et sommets d'un seau
+    std::unique_ptr<std::atomic<uint64_t>[]> atomic_distances;
+    std::vector<double> relaxed;
+    std::vector<std::vector<Vertex>> delta_buckets;
+    std::vector<Vertex> removed;
+    size_t capacity = 0;
+
+    // Poids extrêmes et moyen du dernier graph parcouru (largeur des seaux) ; une valeur périmée
+    // ne ralentit que la recherche, les distances restent exactes
+    const void *weights_graph = nullptr;
+    size_t weights_arcs = 0;
+    double min_weight = 0;
+    double max_weight = 0;
+    double mean_weight = 0;
+};
+
+struct SearchScratch;
+
+/**
+ * @brief Dijkstra avec le moteur de scratch.engine (autre que le tas binaire), mêmes conventions que dijkstra_to_goals
+ *
+ * @param g
+ * @param source
+ * @param goals arrêt dès que tous sont fixés (vide : toute la composante de la source)
+ * @param scratch
+ */
+void engine_dijkstra(const Graph &g, Vertex source, const std::vector<Vertex> &goals, SearchScratch &scratch);
+void engine_dijkstra(const CSRGraph &g, Vertex source, const std::vector<Vertex> &goals, SearchScratch &scratch);
+void engine_dijkstra(const CompactGraph &g, Vertex source, const std::vector<Vertex> &goals, SearchScratch &scratch);
+
+#endif // SEARCH_ENGINES_H
@@ -0,0 +1,142 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <vector>
+#include <array>
+#include <utility>
+#include <istream>
+#include <cstdint>
+#include <cstddef>
+#include "coordinates.h"
+#include "csv_loader.h"
+
+class VertexNumbering;
+
+/**
+ * @brief sommet trouvé par l'index spatial et sa distance à la position cherchée
+ */
+struct NearestVertex
+{
+    uint32_t vertex = 0;
+    double distance = 0;
+};
+
+/**
+ * @brief couple de positions (x, y, z) de départ et d'arrivée, à ramener aux sommets du graph
+ */
+struct PositionPair
+{
+    std::array<double, 3> start;
+    std::array<double, 3> goal;
+};
+
+/**
+ * @brief arbre k-d équilibré sur les coordonnées des sommets : plus proches voisins, rayon et boîte
+ *
+ * Arbre implicite : les sommets sont rangés de sorte que le milieu de chaque tranche soit la médiane selon
+ * l'axe le plus étendu de la tranche, ses deux moitiés formant les sous-arbres ; les tranches d'au plus
+ * LEAF_SIZE sommets sont parcourues linéairement. Positions copiées dans l'ordre de l'arbre (24 octets par
+ * sommet, plus 4 pour le numéro et 1 pour l'axe), indépendamment des coordonnées d'origine. Requêtes en
+ * O(log n) en moyenne ; entre sommets à égale distance, le plus petit numéro l'emporte, comme pour un
+ * parcours linéaire.
+ */
+class SpatialIndex
+{
+public:
+    static const size_t LEAF_SIZE = 8;
+
+    /**
+     * @brief construction de l'index sur les sommets de coord_list (numérotation interne)
+     *
+     * @param coord_list
+     * @param planar altitude ignorée : distances dans le plan (x, y) de la vue 2D
+     * @return SpatialIndex
+     */
+    static SpatialIndex build(const CoordinateStore &coord_list, bool planar = false);
+
+    size_t size() const { return ids.size(); }
+    bool empty() const { return ids.empty(); }
+
+    /**
+     * @brief sommet le plus proche de (x, y, z)
+     *
+     * @return false si l'index est vide
+     */
+    bool nearest(double x, double y, double z, NearestVertex &result) const;
+
+    /**
+     * @brief les k sommets les plus proches de (x, y, z), par distance croissante
+     */
+    std::vector<NearestVertex> k_nearest(double x, double y, double z, size_t k) const;
+
+    /**
+     * @brief sommets à au plus radius de (x, y, z), par numéro croissant
+     */
+    std::vector<uint32_t> within_radius(double x, double y, double z, double radius) const;
+
+    /**
+     * @brief sommets de la boîte [lo, hi] (bornes comprises), par numéro croissant
+     */
+    std::vector<uint32_t> within_box(const std::array<double, 3> &lo, const std::array<double, 3> &hi) const;
+
+    /**
+     * @brief mémoire occupée par l'index (octets réservés)
+     */
+    size_t memory_used() const;
+
+private:
+    double squared_distance(size_t i, const double q[3]) const
+    {
+        double dx = px[i] - q[0], dy = py[i] - q[1], dz = pz[i] - q[2];
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    double coordinate(size_t i, int a) const { return a == 0 ? px[i] : a == 1 ? py[i] : pz[i]; }
+
+    template <typename Visit, typename Bound>
+    void search_nearest(size_t lo, size_t hi, const double q[3], Visit &visit, Bound &bound) const;
+    template <typename Visit>
+    void search_box(size_t lo, size_t hi, const double box_lo[3], const double box_hi[3], Visit &visit) const;
+
+    bool planar = false;
+    // Numéro de sommet, position et axe de coupe (au milieu de chaque tranche intérieure), dans l'ordre de l'arbre
+    std::vector<uint32_t> ids;
+    std::vector<double> px, py, pz;
+    std::vector<uint8_t> split_axis;
+};
+
+/**
+ * @brief recherche par lots du sommet le plus proche de chaque position, tranches réparties entre les threads
+ *
+ * @param index
+ * @param positions
+ * @param nearest redimensionné au nombre de positions
+ * @param num_threads 0 : tous les coeurs disponibles
+ */
+void snap_to_vertices(const SpatialIndex &index, const std::vector<std::array<double, 3>> &positions,
+                      std::vector<NearestVertex> &nearest, unsigned num_threads = 0);
+
+/**
+ * @brief lecture de couples de positions "x1;y1;z1;x2;y2;z2", une ligne par couple (sans en-tête), lignes vides ignorées
+ *
+ * @param in
+ * @param pairs couples ajoutés à la fin ; les lignes invalides sont signalées dans le résultat, sans être ajoutées
+ * @return CSVLoadResult
+ */
+CSVLoadResult read_position_pairs(std::istream &in, std::vector<PositionPair> &pairs);
+
+/**
+ * @brief couples de positions ramenés à leurs sommets les plus proches, dans la numérotation des fichiers
+ * (à partir de 1, format des couples de l'export et des requêtes)
+ *
+ * @param index index construit sur les coordonnées du graph (numérotation interne)
+ * @param numbering numérotation des fichiers du graph
+ * @param positions
+ * @param list_Node couples de sommets ajoutés à la fin
+ * @param num_threads 0 : tous les coeurs disponibles
+ * @return plus grande distance entre une position et son sommet
+ */
+double snap_pairs(const SpatialIndex &index, const VertexNumbering &numbering, const std::vector<PositionPair> &positions,
+                  std::vector<std::pair<double, double>> &list_Node, unsigned num_threads = 0);
+
+#endif // SPATIAL_INDEX_H
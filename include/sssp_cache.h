@@ -0,0 +1,162 @@
+#ifndef SSSP_CACHE_H
+#define SSSP_CACHE_H
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+#include "graph_analysis.h"
+#include "path_search.h"
+
+/**
+ * @brief arbre des plus courts chemins complet depuis une source (distances et prédécesseurs de tous les sommets)
+ *
+ * Un sommet non atteignable a une distance infinie (numeric_limits<double>::max()) et est son propre prédécesseur.
+ */
+struct ShortestPathTree
+{
+    Vertex source = 0;
+    std::vector<double> distances;
+    std::vector<uint32_t> predecessors;
+
+    /**
+     * @brief reconstruction du chemin source -> goal par remontée des prédécesseurs
+     *
+     * @param goal
+     * @param path sommets dans l'ordre source -> goal
+     * @return false si goal n'est pas atteignable
+     */
+    bool extract_path(Vertex goal, std::vector<Vertex> &path) const;
+
+    /**
+     * @brief requête point à point servie par l'arbre (aucun sommet fixé)
+     *
+     * @param goal
+     * @return PathResult
+     */
+    PathResult query(Vertex goal) const;
+
+    /**
+     * @brief mémoire occupée par l'arbre, comptée dans le budget du cache
+     *
+     * @return size_t
+     */
+    size_t bytes() const;
+};
+
+/**
+ * @brief cache LRU borné d'arbres de plus courts chemins, indexé par sommet source
+ *
+ * Partagé entre l'interface et les fonctions de calcul par lots : une source déjà calculée ne coûte plus
+ * qu'une remontée de prédécesseurs. Les arbres les moins récemment utilisés sont évincés dès que la mémoire
+ * occupée dépasse le budget. Les accès sont protégés par un mutex ; un arbre rendu reste valide même s'il
+ * est évincé entre-temps.
+ */
+class ShortestPathTreeCache
+{
+public:
+    static const size_t DEFAULT_BUDGET_BYTES = size_t(256) << 20;
+    static const size_t MAX_PENDING_SOURCES = 4096;
+
+    explicit ShortestPathTreeCache(size_t budget_bytes = DEFAULT_BUDGET_BYTES);
+
+    /**
+     * @brief arbre de source s'il est en cache (compté comme succès ou échec)
+     *
+     * @param source
+     * @return std::shared_ptr<const ShortestPathTree> nul si absent
+     */
+    std::shared_ptr<const ShortestPathTree> find(Vertex source);
+
+    /**
+     * @brief arbre de source, calculé par un Dijkstra complet et mis en cache s'il est absent
+     *
+     * Un calcul abandonné (scratch.cancelled) rend un arbre incomplet, qui n'est pas mis en cache.
+     *
+     * @param g
+     * @param source
+     * @param scratch tampons de la recherche en cas d'échec
+     * @return std::shared_ptr<const ShortestPathTree>
+     */
+    std::shared_ptr<const ShortestPathTree> tree(const Graph &g, Vertex source, SearchScratch &scratch);
+    std::shared_ptr<const ShortestPathTree> tree(const CSRGraph &g, Vertex source, SearchScratch &scratch);
+    std::shared_ptr<const ShortestPathTree> tree(const CompactGraph &g, Vertex source, SearchScratch &scratch);
+
+    /**
+     * @brief ajout d'un arbre (remplace celui de la même source), puis éviction jusqu'à respecter le budget
+     *
+     * Un arbre plus gros que le budget entier n'est pas conservé.
+     *
+     * @param tree
+     */
+    void insert(std::shared_ptr<const ShortestPathTree> tree);
+
+    /**
+     * @brief remplacement des arbres en cache, sous le verrou, sans changer l'ordre LRU ni les statistiques
+     *
+     * @param f appelée pour chaque arbre, rend son remplaçant ou un pointeur nul pour le conserver
+     * @return nombre d'arbres remplacés
+     */
+    size_t replace_trees(const std::function<std::shared_ptr<const ShortestPathTree>(const ShortestPathTree &)> &f);
+
+    /**
+     * @brief enregistrement d'un échec pour une requête point à point qui n'a pas construit d'arbre
+     *
+     * Les sources ainsi enregistrées sont oubliées par groupes de MAX_PENDING_SOURCES.
+     *
+     * @param source
+     * @return true si source avait déjà manqué depuis : son arbre complet mérite d'être calculé
+     */
+    bool repeated_miss(Vertex source);
+
+    void set_budget(size_t budget_bytes);
+    void clear();
+
+    size_t budget() const;
+    size_t memory_used() const;
+    size_t size() const;
+    size_t hits() const;
+    size_t misses() const;
+    size_t evictions() const;
+
+private:
+    using Entry = std::pair<Vertex, std::shared_ptr<const ShortestPathTree>>;
+
+    void evict_locked();
+
+    mutable std::mutex m;
+    size_t budget_bytes;
+    size_t used_bytes = 0;
+    size_t hit_count = 0;
+    size_t miss_count = 0;
+    size_t eviction_count = 0;
+    std::list<Entry> lru;
+    std::unordered_map<Vertex, std::list<Entry>::iterator> index;
+    // Sources manquées une fois par une requête point à point, sans arbre en cache
+    std::unordered_set<Vertex> missed_once;
+};
+
+/**
+ * @brief requête point à point passant par le cache : un arbre déjà calculé pour start répond quel que soit le mode ;
+ * sinon le mode Dijkstra calcule et met en cache l'arbre complet. Les autres modes font une recherche point à point
+ * au premier échec pour start, puis calculent et mettent en cache l'arbre complet au second (plusieurs arrivées
+ * depuis un même dépôt). Une recherche abandonnée (PathResult::cancelled) ne laisse rien dans le cache.
+ *
+ * @param g
+ * @param coord_list
+ * @param start indice à partir de 0
+ * @param goal indice à partir de 0
+ * @param mode
+ * @param scratch
+ * @param cache
+ * @return PathResult
+ */
+PathResult shortest_path_query(const Graph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, SearchScratch &scratch, ShortestPathTreeCache &cache);
+PathResult shortest_path_query(const CSRGraph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, SearchScratch &scratch, ShortestPathTreeCache &cache);
+PathResult shortest_path_query(const CompactGraph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, SearchScratch &scratch, ShortestPathTreeCache &cache);
+
+#endif // SSSP_CACHE_H
@@ -0,0 +1,131 @@
+#ifndef VERTEX_ORDER_H
+#define VERTEX_ORDER_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+#include "graph_analysis.h"
+
+/**
+ * @brief renumérotation des sommets au chargement, pour rapprocher en mémoire les sommets voisins
+ */
+enum class VertexOrdering
+{
+    None,        // ordre des fichiers CSV
+    Hilbert,     // courbe de Hilbert 3D sur les coordonnées
+    Morton,      // courbe de Morton (ordre Z) 3D sur les coordonnées
+    CuthillMcKee // Cuthill-McKee inverse sur la topologie (parcours en largeur par degrés croissants)
+};
+
+/**
+ * @brief nom court d'un ordre ("none", "hilbert", "morton", "rcm")
+ *
+ * @param ordering
+ * @return const char*
+ */
+const char *vertex_ordering_name(VertexOrdering ordering);
+
+/**
+ * @brief ordre correspondant à un nom court
+ *
+ * @param name
+ * @param ordering
+ * @return false si le nom est inconnu
+ */
+bool parse_vertex_ordering(const std::string &name, VertexOrdering &ordering);
+
+/**
+ * @brief localité des arcs avant et après la renumérotation
+ *
+ * La largeur de bande est le plus grand écart |u - v| entre les extrémités d'un arc ; l'écart logarithmique
+ * moyen, moyenne de log2(1 + |u - v|) sur tous les arcs, compte les bits qui séparent les numéros de deux
+ * voisins : plus il est faible, plus les voisins d'un sommet partagent les mêmes lignes de cache et pages.
+ */
+struct ReorderReport
+{
+    VertexOrdering ordering = VertexOrdering::None;
+    uint64_t bandwidth_before = 0;
+    uint64_t bandwidth_after = 0;
+    double log_gap_before = 0;
+    double log_gap_after = 0;
+};
+
+/**
+ * @brief correspondance entre les sommets internes d'un graph et leurs indices (à partir de 0) dans les fichiers
+ *
+ * Une valeur par défaut est l'identité (graph dans l'ordre des CSV) ; reorder_vertices renvoie celle du graph
+ * renuméroté, gardée à côté de lui. Lectures (couples, requêtes, lots de modifications, export existant) et
+ * écritures (lignes d'export, console, degrés, matrice de prédécesseurs, étiquettes de l'interface) la reçoivent
+ * en paramètre, de sorte que les fichiers et l'affichage restent dans la numérotation des CSV.
+ */
+class VertexNumbering
+{
+public:
+    /**
+     * @brief indice dans les fichiers d'un sommet interne
+     */
+    Vertex external(Vertex v) const { return to_external.empty() ? v : to_external[v]; }
+
+    /**
+     * @brief sommet interne d'un indice des fichiers
+     */
+    Vertex internal(Vertex v) const { return to_internal.empty() ? v : to_internal[v]; }
+
+    /**
+     * @brief vrai si les sommets internes ne sont pas dans l'ordre des fichiers
+     */
+    bool renumbered() const { return !to_external.empty(); }
+
+    /**
+     * @brief couples "départ;arrivée" des fichiers (à partir de 1) traduits en sommets internes
+     *
+     * Les couples invalides pour n sommets sont recopiés tels quels, pour être signalés avec leurs valeurs d'origine.
+     *
+     * @param pairs
+     * @param n
+     * @return std::vector<std::pair<double, double>>
+     */
+    std::vector<std::pair<double, double>> internal_pairs(const std::vector<std::pair<double, double>> &pairs, size_t n) const;
+
+    /**
+     * @brief numérotation du graph dont le sommet interne i est l'ancien sommet interne order[i]
+     *
+     * @param order permutation des sommets internes actuels
+     * @return VertexNumbering composée avec celle-ci, toujours rapportée aux fichiers
+     */
+    VertexNumbering permuted(const std::vector<uint32_t> &order) const;
+
+private:
+    // Vides pour l'identité
+    std::vector<uint32_t> to_external;
+    std::vector<uint32_t> to_internal;
+};
+
+/**
+ * @brief renumérotation du graph et des coordonnées
+ *
+ * Les sommets sont désignés partout en interne par leur nouveau numéro ; la numérotation renvoyée relie ces
+ * numéros aux identifiants des fichiers, en composant avec celle que le graph avait déjà (un graph renuméroté
+ * deux fois reste rapporté aux CSV). Les distances ne changent pas ; entre plusieurs plus courts chemins de même
+ * longueur, celui retenu dépend de l'ordre des sommets et peut changer.
+ *
+ * @param g graph symétrique, remplacé par le graph renuméroté
+ * @param coord_list coordonnées, permutées de la même façon
+ * @param ordering
+ * @param numbering numérotation actuelle de g
+ * @param report localité avant et après
+ * @return VertexNumbering numérotation du graph renuméroté
+ */
+VertexNumbering reorder_vertices(CSRGraph &g, CoordinateStore &coord_list, VertexOrdering ordering, const VertexNumbering &numbering, ReorderReport &report);
+VertexNumbering reorder_vertices(CompactGraph &g, CoordinateStore &coord_list, VertexOrdering ordering, const VertexNumbering &numbering, ReorderReport &report);
+
+/**
+ * @brief affichage du gain de localité
+ *
+ * @param out
+ * @param report
+ */
+void print_reorder_report(std::ostream &out, const ReorderReport &report);
+
+#endif // VERTEX_ORDER_H
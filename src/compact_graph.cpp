@@ -0,0 +1,146 @@
+#include <iostream>
+#include <algorithm>
+#include "compact_graph.h"
+#include "instrumentation.h"
+
+using namespace std;
+
+void CompactGraph::allocate(size_t num_vertices, size_t num_edges)
+{
+    first_edge.assign(num_vertices + 1, 0);
+    first_reverse.assign(num_vertices + 1, 0);
+    reverse_edges.resize(num_edges);
+    edge_records.resize(num_edges);
+    forward_arcs.assign((2 * num_edges + 63) / 64, 0);
+}
+
+/**
+ * @brief décalages à partir des effectifs rangés en count[v + 1]
+ */
+static void prefix_sums(vector<uint32_t> &count)
+{
+    for (size_t v = 1; v < count.size(); ++v) {
+        count[v] += count[v - 1];
+    }
+}
+
+CompactGraph build_compact(size_t num_vertices, const vector<pair<int, int>> &edge_list, const vector<float> &weights)
+{
+    ScopedTimer timer(Phase::Build);
+    CompactGraph g;
+    g.allocate(num_vertices, edge_list.size());
+
+    for (const auto &[a, b] : edge_list) {
+        g.first_edge[min(a, b) + 1]++;
+        g.first_reverse[max(a, b) + 1]++;
+    }
+    prefix_sums(g.first_edge);
+    prefix_sums(g.first_reverse);
+
+    // Arcs placés comme par build_csr : un par extrémité, dans l'ordre de la liste d'arêtes. Le prochain arc de u
+    // est le numéro edge_cursor[u] + reverse_cursor[u] (arêtes et entrées inverses de u déjà placées)
+    vector<uint32_t> edge_cursor(g.first_edge.begin(), g.first_edge.end() - 1);
+    vector<uint32_t> reverse_cursor(g.first_reverse.begin(), g.first_reverse.end() - 1);
+    for (size_t i = 0; i < edge_list.size(); ++i) {
+        uint32_t lo = static_cast<uint32_t>(min(edge_list[i].first, edge_list[i].second));
+        uint32_t hi = static_cast<uint32_t>(max(edge_list[i].first, edge_list[i].second));
+        uint64_t arc = uint64_t(edge_cursor[lo]) + reverse_cursor[lo];
+        g.forward_arcs[arc >> 6] |= uint64_t(1) << (arc & 63);
+        uint32_t e = edge_cursor[lo]++;
+        // Boucle : second arc juste après le premier, lu dans l'index inverse
+        g.reverse_edges[reverse_cursor[hi]++] = e;
+        g.edge_records[e] = {lo ^ hi, weights[i]};
+    }
+    return g;
+}
+
+bool build_compact(size_t num_vertices, const uint64_t *offsets, const uint32_t *targets, const float *weights, CompactGraph &g)
+{
+    // Temps compté par l'appelant (lecture du cache, renumérotation)
+    uint64_t num_arcs = offsets[num_vertices];
+    if (num_vertices >= UINT32_MAX || num_arcs / 2 > UINT32_MAX) {
+        cerr << "Graph trop grand pour la représentation compacte (" << num_vertices << " sommets, " << num_arcs << " arcs)" << endl;
+        return false;
+    }
+
+    CompactGraph result;
+    result.allocate(num_vertices, num_arcs / 2);
+
+    // Arc u -> v lu dans les arêtes de u si u < v ; arcs d'une boucle par paires, le premier de chaque paire lu
+    // dans les arêtes de u et le second dans l'index inverse
+    auto for_each_arc = [&](uint32_t u, auto &&f) {
+        uint64_t loops = 0;
+        for (uint64_t k = offsets[u]; k < offsets[u + 1]; ++k) {
+            uint32_t v = targets[k];
+            f(k, v, v > u || (v == u && loops++ % 2 == 0));
+        }
+    };
+
+    for (uint32_t u = 0; u < num_vertices; ++u) {
+        for_each_arc(u, [&](uint64_t, uint32_t, bool forward) {
+            (forward ? result.first_edge : result.first_reverse)[u + 1]++;
+        });
+    }
+    prefix_sums(result.first_edge);
+    prefix_sums(result.first_reverse);
+    if (result.first_edge.back() != result.first_reverse.back()) {
+        cerr << "Arcs non symétriques : représentation compacte impossible" << endl;
+        return false;
+    }
+
+    uint32_t e = 0;
+    for (uint32_t u = 0; u < num_vertices; ++u) {
+        for_each_arc(u, [&](uint64_t k, uint32_t v, bool forward) {
+            if (forward) {
+                result.forward_arcs[k >> 6] |= uint64_t(1) << (k & 63);
+                result.edge_records[e++] = {u ^ v, weights[k]};
+            }
+        });
+    }
+
+    // Arêtes de chaque extrémité basse triées par cible (ordre des arcs conservé entre arêtes parallèles), pour
+    // associer à chaque arc inverse v -> u l'arête de u de même rang parmi celles qui mènent à v
+    vector<uint32_t> by_target(result.edge_records.size());
+    for (uint32_t u = 0; u < num_vertices; ++u) {
+        auto first = by_target.begin() + result.first_edge[u], last = by_target.begin() + result.first_edge[u + 1];
+        uint32_t id = result.first_edge[u];
+        for (auto it = first; it != last; ++it) {
+            *it = id++;
+        }
+        stable_sort(first, last, [&](uint32_t a, uint32_t b) { return (result.edge_records[a].ends ^ u) < (result.edge_records[b].ends ^ u); });
+    }
+
+    vector<pair<uint32_t, uint64_t>> reverse_arcs;
+    vector<size_t> rows;
+    for (uint32_t v = 0; v < num_vertices; ++v) {
+        reverse_arcs.clear();
+        for_each_arc(v, [&](uint64_t k, uint32_t u, bool forward) {
+            if (!forward) {
+                reverse_arcs.emplace_back(u, k);
+            }
+        });
+
+        // Arcs inverses regroupés par extrémité basse, dans leur ordre d'origine au sein d'un groupe
+        rows.resize(reverse_arcs.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            rows[i] = i;
+        }
+        stable_sort(rows.begin(), rows.end(), [&](size_t a, size_t b) { return reverse_arcs[a].first < reverse_arcs[b].first; });
+        for (size_t i = 0; i < rows.size();) {
+            uint32_t u = reverse_arcs[rows[i]].first;
+            auto first = by_target.begin() + result.first_edge[u], last = by_target.begin() + result.first_edge[u + 1];
+            auto it = lower_bound(first, last, v, [&](uint32_t id, uint32_t target) { return (result.edge_records[id].ends ^ u) < target; });
+            for (; i < rows.size() && reverse_arcs[rows[i]].first == u; ++i, ++it) {
+                uint64_t k = reverse_arcs[rows[i]].second;
+                if (it == last || (result.edge_records[*it].ends ^ u) != v || result.edge_records[*it].weight != weights[k]) {
+                    cerr << "Arcs non symétriques entre " << u + 1 << " et " << v + 1 << " : représentation compacte impossible" << endl;
+                    return false;
+                }
+                result.reverse_edges[result.first_reverse[v] + rows[i]] = *it;
+            }
+        }
+    }
+
+    g = std::move(result);
+    return true;
+}
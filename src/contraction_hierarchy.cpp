@@ -0,0 +1,580 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <queue>
+#include <functional>
+#include <cstring>
+#include <filesystem>
+#include "contraction_hierarchy.h"
+#include "csv_loader.h"
+#include "ordered_writer.h"
+#include "instrumentation.h"
+
+using namespace std;
+using namespace boost;
+
+namespace {
+
+const char CH_MAGIC[8] = {'G', 'R', 'A', 'P', 'H', 'C', 'H', '1'};
+const double INF = numeric_limits<double>::max();
+
+// Limite du nombre de sommets fixés par recherche de chemin témoin : au-delà, un raccourci est ajouté par prudence
+const size_t WITNESS_SETTLE_LIMIT = 500;
+
+struct CHArc
+{
+    uint32_t to;
+    double weight;
+    uint32_t middle;
+};
+
+/**
+ * @brief état de la contraction : graph de travail restreint aux sommets non encore contractés
+ */
+class Contractor
+{
+public:
+    template <typename G>
+    explicit Contractor(const G &g)
+        : adj(num_vertices(g)), deleted_neighbors(num_vertices(g), 0),
+          witness_dist(num_vertices(g), INF)
+    {
+        auto weight = get(edge_weight, g);
+        for (uint32_t u = 0; u < num_vertices(g); ++u) {
+            for (auto [ei, ei_end] = out_edges(u, g); ei != ei_end; ++ei) {
+                uint32_t v = target(*ei, g);
+                if (v != u) {
+                    adj[u].push_back({v, static_cast<double>(get(weight, *ei)), ContractionHierarchy::NO_MIDDLE});
+                }
+            }
+            // Arêtes parallèles : seule la plus légère est conservée
+            sort(adj[u].begin(), adj[u].end(), [](const CHArc &a, const CHArc &b) {
+                return a.to != b.to ? a.to < b.to : a.weight < b.weight;
+            });
+            adj[u].erase(unique(adj[u].begin(), adj[u].end(), [](const CHArc &a, const CHArc &b) { return a.to == b.to; }),
+                         adj[u].end());
+        }
+    }
+
+    /**
+     * @brief contraction (ou simulation) du sommet v
+     *
+     * @return nombre de raccourcis nécessaires
+     */
+    size_t contract(uint32_t v, bool simulate)
+    {
+        vector<CHArc> neighbors = adj[v];
+        size_t shortcuts = 0;
+
+        for (size_t i = 0; i < neighbors.size(); ++i) {
+            if (i + 1 >= neighbors.size()) {
+                continue;
+            }
+            const CHArc &in = neighbors[i];
+            double limit = 0;
+            for (size_t j = i + 1; j < neighbors.size(); ++j) {
+                limit = max(limit, in.weight + neighbors[j].weight);
+            }
+
+            witness_search(in.to, v, limit);
+
+            for (size_t j = i + 1; j < neighbors.size(); ++j) {
+                const CHArc &out = neighbors[j];
+                double via = in.weight + out.weight;
+                if (witness_dist[out.to] <= via) {
+                    continue;
+                }
+                shortcuts++;
+                if (!simulate) {
+                    add_shortcut(in.to, out.to, via, v);
+                }
+            }
+        }
+
+        if (!simulate) {
+            for (const CHArc &arc : adj[v]) {
+                auto &list = adj[arc.to];
+                list.erase(remove_if(list.begin(), list.end(), [v](const CHArc &a) { return a.to == v; }), list.end());
+                deleted_neighbors[arc.to]++;
+            }
+        }
+        return shortcuts;
+    }
+
+    long long priority(uint32_t v)
+    {
+        long long shortcuts = static_cast<long long>(contract(v, true));
+        return shortcuts - static_cast<long long>(adj[v].size()) + deleted_neighbors[v];
+    }
+
+    vector<vector<CHArc>> adj;
+    vector<uint32_t> deleted_neighbors;
+
+private:
+    // Dijkstra limité depuis source, sans passer par excluded
+    void witness_search(uint32_t source, uint32_t excluded, double limit)
+    {
+        for (uint32_t t : touched) {
+            witness_dist[t] = INF;
+        }
+        touched.clear();
+        heap.clear();
+
+        greater<pair<double, uint32_t>> cmp;
+        witness_dist[source] = 0;
+        touched.push_back(source);
+        heap.emplace_back(0.0, source);
+        size_t settled = 0;
+
+        while (!heap.empty() && settled < WITNESS_SETTLE_LIMIT) {
+            pop_heap(heap.begin(), heap.end(), cmp);
+            auto [d, u] = heap.back();
+            heap.pop_back();
+            if (d > witness_dist[u]) {
+                continue;
+            }
+            if (d > limit) {
+                break;
+            }
+            settled++;
+            for (const CHArc &arc : adj[u]) {
+                if (arc.to == excluded) {
+                    continue;
+                }
+                double nd = d + arc.weight;
+                if (nd < witness_dist[arc.to]) {
+                    if (witness_dist[arc.to] == INF) {
+                        touched.push_back(arc.to);
+                    }
+                    witness_dist[arc.to] = nd;
+                    heap.emplace_back(nd, arc.to);
+                    push_heap(heap.begin(), heap.end(), cmp);
+                }
+            }
+        }
+    }
+
+    void add_shortcut(uint32_t u, uint32_t w, double weight, uint32_t middle)
+    {
+        auto update = [&](uint32_t from, uint32_t to) {
+            for (CHArc &arc : adj[from]) {
+                if (arc.to == to) {
+                    if (weight < arc.weight) {
+                        arc.weight = weight;
+                        arc.middle = middle;
+                    }
+                    return;
+                }
+            }
+            adj[from].push_back({to, weight, middle});
+        };
+        update(u, w);
+        update(w, u);
+    }
+
+    vector<double> witness_dist;
+    vector<uint32_t> touched;
+    vector<pair<double, uint32_t>> heap;
+};
+
+template <typename T>
+void write_vector(ofstream &file, const vector<T> &data)
+{
+    uint64_t size = data.size();
+    file.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    file.write(reinterpret_cast<const char *>(data.data()), data.size() * sizeof(T));
+}
+
+template <typename T>
+bool read_vector(const char *&p, const char *end, vector<T> &data)
+{
+    uint64_t size;
+    if (static_cast<size_t>(end - p) < sizeof(size)) return false;
+    memcpy(&size, p, sizeof(size));
+    p += sizeof(size);
+    if (size > static_cast<uint64_t>(end - p) / sizeof(T)) return false;
+    data.resize(size);
+    memcpy(data.data(), p, size * sizeof(T));
+    p += size * sizeof(T);
+    return true;
+}
+
+} // namespace
+
+template <typename G>
+ContractionHierarchy ContractionHierarchy::build_impl(const G &g)
+{
+    // La fonction membre num_vertices masque la fonction libre : déclaration explicite (Boost et graph compact)
+    using boost::num_vertices;
+    size_t n = num_vertices(g);
+    Contractor contractor(g);
+    ContractionHierarchy ch;
+    ch.rank.assign(n, 0);
+    vector<vector<CHArc>> up(n);
+
+    // File de priorité paresseuse : la priorité est recalculée au retrait, le sommet est remis en file si elle a augmenté
+    using Entry = pair<long long, uint32_t>;
+    priority_queue<Entry, vector<Entry>, greater<Entry>> queue;
+    for (uint32_t v = 0; v < n; ++v) {
+        queue.emplace(contractor.priority(v), v);
+    }
+
+    uint32_t order = 0;
+    while (!queue.empty()) {
+        auto [p, v] = queue.top();
+        queue.pop();
+        long long current = contractor.priority(v);
+        if (!queue.empty() && current > queue.top().first) {
+            queue.emplace(current, v);
+            continue;
+        }
+
+        // Les voisins restants ont tous un rang supérieur : ce sont les arcs montants de v
+        up[v] = contractor.adj[v];
+        contractor.contract(v, false);
+        contractor.adj[v].clear();
+        contractor.adj[v].shrink_to_fit();
+        ch.rank[v] = order++;
+    }
+
+    ch.up_offsets.assign(n + 1, 0);
+    for (size_t v = 0; v < n; ++v) {
+        ch.up_offsets[v + 1] = ch.up_offsets[v] + up[v].size();
+    }
+    ch.up_targets.reserve(ch.up_offsets[n]);
+    ch.up_weights.reserve(ch.up_offsets[n]);
+    ch.up_middle.reserve(ch.up_offsets[n]);
+    for (size_t v = 0; v < n; ++v) {
+        for (const CHArc &arc : up[v]) {
+            ch.up_targets.push_back(arc.to);
+            ch.up_weights.push_back(arc.weight);
+            ch.up_middle.push_back(arc.middle);
+        }
+    }
+    return ch;
+}
+
+ContractionHierarchy ContractionHierarchy::build(const CSRGraph &g)
+{
+    return build_impl(g);
+}
+
+ContractionHierarchy ContractionHierarchy::build(const CompactGraph &g)
+{
+    return build_impl(g);
+}
+
+size_t ContractionHierarchy::num_shortcuts() const
+{
+    return count_if(up_middle.begin(), up_middle.end(), [](uint32_t m) { return m != NO_MIDDLE; });
+}
+
+size_t ContractionHierarchy::memory_used() const
+{
+    return rank.capacity() * sizeof(uint32_t) + up_offsets.capacity() * sizeof(uint64_t) + up_targets.capacity() * sizeof(uint32_t)
+           + up_weights.capacity() * sizeof(double) + up_middle.capacity() * sizeof(uint32_t);
+}
+
+bool ContractionHierarchy::save(const string &filename, const GraphCacheKey &key) const
+{
+    string tmp_filename = filename + ".tmp";
+    ofstream file(tmp_filename, ios::out | ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        cerr << "Impossible d'écrire la hiérarchie '" << filename << "'" << endl;
+        return false;
+    }
+
+    file.write(CH_MAGIC, sizeof(CH_MAGIC));
+    file.write(reinterpret_cast<const char *>(&CONTRACTION_HIERARCHY_VERSION), sizeof(CONTRACTION_HIERARCHY_VERSION));
+    file.write(reinterpret_cast<const char *>(&key.nodes_size), sizeof(key.nodes_size));
+    file.write(reinterpret_cast<const char *>(&key.nodes_mtime), sizeof(key.nodes_mtime));
+    file.write(reinterpret_cast<const char *>(&key.edges_size), sizeof(key.edges_size));
+    file.write(reinterpret_cast<const char *>(&key.edges_mtime), sizeof(key.edges_mtime));
+    file.write(reinterpret_cast<const char *>(&key.ordering), sizeof(key.ordering));
+    file.write(reinterpret_cast<const char *>(&key.weight_precision), sizeof(key.weight_precision));
+    write_vector(file, rank);
+    write_vector(file, up_offsets);
+    write_vector(file, up_targets);
+    write_vector(file, up_weights);
+    write_vector(file, up_middle);
+    file.close();
+
+    error_code ec;
+    if (!file || (filesystem::rename(tmp_filename, filename, ec), ec)) {
+        cerr << "Impossible d'écrire la hiérarchie '" << filename << "'" << endl;
+        filesystem::remove(tmp_filename, ec);
+        return false;
+    }
+    return true;
+}
+
+bool ContractionHierarchy::load(const string &filename, const GraphCacheKey &key)
+{
+    if (!key.valid) {
+        return false;
+    }
+    MappedFile file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    const char *p = file.data();
+    const char *end = p + file.size();
+    GraphCacheKey stored;
+    uint32_t version;
+    size_t header_size = sizeof(CH_MAGIC) + sizeof(version) + 4 * sizeof(uint64_t) + 2 * sizeof(uint32_t);
+    if (file.size() < header_size || memcmp(p, CH_MAGIC, sizeof(CH_MAGIC)) != 0) {
+        return false;
+    }
+    p += sizeof(CH_MAGIC);
+    memcpy(&version, p, sizeof(version));
+    p += sizeof(version);
+    memcpy(&stored.nodes_size, p, sizeof(uint64_t));
+    memcpy(&stored.nodes_mtime, p + 8, sizeof(int64_t));
+    memcpy(&stored.edges_size, p + 16, sizeof(uint64_t));
+    memcpy(&stored.edges_mtime, p + 24, sizeof(int64_t));
+    memcpy(&stored.ordering, p + 32, sizeof(uint32_t));
+    memcpy(&stored.weight_precision, p + 36, sizeof(uint32_t));
+    p += 40;
+
+    if (version != CONTRACTION_HIERARCHY_VERSION || !(stored == key)) {
+        cout << "Hiérarchie de contraction '" << filename << "' périmée, nouveau prétraitement" << endl;
+        return false;
+    }
+
+    if (!read_vector(p, end, rank) || !read_vector(p, end, up_offsets) || !read_vector(p, end, up_targets) ||
+        !read_vector(p, end, up_weights) || !read_vector(p, end, up_middle) ||
+        up_offsets.size() != rank.size() + 1 || up_offsets.back() != up_targets.size() ||
+        up_weights.size() != up_targets.size() || up_middle.size() != up_targets.size()) {
+        cerr << "Hiérarchie de contraction '" << filename << "' corrompue, nouveau prétraitement" << endl;
+        *this = ContractionHierarchy();
+        return false;
+    }
+    return true;
+}
+
+void ContractionHierarchy::prepare(CHQueryScratch::Side &side) const
+{
+    if (side.distances.size() != rank.size()) {
+        side.distances.assign(rank.size(), INF);
+        side.parent_arc.assign(rank.size(), UINT64_MAX);
+        side.touched.clear();
+    }
+    for (uint32_t v : side.touched) {
+        side.distances[v] = INF;
+        side.parent_arc[v] = UINT64_MAX;
+    }
+    side.touched.clear();
+    side.heap.clear();
+}
+
+uint64_t ContractionHierarchy::find_arc(uint32_t lower, uint32_t upper) const
+{
+    uint64_t best = UINT64_MAX;
+    for (uint64_t a = up_offsets[lower]; a < up_offsets[lower + 1]; ++a) {
+        if (up_targets[a] == upper && (best == UINT64_MAX || up_weights[a] < up_weights[best])) {
+            best = a;
+        }
+    }
+    return best;
+}
+
+void ContractionHierarchy::unpack(uint32_t from, uint32_t to, uint32_t middle, double weight, vector<Vertex> &path, double &length, vector<uint32_t> &stack) const
+{
+    // Pile de segments (départ, arrivée, intermédiaire) ; les arêtes d'origine sont émises dans l'ordre du chemin
+    stack.clear();
+    stack.insert(stack.end(), {from, to, middle});
+    vector<double> weights{weight};
+
+    while (!stack.empty()) {
+        uint32_t m = stack.back(); stack.pop_back();
+        uint32_t b = stack.back(); stack.pop_back();
+        uint32_t a = stack.back(); stack.pop_back();
+        double w = weights.back(); weights.pop_back();
+
+        if (m == NO_MIDDLE) {
+            path.push_back(b);
+            length += w;
+            continue;
+        }
+
+        // Le sommet intermédiaire a été contracté avant a et b : les deux moitiés sont des arcs montants de m
+        uint64_t second = find_arc(m, b);
+        uint64_t first = find_arc(m, a);
+        stack.insert(stack.end(), {m, b, up_middle[second]});
+        weights.push_back(up_weights[second]);
+        stack.insert(stack.end(), {a, m, up_middle[first]});
+        weights.push_back(up_weights[first]);
+    }
+}
+
+PathResult ContractionHierarchy::query(Vertex start, Vertex goal, CHQueryScratch &scratch) const
+{
+    ScopedTimer timer(Phase::Search);
+    PathResult result;
+    result.length = INF;
+    auto &fwd = scratch.forward;
+    auto &bwd = scratch.backward;
+    prepare(fwd);
+    prepare(bwd);
+    greater<pair<double, uint32_t>> cmp;
+
+    fwd.distances[start] = 0;
+    fwd.touched.push_back(start);
+    fwd.heap.emplace_back(0.0, start);
+    bwd.distances[goal] = 0;
+    bwd.touched.push_back(goal);
+    bwd.heap.emplace_back(0.0, goal);
+    SearchCounters counters;
+    counters.pushes = 2;
+
+    double best = INF;
+    uint32_t meeting = UINT32_MAX;
+
+    // Recherches montantes alternées ; un sens s'arrête quand son minimum de file atteint la meilleure longueur
+    bool forward = true;
+    while (true) {
+        bool fwd_active = !fwd.heap.empty() && fwd.heap.front().first < best;
+        bool bwd_active = !bwd.heap.empty() && bwd.heap.front().first < best;
+        if (!fwd_active && !bwd_active) {
+            break;
+        }
+        if ((forward && !fwd_active) || (!forward && !bwd_active)) {
+            forward = !forward;
+        }
+
+        auto &side = forward ? fwd : bwd;
+        const auto &other = forward ? bwd : fwd;
+        forward = !forward;
+
+        pop_heap(side.heap.begin(), side.heap.end(), cmp);
+        auto [d, u] = side.heap.back();
+        side.heap.pop_back();
+        counters.pops++;
+        if (d > side.distances[u]) {
+            continue;
+        }
+        result.settled++;
+
+        if (other.distances[u] != INF && d + other.distances[u] < best) {
+            best = d + other.distances[u];
+            meeting = u;
+        }
+
+        for (uint64_t a = up_offsets[u]; a < up_offsets[u + 1]; ++a) {
+            uint32_t v = up_targets[a];
+            double nd = d + up_weights[a];
+            counters.relaxations++;
+            if (nd < side.distances[v]) {
+                if (side.distances[v] == INF) {
+                    side.touched.push_back(v);
+                }
+                side.distances[v] = nd;
+                side.parent_arc[v] = a;
+                side.heap.emplace_back(nd, v);
+                push_heap(side.heap.begin(), side.heap.end(), cmp);
+                counters.pushes++;
+            }
+        }
+    }
+
+    counters.settled = result.settled;
+    record_search(counters);
+
+    if (meeting == UINT32_MAX) {
+        return result;
+    }
+
+    // Arcs du chemin montant start -> meeting, puis de meeting -> goal (arcs de la recherche arrière parcourus à l'envers)
+    vector<pair<uint32_t, uint64_t>> up_path;
+    for (uint32_t v = meeting; v != start; ) {
+        uint64_t a = fwd.parent_arc[v];
+        uint32_t u = static_cast<uint32_t>(upper_bound(up_offsets.begin(), up_offsets.end(), a) - up_offsets.begin() - 1);
+        up_path.emplace_back(u, a);
+        v = u;
+    }
+    reverse(up_path.begin(), up_path.end());
+
+    double length = 0;
+    result.path.push_back(start);
+    for (auto [u, a] : up_path) {
+        unpack(u, up_targets[a], up_middle[a], up_weights[a], result.path, length, scratch.unpack_stack);
+    }
+    for (uint32_t v = meeting; v != goal; ) {
+        uint64_t a = bwd.parent_arc[v];
+        uint32_t u = static_cast<uint32_t>(upper_bound(up_offsets.begin(), up_offsets.end(), a) - up_offsets.begin() - 1);
+        unpack(v, u, up_middle[a], up_weights[a], result.path, length, scratch.unpack_stack);
+        v = u;
+    }
+
+    result.found = true;
+    result.length = length;
+    return result;
+}
+
+template <typename G>
+static void load_or_build_impl(const G &g, const string &filename, const GraphCacheKey &key, ContractionHierarchy &ch)
+{
+    if (ch.load(filename, key) && ch.num_vertices() == num_vertices(g)) {
+        cout << "Hiérarchie de contraction chargée depuis '" << filename << "'" << endl;
+        return;
+    }
+
+    cout << "Prétraitement de la hiérarchie de contraction..." << endl;
+    {
+        ScopedTimer timer(Phase::Preprocess);
+        ch = ContractionHierarchy::build(g);
+    }
+    cout << "Hiérarchie de contraction : " << ch.num_arcs() << " arcs montants dont " << ch.num_shortcuts() << " raccourcis" << endl;
+    ch.save(filename, key);
+}
+
+void load_or_build_contraction_hierarchy(const CSRGraph &g, const string &filename, const GraphCacheKey &key, ContractionHierarchy &ch)
+{
+    load_or_build_impl(g, filename, key, ch);
+}
+
+void load_or_build_contraction_hierarchy(const CompactGraph &g, const string &filename, const GraphCacheKey &key, ContractionHierarchy &ch)
+{
+    load_or_build_impl(g, filename, key, ch);
+}
+
+void CSVOuptutFunction(const ContractionHierarchy &ch, const vector<pair<double, double>> &list_Node, const VertexNumbering &numbering,
+                       const string &filename, unsigned num_threads)
+{
+    ofstream file(filename, ios::out | ios::trunc);
+
+    if (!file.is_open()) {
+        cerr << "Impossible d'ouvrir le fichier de sortie" << endl;
+        return;
+    }
+
+    file << "Start;End;Path Length;Path\n";
+    size_t n = ch.num_vertices();
+
+    // Requêtes indépendantes : découpage de list_Node en tranches de lignes consécutives
+    const size_t CHUNK_ROWS = 4096;
+    size_t num_chunks = (list_Node.size() + CHUNK_ROWS - 1) / CHUNK_ROWS;
+    num_threads = resolve_num_threads(num_threads, num_chunks);
+
+    struct QueryWorker
+    {
+        CHQueryScratch scratch;
+    };
+
+    write_chunks_in_order<QueryWorker>(file, num_chunks, num_threads, [&](QueryWorker &w, size_t c, string &text) {
+        size_t last = min(list_Node.size(), (c + 1) * CHUNK_ROWS);
+        for (size_t r = c * CHUNK_ROWS; r < last; ++r) {
+            const auto &[start, goal] = list_Node[r];
+            if (!valid_pair(start, goal, n)) {
+                cerr << "Erreur : Indices de sommet invalides (" << start << ", " << goal << ")" << endl;
+                continue;
+            }
+            PathResult result = ch.query(static_cast<Vertex>(start - 1), static_cast<Vertex>(goal - 1), w.scratch);
+            write_path_row(text, start, goal, result.found, result.length, result.path, numbering);
+        }
+    });
+
+    file.close();
+    cout << "Fichier CSV '" << filename << "' généré avec succès." << endl;
+}
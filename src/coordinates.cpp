@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <thread>
+#include "coordinates.h"
+#include "ordered_writer.h"
+
+#ifdef __AVX2__
+    #include <immintrin.h>
+#endif
+
+using namespace std;
+
+// Arêtes par thread en dessous desquelles le calcul reste sur un seul thread
+static const size_t MIN_EDGES_PER_THREAD = size_t(1) << 16;
+
+void CoordinateStore::permute(const vector<uint32_t> &order)
+{
+    for (Array *axis : {&xs, &ys, &zs}) {
+        Array permuted(order.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            permuted[i] = (*axis)[order[i]];
+        }
+        axis->swap(permuted);
+    }
+}
+
+const char *weight_precision_name(WeightPrecision precision)
+{
+    switch (precision) {
+        case WeightPrecision::Double: return "double";
+        case WeightPrecision::Float: return "float";
+    }
+    return "unknown";
+}
+
+bool parse_weight_precision(const string &name, WeightPrecision &precision)
+{
+    for (WeightPrecision p : {WeightPrecision::Double, WeightPrecision::Float}) {
+        if (name == weight_precision_name(p)) {
+            precision = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief poids des arêtes [begin, end) un par un
+ */
+static void edge_weights_scalar(const CoordinateStore &coords, const pair<int, int> *edges, float *weights, size_t begin, size_t end, WeightPrecision precision)
+{
+    const double *xs = coords.x_data(), *ys = coords.y_data(), *zs = coords.z_data();
+    for (size_t e = begin; e < end; ++e) {
+        auto [a, b] = edges[e];
+        if (precision == WeightPrecision::Float) {
+            // Différences en double : pas d'annulation catastrophique pour des coordonnées éloignées de l'origine
+            float dx = static_cast<float>(xs[a] - xs[b]), dy = static_cast<float>(ys[a] - ys[b]), dz = static_cast<float>(zs[a] - zs[b]);
+            weights[e] = sqrt(dx * dx + dy * dy + dz * dz);
+        } else {
+            double dx = xs[a] - xs[b], dy = ys[a] - ys[b], dz = zs[a] - zs[b];
+            weights[e] = static_cast<float>(sqrt(dx * dx + dy * dy + dz * dz));
+        }
+    }
+}
+
+#ifdef __AVX2__
+/**
+ * @brief différences (dx, dy, dz) de quatre arêtes, lues dans les coordonnées regroupées par sommet
+ * (x, y, z, 0 sur 32 octets alignés : une seule ligne de cache par extrémité) puis transposées par axe
+ */
+static inline void edge_differences(const double *packed, const pair<int, int> *edges, __m256d &dx, __m256d &dy, __m256d &dz)
+{
+    __m256d d[4];
+    for (int i = 0; i < 4; ++i) {
+        d[i] = _mm256_sub_pd(_mm256_load_pd(packed + 4 * static_cast<size_t>(edges[i].first)),
+                             _mm256_load_pd(packed + 4 * static_cast<size_t>(edges[i].second)));
+    }
+    __m256d xy01 = _mm256_unpacklo_pd(d[0], d[1]); // x0 x1 z0 z1
+    __m256d yw01 = _mm256_unpackhi_pd(d[0], d[1]); // y0 y1 0 0
+    __m256d xy23 = _mm256_unpacklo_pd(d[2], d[3]); // x2 x3 z2 z3
+    __m256d yw23 = _mm256_unpackhi_pd(d[2], d[3]); // y2 y3 0 0
+    dx = _mm256_permute2f128_pd(xy01, xy23, 0x20);
+    dy = _mm256_permute2f128_pd(yw01, yw23, 0x20);
+    dz = _mm256_permute2f128_pd(xy01, xy23, 0x31);
+}
+
+/**
+ * @brief poids des arêtes [begin, end) : mêmes opérations, dans le même ordre, que la boucle scalaire
+ * (multiplications et additions séparées, sans FMA), donc mêmes valeurs
+ */
+static void edge_weights_avx2(const CoordinateStore &coords, const double *packed, const pair<int, int> *edges, float *weights,
+                              size_t begin, size_t end, WeightPrecision precision)
+{
+    size_t e = begin;
+    if (precision == WeightPrecision::Float) {
+        auto narrow = [](__m256d low, __m256d high) {
+            return _mm256_set_m128(_mm256_cvtpd_ps(high), _mm256_cvtpd_ps(low));
+        };
+        for (; e + 8 <= end; e += 8) {
+            __m256d dx0, dy0, dz0, dx1, dy1, dz1;
+            edge_differences(packed, edges + e, dx0, dy0, dz0);
+            edge_differences(packed, edges + e + 4, dx1, dy1, dz1);
+            __m256 dx = narrow(dx0, dx1), dy = narrow(dy0, dy1), dz = narrow(dz0, dz1);
+            __m256 sum = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+            _mm256_storeu_ps(weights + e, _mm256_sqrt_ps(sum));
+        }
+    } else {
+        for (; e + 4 <= end; e += 4) {
+            __m256d dx, dy, dz;
+            edge_differences(packed, edges + e, dx, dy, dz);
+            __m256d sum = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz));
+            _mm_storeu_ps(weights + e, _mm256_cvtpd_ps(_mm256_sqrt_pd(sum)));
+        }
+    }
+    edge_weights_scalar(coords, edges, weights, e, end, precision);
+}
+#endif
+
+void compute_edge_weights(const CoordinateStore &coord_list, const vector<pair<int, int>> &edge_list,
+                          vector<float> &weights, WeightPrecision precision, unsigned num_threads)
+{
+    static_assert(sizeof(pair<int, int>) == 2 * sizeof(int), "arêtes lues comme des couples d'entiers contigus");
+    size_t m = edge_list.size();
+    weights.resize(m);
+
+#ifdef __AVX2__
+    // Les arêtes visitent les sommets dans un ordre quelconque : les trois axes d'un sommet sont d'abord
+    // regroupés (4 double par sommet, copie temporaire) pour qu'une extrémité ne coûte qu'un accès mémoire
+    size_t n = coord_list.size();
+    CoordinateStore::Array packed(4 * n);
+    for (size_t v = 0; v < n; ++v) {
+        packed[4 * v] = coord_list.x(v);
+        packed[4 * v + 1] = coord_list.y(v);
+        packed[4 * v + 2] = coord_list.z(v);
+        packed[4 * v + 3] = 0;
+    }
+#endif
+    auto run = [&](size_t begin, size_t end) {
+#ifdef __AVX2__
+        edge_weights_avx2(coord_list, packed.data(), edge_list.data(), weights.data(), begin, end, precision);
+#else
+        edge_weights_scalar(coord_list, edge_list.data(), weights.data(), begin, end, precision);
+#endif
+    };
+
+    num_threads = resolve_num_threads(num_threads, m / MIN_EDGES_PER_THREAD);
+    if (num_threads <= 1) {
+        run(0, m);
+        return;
+    }
+    vector<thread> workers;
+    size_t chunk = (m + num_threads - 1) / num_threads;
+    for (unsigned t = 0; t < num_threads; ++t) {
+        size_t begin = min(m, t * chunk), end = min(m, begin + chunk);
+        workers.emplace_back(run, begin, end);
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+}
+
+const char *edge_weight_kernel_name()
+{
+#ifdef __AVX2__
+    return "avx2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,318 @@
+#include <iostream>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <thread>
+#include "csv_loader.h"
+#include "instrumentation.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #undef max
+    #undef min
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace std;
+
+MappedFile::MappedFile(const string &filename)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        return;
+    }
+    file_handle = file;
+    length = static_cast<size_t>(file_size.QuadPart);
+    if (length > 0) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            return;
+        }
+        mapping_handle = mapping;
+        begin = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!begin) {
+            return;
+        }
+    }
+    opened = true;
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return;
+    }
+    length = static_cast<size_t>(st.st_size);
+    if (length > 0) {
+        void *addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            close(fd);
+            length = 0;
+            return;
+        }
+        madvise(addr, length, MADV_SEQUENTIAL);
+        begin = static_cast<const char *>(addr);
+    }
+    close(fd);
+    opened = true;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+    if (begin) UnmapViewOfFile(begin);
+    if (mapping_handle) CloseHandle(mapping_handle);
+    if (file_handle) CloseHandle(file_handle);
+#else
+    if (begin) munmap(const_cast<char *>(begin), length);
+#endif
+}
+
+namespace {
+
+/**
+ * @brief tranche de lignes complètes du fichier, analysée par un seul thread
+ */
+struct LineChunk
+{
+    const char *begin;
+    const char *end;
+    size_t lines = 0;
+    size_t records = 0;
+    size_t first_line = 0;
+    size_t first_record = 0;
+    size_t malformed = 0;
+    vector<CSVError> errors;
+};
+
+const size_t MIN_CHUNK_BYTES = 1 << 20;
+
+bool is_blank(const char *b, const char *e)
+{
+    for (; b != e; ++b) {
+        if (*b != ' ' && *b != '\t' && *b != '\r') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Appel de f(début, fin) pour chaque ligne de [begin, end), fin excluant le '\n'
+template <typename F>
+void for_each_line(const char *begin, const char *end, F &&f)
+{
+    while (begin < end) {
+        const char *nl = static_cast<const char *>(memchr(begin, '\n', end - begin));
+        const char *line_end = nl ? nl : end;
+        f(begin, line_end);
+        begin = nl ? nl + 1 : end;
+    }
+}
+
+/**
+ * @brief lecture d'un champ numérique suivi d'un séparateur ';' (ou de la fin de ligne pour le dernier champ)
+ */
+template <typename T>
+bool parse_field(const char *&p, const char *end, T &value, bool last, string &error)
+{
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    if (p < end && *p == '+') ++p;
+
+    auto [ptr, ec] = from_chars(p, end, value);
+    if (ec != errc() || ptr == p) {
+        error = string("valeur ") + (is_integral<T>::value ? "entière" : "réelle") + " invalide : '" +
+                string(p, find(p, end, ';')) + "'";
+        return false;
+    }
+    p = ptr;
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+
+    if (last) {
+        // Les colonnes supplémentaires éventuelles sont ignorées
+        if (p < end && *p != ';') {
+            error = "caractères inattendus après la dernière valeur";
+            return false;
+        }
+        return true;
+    }
+    if (p >= end || *p != ';') {
+        error = "séparateur ';' attendu";
+        return false;
+    }
+    ++p;
+    return true;
+}
+
+/**
+ * @brief analyse parallèle du corps d'un fichier CSV (en-tête ignoré) vers un tableau pré-dimensionné
+ *
+ * Premier passage : comptage des lignes et des enregistrements de chaque tranche.
+ * Second passage : analyse de chaque ligne directement à son indice final dans records (tableau ou
+ * structure de tableaux, redimensionné une fois), parse_line recevant cet indice.
+ */
+template <typename Records, typename ParseLine>
+CSVLoadResult parse_csv_body(const string &filename, Records &records, unsigned num_threads, ParseLine parse_line)
+{
+    CSVLoadResult result;
+    ScopedTimer timer(Phase::Load);
+    MappedFile file(filename);
+    if (!file.is_open()) {
+        cerr << "Ouverture du fichier impossible : " << filename << endl;
+        return result;
+    }
+    result.opened = true;
+    records.clear();
+
+    const char *begin = file.data();
+    const char *end = begin + file.size();
+
+    // En-tête
+    const char *header_end = begin ? static_cast<const char *>(memchr(begin, '\n', end - begin)) : nullptr;
+    begin = header_end ? header_end + 1 : end;
+
+    if (num_threads == 0) {
+        num_threads = max(1u, thread::hardware_concurrency());
+    }
+    size_t body_size = end - begin;
+    size_t num_chunks = max<size_t>(1, min<size_t>(num_threads, body_size / MIN_CHUNK_BYTES));
+
+    // Découpage en tranches de lignes complètes
+    vector<LineChunk> chunks;
+    const char *chunk_begin = begin;
+    for (size_t k = 1; k <= num_chunks && chunk_begin < end; ++k) {
+        const char *chunk_end = (k == num_chunks) ? end : max(chunk_begin, begin + body_size * k / num_chunks);
+        if (chunk_end < end) {
+            const char *nl = static_cast<const char *>(memchr(chunk_end, '\n', end - chunk_end));
+            chunk_end = nl ? nl + 1 : end;
+        }
+        chunks.push_back(LineChunk{chunk_begin, chunk_end});
+        chunk_begin = chunk_end;
+    }
+
+    auto run_parallel = [&](auto &&task) {
+        if (chunks.size() == 1) {
+            task(chunks[0]);
+            return;
+        }
+        vector<thread> pool;
+        for (auto &chunk : chunks) {
+            pool.emplace_back([&task, &chunk] { task(chunk); });
+        }
+        for (auto &t : pool) {
+            t.join();
+        }
+    };
+
+    run_parallel([](LineChunk &chunk) {
+        for_each_line(chunk.begin, chunk.end, [&](const char *b, const char *e) {
+            chunk.lines++;
+            if (!is_blank(b, e)) chunk.records++;
+        });
+    });
+
+    size_t line = 2, record = 0;
+    for (auto &chunk : chunks) {
+        chunk.first_line = line;
+        chunk.first_record = record;
+        line += chunk.lines;
+        record += chunk.records;
+    }
+    records.resize(record);
+    result.records = record;
+
+    // Pages déjà lues par le comptage : le second passage ne mesure que l'analyse des champs
+    timer.restart(Phase::Parse);
+
+    run_parallel([&](LineChunk &chunk) {
+        size_t line_number = chunk.first_line;
+        size_t out = chunk.first_record;
+        string error;
+        for_each_line(chunk.begin, chunk.end, [&](const char *b, const char *e) {
+            if (!is_blank(b, e)) {
+                if (!parse_line(b, e, out, error)) {
+                    chunk.malformed++;
+                    if (chunk.errors.size() < CSVLoadResult::MAX_REPORTED) {
+                        chunk.errors.push_back({line_number, error});
+                    }
+                }
+                ++out;
+            }
+            ++line_number;
+        });
+    });
+
+    for (auto &chunk : chunks) {
+        result.malformed += chunk.malformed;
+        for (auto &err : chunk.errors) {
+            if (result.errors.size() < CSVLoadResult::MAX_REPORTED) {
+                result.errors.push_back(std::move(err));
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+CSVLoadResult load_nodes_csv(const string &filename, CoordinateStore &coord_list, unsigned num_threads)
+{
+    return parse_csv_body(filename, coord_list, num_threads,
+        [&coord_list](const char *p, const char *end, size_t index, string &error) {
+            int node_id;
+            double x, y, z;
+            if (!parse_field(p, end, node_id, false, error) ||
+                !parse_field(p, end, x, false, error) ||
+                !parse_field(p, end, y, false, error) ||
+                !parse_field(p, end, z, true, error)) {
+                coord_list.set(index, 0.0, 0.0, 0.0);
+                return false;
+            }
+            coord_list.set(index, x, y, z);
+            return true;
+        });
+}
+
+CSVLoadResult load_edges_csv(const string &filename, vector<pair<int, int>> &edge_list, size_t num_vertices, unsigned num_threads)
+{
+    return parse_csv_body(filename, edge_list, num_threads,
+        [&edge_list, num_vertices](const char *p, const char *end, size_t index, string &error) {
+            pair<int, int> &edge = edge_list[index];
+            int node1, node2;
+            edge = {0, 0};
+            if (!parse_field(p, end, node1, false, error) ||
+                !parse_field(p, end, node2, true, error)) {
+                return false;
+            }
+            if (node1 < 1 || node2 < 1 ||
+                (num_vertices > 0 && (static_cast<size_t>(node1) > num_vertices || static_cast<size_t>(node2) > num_vertices))) {
+                error = "identifiant de sommet hors limites (" + to_string(node1) + ", " + to_string(node2) + ")";
+                return false;
+            }
+            edge = {node1 - 1, node2 - 1};
+            return true;
+        });
+}
+
+void report_csv_errors(const string &filename, const CSVLoadResult &result)
+{
+    for (const auto &err : result.errors) {
+        cerr << "Erreur " << filename << " ligne " << err.line << " : " << err.message << endl;
+    }
+    if (result.malformed > result.errors.size()) {
+        cerr << "... " << result.malformed - result.errors.size() << " autres lignes invalides dans " << filename << endl;
+    }
+}
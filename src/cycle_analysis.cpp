@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <limits>
+#include "cycle_analysis.h"
+
+using namespace std;
+using namespace boost;
+
+static const uint32_t NONE = numeric_limits<uint32_t>::max();
+
+UnionFind::UnionFind(size_t n)
+{
+    reset(n);
+}
+
+void UnionFind::reset(size_t n)
+{
+    parent.resize(n);
+    for (size_t v = 0; v < n; ++v) {
+        parent[v] = static_cast<uint32_t>(v);
+    }
+    sizes.assign(n, 1);
+}
+
+uint32_t UnionFind::find(uint32_t v)
+{
+    while (parent[v] != v) {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+bool UnionFind::unite(uint32_t a, uint32_t b)
+{
+    a = find(a);
+    b = find(b);
+    if (a == b) {
+        return false;
+    }
+    if (sizes[a] < sizes[b]) {
+        swap(a, b);
+    }
+    parent[b] = a;
+    sizes[a] += sizes[b];
+    return true;
+}
+
+size_t CycleAnalysis::largest_component() const
+{
+    return component_sizes.empty() ? 0 : *max_element(component_sizes.begin(), component_sizes.end());
+}
+
+template <class G>
+static CycleAnalysis directed_cycle_analysis_impl(const G &g)
+{
+    using VertexG = typename graph_traits<G>::vertex_descriptor;
+    using OutEdgeIterator = typename graph_traits<G>::out_edge_iterator;
+
+    struct Frame
+    {
+        VertexG v;
+        OutEdgeIterator it, end;
+    };
+
+    size_t n = num_vertices(g);
+    CycleAnalysis result;
+    result.component.assign(n, NONE);
+
+    vector<uint32_t> index(n, NONE), low(n, 0);
+    vector<char> on_stack(n, 0);
+    vector<VertexG> stack;
+    vector<Frame> frames;
+    uint32_t next_index = 0;
+    VertexG self_loop = static_cast<VertexG>(n);
+
+    auto visit = [&](VertexG v) {
+        index[v] = low[v] = next_index++;
+        stack.push_back(v);
+        on_stack[v] = 1;
+        auto [it, end] = out_edges(v, g);
+        frames.push_back({v, it, end});
+    };
+
+    // Tarjan avec pile d'appels explicite : profondeur non limitée par la pile du programme
+    for (size_t root = 0; root < n; ++root) {
+        if (index[root] != NONE) {
+            continue;
+        }
+        visit(static_cast<VertexG>(root));
+
+        while (!frames.empty()) {
+            Frame &frame = frames.back();
+            VertexG v = frame.v;
+            if (frame.it != frame.end) {
+                VertexG w = target(*frame.it, g);
+                ++frame.it;
+                if (w == v && self_loop == n) {
+                    self_loop = v;
+                }
+                if (index[w] == NONE) {
+                    visit(w);
+                } else if (on_stack[w]) {
+                    low[v] = min(low[v], index[w]);
+                }
+                continue;
+            }
+
+            frames.pop_back();
+            if (!frames.empty()) {
+                VertexG parent = frames.back().v;
+                low[parent] = min(low[parent], low[v]);
+            }
+
+            if (low[v] == index[v]) {
+                uint32_t id = static_cast<uint32_t>(result.component_sizes.size());
+                size_t size = 0;
+                VertexG w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    on_stack[w] = 0;
+                    result.component[w] = id;
+                    size++;
+                } while (w != v);
+                result.component_sizes.push_back(size);
+            }
+        }
+    }
+    result.num_components = result.component_sizes.size();
+
+    // Témoin : plus court retour vers un sommet d'une composante non triviale, ou boucle
+    auto cyclic = find_if(result.component_sizes.begin(), result.component_sizes.end(), [](size_t size) { return size > 1; });
+    if (cyclic != result.component_sizes.end()) {
+        uint32_t id = static_cast<uint32_t>(cyclic - result.component_sizes.begin());
+        VertexG start = static_cast<VertexG>(find(result.component.begin(), result.component.end(), id) - result.component.begin());
+
+        vector<uint32_t> parent(n, NONE);
+        vector<VertexG> queue = {start};
+        parent[start] = start;
+        VertexG last = start;
+        bool closed = false;
+        for (size_t head = 0; head < queue.size() && !closed; ++head) {
+            VertexG u = queue[head];
+            for (auto [ei, ei_end] = out_edges(u, g); ei != ei_end; ++ei) {
+                VertexG w = target(*ei, g);
+                if (w == start) {
+                    last = u;
+                    closed = true;
+                    break;
+                }
+                if (result.component[w] == id && parent[w] == NONE) {
+                    parent[w] = static_cast<uint32_t>(u);
+                    queue.push_back(w);
+                }
+            }
+        }
+
+        result.has_cycle = true;
+        for (VertexG v = last; v != start; v = parent[v]) {
+            result.cycle.push_back(v);
+        }
+        result.cycle.push_back(start);
+        reverse(result.cycle.begin(), result.cycle.end());
+    } else if (self_loop != n) {
+        result.has_cycle = true;
+        result.cycle = {static_cast<Vertex>(self_loop)};
+    }
+    return result;
+}
+
+CycleAnalysis directed_cycle_analysis(const Graph &g)
+{
+    return directed_cycle_analysis_impl(g);
+}
+
+CycleAnalysis directed_cycle_analysis(const CSRGraph &g)
+{
+    return directed_cycle_analysis_impl(g);
+}
+
+CycleAnalysis directed_cycle_analysis(const CompactGraph &g)
+{
+    return directed_cycle_analysis_impl(g);
+}
+
+/**
+ * @brief union-find sur un flux d'arêtes : for_each_edge(f) appelle f(a, b) pour chaque arête non orientée
+ */
+template <class ForEachEdge>
+static CycleAnalysis undirected_cycle_analysis_impl(size_t n, ForEachEdge &&for_each_edge)
+{
+    CycleAnalysis result;
+    UnionFind sets(n);
+    vector<pair<uint32_t, uint32_t>> forest;
+    pair<uint32_t, uint32_t> closing;
+
+    for_each_edge([&](uint32_t a, uint32_t b) {
+        if (sets.unite(a, b)) {
+            if (!result.has_cycle) {
+                forest.emplace_back(a, b);
+            }
+        } else if (!result.has_cycle) {
+            result.has_cycle = true;
+            closing = {a, b};
+        }
+    });
+
+    result.component.assign(n, NONE);
+    vector<uint32_t> root_component(n, NONE);
+    for (size_t v = 0; v < n; ++v) {
+        uint32_t root = sets.find(static_cast<uint32_t>(v));
+        if (root_component[root] == NONE) {
+            root_component[root] = static_cast<uint32_t>(result.component_sizes.size());
+            result.component_sizes.push_back(sets.size_of(root));
+        }
+        result.component[v] = root_component[root];
+    }
+    result.num_components = result.component_sizes.size();
+
+    if (!result.has_cycle) {
+        return result;
+    }
+
+    // Témoin : chemin entre les extrémités de l'arête fermante dans la forêt construite avant elle
+    auto [a, b] = closing;
+    if (a == b) {
+        result.cycle = {a};
+        return result;
+    }
+
+    vector<uint32_t> offsets(n + 1, 0), adjacency(2 * forest.size());
+    for (const auto &[u, v] : forest) {
+        offsets[u + 1]++;
+        offsets[v + 1]++;
+    }
+    for (size_t v = 0; v < n; ++v) {
+        offsets[v + 1] += offsets[v];
+    }
+    vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (const auto &[u, v] : forest) {
+        adjacency[cursor[u]++] = v;
+        adjacency[cursor[v]++] = u;
+    }
+
+    vector<uint32_t> parent(n, NONE);
+    vector<uint32_t> queue = {a};
+    parent[a] = a;
+    for (size_t head = 0; head < queue.size() && parent[b] == NONE; ++head) {
+        uint32_t u = queue[head];
+        for (uint32_t i = offsets[u]; i < offsets[u + 1]; ++i) {
+            uint32_t w = adjacency[i];
+            if (parent[w] == NONE) {
+                parent[w] = u;
+                queue.push_back(w);
+            }
+        }
+    }
+
+    for (uint32_t v = b; v != a; v = parent[v]) {
+        result.cycle.push_back(v);
+    }
+    result.cycle.push_back(a);
+    reverse(result.cycle.begin(), result.cycle.end());
+    return result;
+}
+
+CycleAnalysis undirected_cycle_analysis(size_t num_vertices, const vector<pair<int, int>> &edge_list)
+{
+    // Arêtes rangées par extrémité basse (tri par comptage stable) : ordre des arcs u <= v du graph CSR
+    vector<size_t> first(num_vertices + 1, 0);
+    for (const auto &[a, b] : edge_list) {
+        first[min(a, b) + 1]++;
+    }
+    for (size_t v = 0; v < num_vertices; ++v) {
+        first[v + 1] += first[v];
+    }
+    vector<size_t> order(edge_list.size());
+    for (size_t i = 0; i < edge_list.size(); ++i) {
+        order[first[min(edge_list[i].first, edge_list[i].second)]++] = i;
+    }
+
+    return undirected_cycle_analysis_impl(num_vertices, [&](auto &&f) {
+        for (size_t i : order) {
+            auto [a, b] = edge_list[i];
+            f(static_cast<uint32_t>(min(a, b)), static_cast<uint32_t>(max(a, b)));
+        }
+    });
+}
+
+template <class G>
+static CycleAnalysis undirected_graph_impl(const G &g)
+{
+    using VertexG = typename graph_traits<G>::vertex_descriptor;
+    size_t n = num_vertices(g);
+
+    // Chaque arête est présente dans les deux sens : un seul arc lu par arête, une boucle fermant aussitôt un cycle
+    return undirected_cycle_analysis_impl(n, [&](auto &&f) {
+        for (size_t u = 0; u < n; ++u) {
+            for (auto [ei, ei_end] = out_edges(static_cast<VertexG>(u), g); ei != ei_end; ++ei) {
+                size_t v = target(*ei, g);
+                if (u <= v) {
+                    f(static_cast<uint32_t>(u), static_cast<uint32_t>(v));
+                }
+            }
+        }
+    });
+}
+
+CycleAnalysis undirected_cycle_analysis(const Graph &g)
+{
+    return undirected_graph_impl(g);
+}
+
+CycleAnalysis undirected_cycle_analysis(const CSRGraph &g)
+{
+    return undirected_graph_impl(g);
+}
+
+CycleAnalysis undirected_cycle_analysis(const CompactGraph &g)
+{
+    return undirected_graph_impl(g);
+}
@@ -0,0 +1,339 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cmath>
+#include <limits>
+#include "floyd_warshall.h"
+#include "path_search.h"
+#include "ordered_writer.h"
+#include "instrumentation.h"
+
+#ifdef __AVX2__
+    #include <immintrin.h>
+#endif
+
+using namespace std;
+using namespace boost;
+
+// Tuile de 64 x 64 distances (32 Ko) : trois tuiles tiennent dans le cache L2. Les lignes sont allongées
+// de quelques colonnes inutilisées pour que celles d'une tuile ne tombent pas dans les mêmes ensembles du cache
+static const size_t TILE = 64;
+static const size_t ROW_PADDING = 8;
+static const double UNREACHABLE = numeric_limits<double>::infinity();
+
+/**
+ * @brief exécution de count tâches indépendantes réparties entre les threads
+ */
+template <typename F>
+static void parallel_tasks(size_t count, unsigned num_threads, F &&task)
+{
+    num_threads = resolve_num_threads(num_threads, count);
+    if (num_threads <= 1) {
+        for (size_t t = 0; t < count; ++t) {
+            task(t);
+        }
+        return;
+    }
+    atomic<size_t> next_task{0};
+    vector<thread> workers;
+    for (unsigned w = 0; w < num_threads; ++w) {
+        workers.emplace_back([&]() {
+            for (size_t t; (t = next_task.fetch_add(1)) < count;) {
+                task(t);
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+}
+
+/**
+ * @brief relâchement min-plus de la tuile (ib, jb) par les sommets intermédiaires du bloc kb :
+ * d(i, j) = min(d(i, j), d(i, k) + d(k, j)), le sommet suivant de i vers j devenant celui de i vers k
+ *
+ * Les tuiles peuvent se confondre (tuile diagonale, ligne et colonne du bloc) : d(i, k) et d(k, j) ne
+ * changent pas pendant l'étape k, les poids étant positifs.
+ */
+static void relax_tile(double *dist, uint32_t *next, size_t stride, size_t n, size_t ib, size_t jb, size_t kb)
+{
+    size_t i_end = min(n, ib + TILE), k_end = min(n, kb + TILE);
+    for (size_t k = kb; k < k_end; ++k) {
+        const double *row_k = dist + k * stride + jb;
+        for (size_t i = ib; i < i_end; ++i) {
+            double d_ik = dist[i * stride + k];
+            if (d_ik == UNREACHABLE) {
+                continue;
+            }
+            uint32_t next_ik = next[i * stride + k];
+            double *row_i = dist + i * stride + jb;
+            uint32_t *next_i = next + i * stride + jb;
+#ifdef __AVX2__
+            // Sans branchement : masque des distances raccourcies réduit à 32 bits pour les sommets suivants
+            const __m256i low_halves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+            __m256d via = _mm256_set1_pd(d_ik);
+            __m128i via_next = _mm_set1_epi32(static_cast<int>(next_ik));
+            for (size_t j = 0; j < TILE; j += 4) {
+                __m256d candidate = _mm256_add_pd(via, _mm256_loadu_pd(row_k + j));
+                __m256d current = _mm256_loadu_pd(row_i + j);
+                __m256d shorter = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+                _mm256_storeu_pd(row_i + j, _mm256_blendv_pd(current, candidate, shorter));
+                __m128i mask = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(shorter), low_halves));
+                __m128i *next_j = reinterpret_cast<__m128i *>(next_i + j);
+                _mm_storeu_si128(next_j, _mm_blendv_epi8(_mm_loadu_si128(next_j), via_next, mask));
+            }
+#else
+            for (size_t j = 0; j < TILE; ++j) {
+                double candidate = d_ik + row_k[j];
+                if (candidate < row_i[j]) {
+                    row_i[j] = candidate;
+                    next_i[j] = next_ik;
+                }
+            }
+#endif
+        }
+    }
+}
+
+void AllPairsMatrix::run(unsigned num_threads)
+{
+    size_t blocks = (n + TILE - 1) / TILE;
+    double *dist = distances.data();
+    uint32_t *nxt = next.data();
+
+    for (size_t kb = 0; kb < blocks; ++kb) {
+        size_t k0 = kb * TILE;
+        if (k0 >= n) {
+            break;
+        }
+
+        // Tuile diagonale, puis tuiles de la ligne et de la colonne du bloc, puis toutes les autres
+        relax_tile(dist, nxt, stride, n, k0, k0, k0);
+        parallel_tasks(2 * (blocks - 1), num_threads, [&](size_t t) {
+            size_t other = t / 2 < kb ? t / 2 : t / 2 + 1;
+            if (t % 2 == 0) {
+                relax_tile(dist, nxt, stride, n, k0, other * TILE, k0);
+            } else {
+                relax_tile(dist, nxt, stride, n, other * TILE, k0, k0);
+            }
+        });
+        parallel_tasks((blocks - 1) * (blocks - 1), num_threads, [&](size_t t) {
+            size_t ib = t / (blocks - 1), jb = t % (blocks - 1);
+            ib += ib >= kb;
+            jb += jb >= kb;
+            relax_tile(dist, nxt, stride, n, ib * TILE, jb * TILE, k0);
+        });
+    }
+}
+
+template <class G>
+AllPairsMatrix AllPairsMatrix::build_impl(const G &g, unsigned num_threads)
+{
+    using VertexG = typename graph_traits<G>::vertex_descriptor;
+    ScopedTimer timer(Phase::Search);
+
+    AllPairsMatrix m;
+    // Fonction libre du graph (CSR de Boost ou compact), masquée ici par AllPairsMatrix::num_vertices
+    using boost::num_vertices;
+    m.n = num_vertices(g);
+    m.stride = (m.n + TILE - 1) / TILE * TILE + ROW_PADDING;
+    m.distances.assign(m.n * m.stride, UNREACHABLE);
+    m.next.assign(m.n * m.stride, 0);
+    m.direct.assign(m.n * m.n, numeric_limits<float>::infinity());
+
+    // Arcs d'origine (le plus léger des arcs parallèles)
+    auto weight = get(edge_weight, g);
+    for (size_t u = 0; u < m.n; ++u) {
+        m.distances[u * m.stride + u] = 0;
+        m.next[u * m.stride + u] = static_cast<uint32_t>(u);
+        for (auto [ei, ei_end] = out_edges(static_cast<VertexG>(u), g); ei != ei_end; ++ei) {
+            size_t v = target(*ei, g);
+            float w = get(weight, *ei);
+            if (v == u || w >= m.direct[u * m.n + v]) {
+                continue;
+            }
+            m.direct[u * m.n + v] = w;
+            m.distances[u * m.stride + v] = w;
+            m.next[u * m.stride + v] = static_cast<uint32_t>(v);
+        }
+    }
+
+    // Arcs entrants distincts, regroupés par sommet d'arrivée
+    m.in_offsets.assign(m.n + 1, 0);
+    for (size_t u = 0; u < m.n; ++u) {
+        for (size_t v = 0; v < m.n; ++v) {
+            m.in_offsets[v + 1] += m.direct[u * m.n + v] != numeric_limits<float>::infinity();
+        }
+    }
+    for (size_t v = 0; v < m.n; ++v) {
+        m.in_offsets[v + 1] += m.in_offsets[v];
+    }
+    m.in_sources.resize(m.in_offsets[m.n]);
+    m.in_weights.resize(m.in_offsets[m.n]);
+    vector<uint32_t> fill(m.in_offsets.begin(), m.in_offsets.end() - 1);
+    for (size_t u = 0; u < m.n; ++u) {
+        for (size_t v = 0; v < m.n; ++v) {
+            if (m.direct[u * m.n + v] != numeric_limits<float>::infinity()) {
+                m.in_weights[fill[v]] = m.direct[u * m.n + v];
+                m.in_sources[fill[v]++] = static_cast<uint32_t>(u);
+            }
+        }
+    }
+
+    m.run(num_threads);
+    return m;
+}
+
+AllPairsMatrix AllPairsMatrix::build(const Graph &g, unsigned num_threads)
+{
+    return build_impl(g, num_threads);
+}
+
+AllPairsMatrix AllPairsMatrix::build(const CSRGraph &g, unsigned num_threads)
+{
+    return build_impl(g, num_threads);
+}
+
+AllPairsMatrix AllPairsMatrix::build(const CompactGraph &g, unsigned num_threads)
+{
+    return build_impl(g, num_threads);
+}
+
+bool AllPairsMatrix::extract_path(Vertex start, Vertex goal, vector<Vertex> &path) const
+{
+    path.clear();
+    if (distances[start * stride + goal] == UNREACHABLE) {
+        return false;
+    }
+    Vertex v = start;
+    path.push_back(v);
+    while (v != goal && path.size() <= n) {
+        v = next[v * stride + goal];
+        path.push_back(v);
+    }
+    return v == goal;
+}
+
+double AllPairsMatrix::path_length(const vector<Vertex> &path) const
+{
+    double length = 0;
+    for (size_t i = 1; i < path.size(); ++i) {
+        length += direct[path[i - 1] * n + path[i]];
+    }
+    return length;
+}
+
+bool AllPairsMatrix::has_equal_length_paths(const vector<Vertex> &starts, unsigned num_threads) const
+{
+    // Tolérance relative bien au-dessus des écarts d'arrondi entre la somme de Floyd-Warshall et celle d'un
+    // Dijkstra, bien en dessous des écarts entre chemins distincts sur des coordonnées quelconques
+    const double TOLERANCE = 1e-9;
+    atomic<bool> found{false};
+    parallel_tasks(starts.size(), num_threads, [&](size_t t) {
+        if (found.load(memory_order_relaxed)) {
+            return;
+        }
+        const double *row = distances.data() + starts[t] * stride;
+        for (size_t v = 0; v < n; ++v) {
+            if (v == starts[t] || row[v] == UNREACHABLE) {
+                continue;
+            }
+            double slack = TOLERANCE * row[v];
+            unsigned tight = 0;
+            for (uint32_t i = in_offsets[v]; i < in_offsets[v + 1]; ++i) {
+                tight += fabs(row[in_sources[i]] + in_weights[i] - row[v]) <= slack;
+            }
+            if (tight > 1) {
+                found.store(true, memory_order_relaxed);
+                return;
+            }
+        }
+    });
+    return found.load();
+}
+
+template <class G>
+static bool sampled_equal_length_paths_impl(const G &g, const vector<Vertex> &starts, size_t samples, unsigned num_threads)
+{
+    using VertexG = typename graph_traits<G>::vertex_descriptor;
+    const double TOLERANCE = 1e-9;
+    size_t n = num_vertices(g);
+    samples = min(samples, starts.size());
+    auto weight = get(edge_weight, g);
+    atomic<bool> found{false};
+    parallel_tasks(samples, num_threads, [&](size_t t) {
+        if (found.load(memory_order_relaxed)) {
+            return;
+        }
+        Vertex source = starts[t * starts.size() / samples];
+        SearchScratch scratch;
+        scratch.engine_threads = 1;
+        dijkstra_to_goals(g, source, {}, scratch);
+        const vector<double> &d = scratch.distances;
+
+        // Nombre de prédécesseurs distincts reliés par un arc tendu, arcs parallèles comptés une fois
+        vector<uint8_t> tight(n, 0);
+        vector<uint32_t> last(n, numeric_limits<uint32_t>::max());
+        for (uint32_t u : scratch.touched) {
+            for (auto [ei, ei_end] = out_edges(static_cast<VertexG>(u), g); ei != ei_end; ++ei) {
+                Vertex v = target(*ei, g);
+                if (v == source || v == u || last[v] == u || fabs(d[u] + get(weight, *ei) - d[v]) > TOLERANCE * d[v]) {
+                    continue;
+                }
+                last[v] = u;
+                if (++tight[v] > 1) {
+                    found.store(true, memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+    });
+    return found.load();
+}
+
+bool sampled_equal_length_paths(const Graph &g, const vector<Vertex> &starts, size_t samples, unsigned num_threads)
+{
+    return sampled_equal_length_paths_impl(g, starts, samples, num_threads);
+}
+
+bool sampled_equal_length_paths(const CSRGraph &g, const vector<Vertex> &starts, size_t samples, unsigned num_threads)
+{
+    return sampled_equal_length_paths_impl(g, starts, samples, num_threads);
+}
+
+bool sampled_equal_length_paths(const CompactGraph &g, const vector<Vertex> &starts, size_t samples, unsigned num_threads)
+{
+    return sampled_equal_length_paths_impl(g, starts, samples, num_threads);
+}
+
+size_t AllPairsMatrix::memory_bytes(size_t n)
+{
+    size_t stride = (n + TILE - 1) / TILE * TILE + ROW_PADDING;
+    return n * stride * (sizeof(double) + sizeof(uint32_t)) + n * n * sizeof(float);
+}
+
+const char *AllPairsMatrix::kernel_name()
+{
+#ifdef __AVX2__
+    return "avx2";
+#else
+    return "scalar";
+#endif
+}
+
+bool prefer_floyd_warshall(size_t n, size_t arcs, size_t sources)
+{
+    if (n < 2 || n > FLOYD_WARSHALL_MAX_VERTICES || sources < n / 2) {
+        return false;
+    }
+    // Coûts relatifs mesurés : un relâchement de Dijkstra (accès irréguliers, file de priorité) vaut une
+    // douzaine de relâchements min-plus vectorisés d'une tuile en cache, environ cinq en scalaire
+#ifdef __AVX2__
+    const double MIN_PLUS_PER_RELAXATION = 12;
+#else
+    const double MIN_PLUS_PER_RELAXATION = 5;
+#endif
+    double floyd_warshall = static_cast<double>(n) * n * n;
+    double per_source = static_cast<double>(sources) * (arcs + n * log2(static_cast<double>(n)));
+    return floyd_warshall < per_source * MIN_PLUS_PER_RELAXATION;
+}
@@ -1,7 +1,18 @@
 #include <iostream>
 #include <fstream>
 #include <chrono>
+#include <algorithm>
 #include "graph_analysis.h"
+#include "path_search.h"
+#include "ordered_writer.h"
+#include "contraction_hierarchy.h"
+#include "sssp_cache.h"
+#include "path_matrix.h"
+#include "cycle_analysis.h"
+#include "graph_metrics.h"
+#include "floyd_warshall.h"
+#include "vertex_order.h"
+#include "instrumentation.h"
 
 using namespace std;
 using namespace boost;
@@ -28,50 +39,236 @@ void readCSV(const string &filename, vector<string> &data)
     file.close();
 }
 
-double calcul_distance(int first, int second, const vector<std::tuple<double, double, double>> &coord_list)
+double calcul_distance(int first, int second, const CoordinateStore &coord_list)
 {
-    double x1 = get<0>(coord_list[first]);
-    double y1 = get<1>(coord_list[first]);
-    double z1 = get<2>(coord_list[first]);
-    double x2 = get<0>(coord_list[second]);
-    double y2 = get<1>(coord_list[second]);
-    double z2 = get<2>(coord_list[second]);
+    return coord_list.distance(first, second);
+}
+
+CSRGraph build_csr(size_t num_vertices, const vector<pair<int, int>> &edge_list, const vector<float> &weights)
+{
+    ScopedTimer timer(Phase::Build);
+
+    // Comptage des arcs sortants : chaque arête non orientée donne un arc dans chaque sens
+    vector<uint64_t> offsets(num_vertices + 1, 0);
+    for (const auto &[u, v] : edge_list) {
+        offsets[u + 1]++;
+        offsets[v + 1]++;
+    }
+    for (size_t i = 0; i < num_vertices; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    // Placement des arcs triés par source, dans l'ordre de la liste d'arêtes
+    vector<pair<uint32_t, uint32_t>> arcs(offsets.back());
+    vector<float> arc_weights(offsets.back());
+    for (size_t i = 0; i < edge_list.size(); ++i) {
+        auto [u, v] = edge_list[i];
+        arc_weights[offsets[u]] = weights[i];
+        arcs[offsets[u]++] = {u, v};
+        arc_weights[offsets[v]] = weights[i];
+        arcs[offsets[v]++] = {v, u};
+    }
 
-    return sqrt(pow(x1 - x2, 2) + pow(y1 - y2, 2) + pow(z1 - z2, 2));
+    return CSRGraph(edges_are_sorted, arcs.begin(), arcs.end(), arc_weights.begin(), num_vertices, arcs.size());
 }
 
-void find_shortest_path(Graph &g, Vertex start, Vertex goal) {
-    size_t n = num_vertices(g);
+CSRGraph build_csr(const Graph &g)
+{
+    vector<pair<uint32_t, uint32_t>> arcs;
+    vector<float> arc_weights;
+    arcs.reserve(num_edges(g));
+    arc_weights.reserve(num_edges(g));
+
+    auto weight = get(edge_weight, g);
+    for (size_t u = 0; u < num_vertices(g); ++u) {
+        for (auto [ei, ei_end] = out_edges(u, g); ei != ei_end; ++ei) {
+            arcs.emplace_back(u, target(*ei, g));
+            arc_weights.push_back(get(weight, *ei));
+        }
+    }
+
+    return CSRGraph(edges_are_sorted, arcs.begin(), arcs.end(), arc_weights.begin(), num_vertices(g), arcs.size());
+}
+
+size_t csr_memory_used(const CSRGraph &g)
+{
+    using Traits = graph_traits<CSRGraph>;
+    return (num_vertices(g) + 1) * sizeof(Traits::edges_size_type) +
+           num_edges(g) * (sizeof(Traits::vertex_descriptor) + sizeof(float));
+}
+
+template <class G>
+static void find_shortest_path_impl(const G &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, ShortestPathTreeCache *cache,
+                                    const VertexNumbering &numbering) {
     start--;
     goal--;
 
-    vector<int> distances(n, numeric_limits<int>::max());
-    vector<Vertex> predecessors(n);
+    SearchScratch scratch;
+    PathResult result = cache ? shortest_path_query(g, coord_list, start, goal, mode, scratch, *cache)
+                              : shortest_path_query(g, coord_list, start, goal, mode, scratch);
 
-    dijkstra_shortest_paths(g, start,
-        predecessor_map(make_iterator_property_map(predecessors.begin(), get(vertex_index, g))).
-        distance_map(make_iterator_property_map(distances.begin(), get(vertex_index, g))).
-        weight_map(get(edge_weight, g))
-    );
+    cout << "Shortest path from " << numbering.external(start) + 1 << " to " << numbering.external(goal) + 1 << " is: ";
 
-    cout << "Shortest path from " << start + 1 << " to " << goal + 1 << " is: ";
+    if (!result.found) {
+        cout << "No Path" << endl;
+    } else {
+        cout << numbering.external(result.path.front()) + 1;
+        for (size_t i = 1; i < result.path.size(); ++i) {
+            cout << " -> " << numbering.external(result.path[i]) + 1;
+        }
+        cout << " Path Length: " << result.path.size() << endl;
+    }
+    cout << "Search: " << search_mode_name(mode) << ", settled vertices: " << result.settled << endl;
+}
 
-    vector<Vertex> path;
-    for (Vertex v = goal; v != start; v = predecessors[v]) {
-        path.push_back(v);
+void find_shortest_path(Graph &g, Vertex start, Vertex goal) {
+    find_shortest_path_impl(g, {}, start, goal, SearchMode::Dijkstra, nullptr, VertexNumbering());
+}
+
+void find_shortest_path(CSRGraph &g, Vertex start, Vertex goal) {
+    find_shortest_path_impl(g, {}, start, goal, SearchMode::Dijkstra, nullptr, VertexNumbering());
+}
+
+void find_shortest_path(CompactGraph &g, Vertex start, Vertex goal) {
+    find_shortest_path_impl(g, {}, start, goal, SearchMode::Dijkstra, nullptr, VertexNumbering());
+}
+
+void find_shortest_path(Graph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, ShortestPathTreeCache *cache) {
+    find_shortest_path_impl(g, coord_list, start, goal, mode, cache, VertexNumbering());
+}
+
+void find_shortest_path(CSRGraph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, ShortestPathTreeCache *cache) {
+    find_shortest_path_impl(g, coord_list, start, goal, mode, cache, VertexNumbering());
+}
+
+void find_shortest_path(CompactGraph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, ShortestPathTreeCache *cache) {
+    find_shortest_path_impl(g, coord_list, start, goal, mode, cache, VertexNumbering());
+}
+
+/**
+ * @brief écriture d'une ligne "Start;End;Path Length;Path" à partir de la dernière recherche
+ */
+static void write_path_row(string &out, double start, double goal, Vertex start_idx, Vertex goal_idx, const SearchScratch &scratch, vector<Vertex> &path,
+                           const VertexNumbering &numbering)
+{
+    bool found = extract_path(scratch, start_idx, goal_idx, path);
+    write_path_row(out, start, goal, found, scratch.distances[goal_idx], path, numbering);
+}
+
+/**
+ * @brief traitement d'un lot : une recherche depuis sa source puis écriture de toutes ses lignes
+ *
+ * Si row_length est non nul (sources non contiguës), la longueur de chaque ligne écrite y est rangée à son indice
+ * d'origine. Avec un cache, la source est servie par son arbre complet.
+ */
+template <class G>
+static void export_batch(const G &g, const vector<pair<double, double>> &list_Node, const PairBatches &batches, size_t b,
+                         SearchScratch &scratch, vector<Vertex> &goals, vector<Vertex> &path,
+                         string &out, vector<uint32_t> *row_length, ShortestPathTreeCache *cache, const VertexNumbering &numbering)
+{
+    Vertex start_idx = batches.sources[b];
+
+    goals.clear();
+    for_each_batch_row(batches, list_Node, b, [&](size_t r) {
+        goals.push_back(static_cast<Vertex>(list_Node[r].second - 1));
+    });
+
+    // Arbre en cache, ou calcul des plus courts chemins arrêté dès que toutes les arrivées du lot sont fixées
+    std::shared_ptr<const ShortestPathTree> tree;
+    if (cache) {
+        tree = cache->tree(g, start_idx, scratch);
+    } else {
+        dijkstra_to_goals(g, start_idx, goals, scratch);
     }
-    path.push_back(start);
 
-    cout << path.back() + 1;
-    for (auto it = path.rbegin(); it != path.rend(); ++it) {
-        if (it != path.rbegin()) {
-            cout << " -> " << *it + 1;
+    // Reconstruction des chemins depuis le même tableau de prédécesseurs
+    auto write_row = [&](double start, double goal) {
+        if (tree) {
+            bool found = tree->extract_path(goal - 1, path);
+            write_path_row(out, start, goal, found, tree->distances[goal - 1], path, numbering);
+        } else {
+            write_path_row(out, start, goal, start_idx, goal - 1, scratch, path, numbering);
+        }
+    };
+    for_each_batch_row(batches, list_Node, b, [&](size_t r) {
+        const auto &[start, goal] = list_Node[r];
+        size_t begin = out.size();
+        write_row(start, goal);
+        if (row_length) {
+            (*row_length)[r] = static_cast<uint32_t>(out.size() - begin);
         }
+    });
+}
+
+/**
+ * @brief recopie dans file, dans l'ordre de list_Node, des lignes écrites dans l'ordre des lots (fichier spill_filename)
+ *
+ * La position de chaque ligne est déduite des longueurs, cumulées dans l'ordre des lots ; les lignes sont
+ * ensuite relues une à une dans l'ordre de list_Node et écrites par blocs bornés.
+ */
+static void copy_rows_in_order(ofstream &file, const string &spill_filename, const vector<pair<double, double>> &list_Node,
+                               const PairBatches &batches, const vector<uint32_t> &row_length)
+{
+    vector<uint64_t> row_offset(list_Node.size(), 0);
+    uint64_t offset = 0;
+    for (size_t b = 0; b < batches.size(); ++b) {
+        for_each_batch_row(batches, list_Node, b, [&](size_t r) {
+            row_offset[r] = offset;
+            offset += row_length[r];
+        });
+    }
+    if (offset == 0) {
+        return;
     }
-    cout << " Path Length: " << path.size() << endl;
+
+    ifstream spill(spill_filename, ios::in | ios::binary);
+    const size_t BLOCK_BYTES = size_t(1) << 20;
+    string text;
+    for (size_t r = 0; r < list_Node.size() && spill; ++r) {
+        if (row_length[r] == 0) {
+            continue;
+        }
+        size_t end = text.size();
+        text.resize(end + row_length[r]);
+        spill.seekg(row_offset[r]);
+        spill.read(&text[end], row_length[r]);
+        if (text.size() >= BLOCK_BYTES) {
+            write_chunk(file, text);
+            text.clear();
+        }
+    }
+    if (!spill) {
+        cerr << "Relecture du fichier temporaire '" << spill_filename << "' impossible" << endl;
+        return;
+    }
+    write_chunk(file, text);
 }
 
-void CSVOuptutFunction(Graph &g, const vector<pair<double, double>> &list_Node, const vector<std::tuple<double, double, double>> &coord_list, const string &filename) {
+/**
+ * @brief export de toutes les lignes valides de list_Node, dans leur ordre, depuis une matrice de Floyd-Warshall
+ */
+static void export_from_matrix(ofstream &file, const AllPairsMatrix &matrix, const vector<pair<double, double>> &list_Node, const VertexNumbering &numbering,
+                               unsigned num_threads)
+{
+    const size_t ROWS_PER_CHUNK = 4096;
+    size_t n = matrix.num_vertices();
+    size_t num_chunks = (list_Node.size() + ROWS_PER_CHUNK - 1) / ROWS_PER_CHUNK;
+    write_chunks_in_order<vector<Vertex>>(file, num_chunks, resolve_num_threads(num_threads, num_chunks), [&](vector<Vertex> &path, size_t c, string &text) {
+        size_t last = min(list_Node.size(), (c + 1) * ROWS_PER_CHUNK);
+        for (size_t r = c * ROWS_PER_CHUNK; r < last; ++r) {
+            const auto &[start, goal] = list_Node[r];
+            if (!valid_pair(start, goal, n)) {
+                continue;
+            }
+            bool found = matrix.extract_path(static_cast<Vertex>(start - 1), static_cast<Vertex>(goal - 1), path);
+            write_path_row(text, start, goal, found, found ? matrix.path_length(path) : 0, path, numbering);
+        }
+    });
+}
+
+template <class G>
+static void csv_output_impl(const G &g, const vector<pair<double, double>> &list_Node, const VertexNumbering &numbering, const string &filename,
+                            unsigned num_threads, ShortestPathTreeCache *cache) {
     
     ofstream file(filename, ios::out | ios::trunc);
 
@@ -83,70 +280,98 @@ void CSVOuptutFunction(Graph &g, const vector<pair<double, double>> &list_Node,
     file << "Start;End;Path Length;Path\n";
     size_t n = num_vertices(g);
 
-    vector<double> distances(n);
-    vector<Vertex> predecessors(n);
-
-    // Parcours de la liste des noeuds
-    for (const auto &[start, goal] : list_Node) {
-        if (start < 1 || goal < 1 || start > n || goal > n) {
-            cerr << "Erreur : Indices de sommet invalides (" << start << ", " << goal << ")" << endl;
-            continue;
-        }
-
-        Vertex start_idx = start - 1, goal_idx = goal - 1;
-
-        // Initialisation des distances et des prédécesseurs
-        fill(distances.begin(), distances.end(), numeric_limits<double>::max());
-        fill(predecessors.begin(), predecessors.end(), start_idx);
-
-        // Calcul du plus court chemin
-        dijkstra_shortest_paths(g, start_idx,
-        predecessor_map(make_iterator_property_map(predecessors.begin(), get(vertex_index, g))).
-        distance_map(make_iterator_property_map(distances.begin(), get(vertex_index, g))).
-        weight_map(get(edge_weight, g)));
-
-        if (distances[goal_idx] == numeric_limits<double>::max()) {
-            file << start << ";" << goal << ";Inf;No Path\n";
-            continue;
-        }
-
-        // Reconstruction du chemin
-        vector<Vertex> path;
-        path.reserve(n);
-        for (Vertex v = goal_idx; v != start_idx; v = predecessors[v]) {
-            if (v == predecessors[v]) {
-                cerr << "Erreur dans le chemin, arrêt prématuré" << endl;
-                file << start << ";" << goal << ";Inf;No Path\n";
-                break;
+    // Regroupement des requêtes par sommet de départ : une seule recherche par source
+    PairBatches batches = group_pairs_by_source(list_Node, n);
+
+    // Graph dense et presque tous les sommets au départ : une matrice de Floyd-Warshall revient moins cher
+    // qu'une recherche par source, pour les mêmes lignes tant que chaque plus court chemin est unique ; sinon
+    // les recherches par source décident entre chemins de même longueur, comme pour tout autre export. Les
+    // égalités sont cherchées sur quelques départs avant de calculer la matrice, puis sur tous avec elle
+    if (prefer_floyd_warshall(n, num_edges(g), batches.size())) {
+        if (sampled_equal_length_paths(g, batches.sources, 8, num_threads)) {
+            cout << "All-pairs matrix: equal-length shortest paths, per-source searches instead" << endl;
+        } else {
+            cout << "All-pairs matrix: Floyd-Warshall, " << AllPairsMatrix::kernel_name() << " kernel, "
+                 << AllPairsMatrix::memory_bytes(n) / (1024 * 1024) << " MiB" << endl;
+            AllPairsMatrix matrix = AllPairsMatrix::build(g, num_threads);
+            if (!matrix.has_equal_length_paths(batches.sources, num_threads)) {
+                export_from_matrix(file, matrix, list_Node, numbering, num_threads);
+                file.close();
+                cout << "Fichier CSV '" << filename << "' généré avec succès." << endl;
+                return;
             }
-            path.push_back(v);
+            cout << "All-pairs matrix: equal-length shortest paths from another start, per-source searches instead" << endl;
         }
+    }
 
-        path.push_back(start_idx);
+    // Sources non contiguës : lignes écrites dans l'ordre des recherches dans un fichier temporaire, puis recopiées
+    // dans l'ordre de list_Node ; seules la longueur et la position de chaque ligne restent en mémoire
+    string spill_filename = filename + ".rows.tmp";
+    ofstream spill;
+    vector<uint32_t> row_length;
+    if (!batches.contiguous) {
+        spill.open(spill_filename, ios::out | ios::binary | ios::trunc);
+        if (!spill.is_open()) {
+            cerr << "Impossible d'écrire le fichier temporaire '" << spill_filename << "'" << endl;
+            return;
+        }
+        row_length.assign(list_Node.size(), 0);
+    }
+    vector<uint32_t> *row_length_ptr = batches.contiguous ? nullptr : &row_length;
 
-        // Écriture dans le fichier
-        ostringstream path_stream;
-        path_stream << "[";
+    // Sources découpées en tranches consécutives, réparties entre les threads et écrites dans leur ordre
+    num_threads = resolve_num_threads(num_threads, batches.size());
+    size_t chunk_size = num_threads == 1 ? 1 : clamp<size_t>(batches.size() / (num_threads * 16), 1, 64);
+    size_t num_chunks = (batches.size() + chunk_size - 1) / chunk_size;
 
-        for (auto it = path.rbegin(); it != path.rend(); ++it) {
-            if (it != path.rbegin()) path_stream << ",";
-            path_stream << (*it + 1);
+    // Sources déjà réparties entre les threads : chaque recherche reste sur son thread (delta-stepping compris)
+    struct ExportWorker
+    {
+        ExportWorker() { scratch.engine_threads = 1; }
+        SearchScratch scratch;
+        vector<Vertex> goals, path;
+    };
+
+    write_chunks_in_order<ExportWorker>(batches.contiguous ? static_cast<ostream &>(file) : spill, num_chunks, num_threads,
+                                        [&](ExportWorker &w, size_t c, string &text) {
+        size_t last = min(batches.size(), (c + 1) * chunk_size);
+        for (size_t b = c * chunk_size; b < last; ++b) {
+            export_batch(g, list_Node, batches, b, w.scratch, w.goals, w.path, text, row_length_ptr, cache, numbering);
         }
-        path_stream << "]";
+    });
 
-        file << start << ";" << goal << ";" << distances[goal_idx] << ";" << path_stream.str() << "\n";
+    if (!batches.contiguous) {
+        spill.close();
+        copy_rows_in_order(file, spill_filename, list_Node, batches, row_length);
+        remove(spill_filename.c_str());
     }
 
     file.close();
     cout << "Fichier CSV '" << filename << "' généré avec succès." << endl;
 }
 
+void CSVOuptutFunction(Graph &g, const vector<pair<double, double>> &list_Node, const CoordinateStore &coord_list, const VertexNumbering &numbering, const string &filename, unsigned num_threads, ShortestPathTreeCache *cache) {
+    csv_output_impl(g, list_Node, numbering, filename, num_threads, cache);
+}
 
+void CSVOuptutFunction(CSRGraph &g, const vector<pair<double, double>> &list_Node, const CoordinateStore &coord_list, const VertexNumbering &numbering, const string &filename, unsigned num_threads, ShortestPathTreeCache *cache) {
+    csv_output_impl(g, list_Node, numbering, filename, num_threads, cache);
+}
 
-void calculate_and_write_paths(Graph &g, const vector<pair<double, double>> &list_Node, const vector<std::tuple<double, double, double>> &coord_list, const string &filename) {
+void CSVOuptutFunction(CompactGraph &g, const vector<pair<double, double>> &list_Node, const CoordinateStore &coord_list, const VertexNumbering &numbering, const string &filename, unsigned num_threads, ShortestPathTreeCache *cache) {
+    csv_output_impl(g, list_Node, numbering, filename, num_threads, cache);
+}
+
+
+
+template <class Export>
+static void timed_export(Export &&export_paths) {
     auto start_time = std::chrono::high_resolution_clock::now();
 
-    CSVOuptutFunction(g, list_Node, coord_list, filename);
+    {
+        ScopedTimer timer(Phase::Export);
+        export_paths();
+    }
 
     auto end_time = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsed_time = end_time - start_time;
@@ -155,82 +380,134 @@ void calculate_and_write_paths(Graph &g, const vector<pair<double, double>> &lis
     cout << "Time taken: " << elapsed_time.count() << " seconds" << endl;
 }
 
-bool isCyclicUtil(int v, bool visited[], bool *recStack, Graph &g) {
-    if (!visited[v]) {
-        visited[v] = true;
-        recStack[v] = true;
+void calculate_and_write_paths(Graph &g, const vector<pair<double, double>> &list_Node, const CoordinateStore &coord_list, const VertexNumbering &numbering, const string &filename, unsigned num_threads, ShortestPathTreeCache *cache) {
+    timed_export([&] { CSVOuptutFunction(g, list_Node, coord_list, numbering, filename, num_threads, cache); });
+}
 
-        for (auto [ai, ai_end] = adjacent_vertices(v, g); ai != ai_end; ++ai) {
-            if (!visited[*ai] && isCyclicUtil(*ai, visited, recStack, g)) {
-                return true;
-            } else if (recStack[*ai]) {
-                return true;
-            }
-        }
-    }
-    recStack[v] = false;
-    return false;
+void calculate_and_write_paths(CSRGraph &g, const vector<pair<double, double>> &list_Node, const CoordinateStore &coord_list, const VertexNumbering &numbering, const string &filename, unsigned num_threads, ShortestPathTreeCache *cache) {
+    timed_export([&] { CSVOuptutFunction(g, list_Node, coord_list, numbering, filename, num_threads, cache); });
+}
+
+void calculate_and_write_paths(CompactGraph &g, const vector<pair<double, double>> &list_Node, const CoordinateStore &coord_list, const VertexNumbering &numbering, const string &filename, unsigned num_threads, ShortestPathTreeCache *cache) {
+    timed_export([&] { CSVOuptutFunction(g, list_Node, coord_list, numbering, filename, num_threads, cache); });
 }
 
-void compute_graph(Graph &g, const vector<std::tuple<double, double, double>> &coord_list)
+void calculate_and_write_paths(const ContractionHierarchy &ch, const vector<pair<double, double>> &list_Node, const VertexNumbering &numbering, const string &filename, unsigned num_threads) {
+    timed_export([&] { CSVOuptutFunction(ch, list_Node, numbering, filename, num_threads); });
+}
+
+template <class G>
+static void compute_graph_impl(G &g, const CoordinateStore &coord_list, const ComputeOptions &options)
 {
-    int graphDegree = 0;
-    cout << "\n1. Node degree calculation :" << endl;
-    cout << "Node degree: {";
-    for (size_t i = 0; i < num_vertices(g); ++i)
-    {
-        cout << i + 1 << ":" << out_degree(i, g);
-        if(out_degree(i, g) > graphDegree)
-        {
-            graphDegree = out_degree(i, g);
-        }
-        if (i < num_vertices(g) - 1)
-        {
-            cout << ", ";
+    VertexNumbering file_numbering;
+    const VertexNumbering &numbering = options.numbering ? *options.numbering : file_numbering;
+
+    if (options.run_metrics) {
+        ScopedTimer timer(Phase::Metrics);
+
+        // Degrés, poids et composantes en un passage parallèle ; détail par sommet seulement sur demande
+        GraphMetrics metrics = compute_metrics(g, options.num_threads, options.per_vertex || !options.metrics_json.empty());
+
+        cout << "\n1. Node degree calculation :" << endl;
+        print_metrics_summary(cout, metrics);
+        if (options.per_vertex) {
+            print_vertex_degrees(cout, metrics, numbering);
         }
-    }
-    cout << "}" << endl;
 
-    cout << "\n2. Graph Degree Calculation: " << endl;
-    cout << "Graph degree: " << graphDegree << endl;
+        cout << "\n2. Graph Degree Calculation: " << endl;
+        cout << "Graph degree: " << metrics.max_degree << endl;
 
-    cout << "\n3. Graph Connectivity: " << endl;
-    vector<int> component(num_vertices(g));
-    int num = connected_components(g, &component[0]);
-    cout << "Graph is connected: ";
-    if(num == 1)
-    {
-        ;
-        cout << "True"<<endl;
+        cout << "\n3. Graph Connectivity: " << endl;
+        cout << "Graph is connected: " << (metrics.connected() ? "True" : "False") << endl;
+        if (!options.metrics_json.empty() && write_metrics_json(options.metrics_json, metrics, numbering)) {
+            cout << "Metrics written to '" << options.metrics_json << "'" << endl;
+        }
     }
-    else
-    {
-        cout << "False"<<endl;
+
+    if (options.run_cycles) {
+        ScopedTimer timer(Phase::Cycles);
+        cout << "\n4. Cycle Detection: " << endl;
+        // Arêtes non orientées (stockées dans les deux sens) : union-find sur un arc par arête, sans récursion,
+        // sauf si l'analyse a déjà été faite sur la liste d'arêtes au chargement
+        CycleAnalysis computed;
+        if (!options.cycles) {
+            computed = undirected_cycle_analysis(g);
+        }
+        const CycleAnalysis &cycles = options.cycles ? *options.cycles : computed;
+        auto file_vertex = [&](Vertex v) { return (options.cycles ? v : numbering.external(v)) + 1; };
+        cout << "Graph has cycle: " << (cycles.has_cycle ? "True" : "False") << endl;
+        if (cycles.has_cycle) {
+            cout << "Cycle witness: ";
+            for (Vertex v : cycles.cycle) {
+                cout << file_vertex(v) << " -> ";
+            }
+            cout << file_vertex(cycles.cycle.front()) << endl;
+        }
+        CycleAnalysis scc = directed_cycle_analysis(g);
+        cout << "Strongly connected components: " << scc.num_components << " (largest: " << scc.largest_component() << " vertices)" << endl;
     }
 
-    cout << "\n4. Cycle Detection: " << endl;
-    bool *visited = new bool[num_vertices(g)]();
-    bool *recStack = new bool[num_vertices(g)]();
-    bool cycle = false;
-    for (size_t i = 0; i < num_vertices(g); i++) {
-        if (!visited[i] && isCyclicUtil(i, visited, recStack, g)) {
-            cycle = true;
-            break;
+    if (!options.queries.empty()) {
+        ScopedTimer timer(Phase::SinglePath);
+        cout << "\n5. Shortest Path Calculation: " << endl;
+        for (const auto &[start, goal] : options.queries) {
+            if (!valid_pair(start, goal, num_vertices(g))) {
+                cerr << "Erreur : Indices de sommet invalides (" << start << ", " << goal << ")" << endl;
+                continue;
+            }
+            find_shortest_path_impl(g, coord_list, numbering.internal(start - 1) + 1, numbering.internal(goal - 1) + 1, options.query_mode, options.cache,
+                                    numbering);
         }
     }
-    cout << "Graph has cycle: " << (cycle ? "True" : "False") << endl;
-    delete[] visited;
-    delete[] recStack;
 
-    cout << "\n5. Shortest Path Calculation: " << endl;
-    find_shortest_path(g, 1, 6);
+    if (!options.run_export) {
+        return;
+    }
 
     cout << "\n8. CSV output function: " << endl;
-    vector<pair<double, double>> list_Node;
-    for (size_t i = 0; i < coord_list.size(); ++i) {
-        for (size_t j = i + 1; j < coord_list.size(); ++j) {
-            list_Node.push_back({i + 1, j + 1});
+    // Couples énumérés dans la numérotation des fichiers puis traduits en sommets internes : après une
+    // renumérotation, les lignes sont écrites dans le même ordre
+    vector<pair<double, double>> all_pairs, renumbered;
+    if (options.pairs.empty()) {
+        for (size_t i = 0; i < coord_list.size(); ++i) {
+            for (size_t j = i + 1; j < coord_list.size(); ++j) {
+                all_pairs.push_back({numbering.internal(i) + 1, numbering.internal(j) + 1});
+            }
         }
+    } else if (numbering.renumbered()) {
+        renumbered = numbering.internal_pairs(options.pairs, num_vertices(g));
+    }
+    const vector<pair<double, double>> &list_Node = options.pairs.empty() ? all_pairs : numbering.renumbered() ? renumbered : options.pairs;
+
+    if (options.format == ExportFormat::PathMatrix) {
+        // Un arbre par source au lieu d'une ligne de texte par couple : chemins reconstruits à la lecture
+        string filename = options.output.empty() ? "output_paths.bin" : options.output;
+        timed_export([&] { write_path_matrix(g, list_Node, numbering, filename, options.num_threads); });
+    } else if (options.ch) {
+        // Hiérarchie prétraitée : requêtes montantes bidirectionnelles au lieu d'un Dijkstra par source
+        calculate_and_write_paths(*options.ch, list_Node, numbering, options.output.empty() ? "output.csv" : options.output, options.num_threads);
+    } else {
+        calculate_and_write_paths(g, list_Node, coord_list, numbering, options.output.empty() ? "output.csv" : options.output, options.num_threads, options.cache);
+    }
+
+    if (options.cache) {
+        ShortestPathTreeCache &cache = *options.cache;
+        cout << "Shortest path tree cache: " << cache.hits() << " hits, " << cache.misses() << " misses, "
+             << cache.size() << " trees (" << cache.memory_used() / (1024 * 1024) << " MiB)" << endl;
     }
-    calculate_and_write_paths(g, list_Node, coord_list, "output.csv");
-}
\ No newline at end of file
+}
+
+void compute_graph(Graph &g, const CoordinateStore &coord_list)
+{
+    compute_graph_impl(g, coord_list, ComputeOptions());
+}
+
+void compute_graph(CSRGraph &g, const CoordinateStore &coord_list, const ComputeOptions &options)
+{
+    compute_graph_impl(g, coord_list, options);
+}
+
+void compute_graph(CompactGraph &g, const CoordinateStore &coord_list, const ComputeOptions &options)
+{
+    compute_graph_impl(g, coord_list, options);
+}
@@ -0,0 +1,402 @@
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <iterator>
+#include <filesystem>
+#include "graph_cache.h"
+#include "csv_loader.h"
+#include "cycle_analysis.h"
+#include "instrumentation.h"
+
+using namespace std;
+using namespace boost;
+
+namespace fs = std::filesystem;
+
+static const char GRAPH_CACHE_MAGIC[8] = {'G', 'R', 'A', 'P', 'H', 'B', 'I', 'N'};
+
+static size_t align8(size_t bytes)
+{
+    return (bytes + 7) & ~size_t(7);
+}
+
+namespace {
+
+/**
+ * @brief parcours des arcs (source, cible) d'un tableau CSR, pour le constructeur edges_are_sorted de Boost
+ */
+class ArcIterator
+{
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = pair<uint32_t, uint32_t>;
+    using difference_type = ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = const value_type &;
+
+    ArcIterator(const uint64_t *offsets, const uint32_t *targets, uint64_t num_vertices, uint64_t arc)
+        : offsets(offsets), targets(targets), num_vertices(num_vertices), arc(arc)
+    {
+        update();
+    }
+
+    reference operator*() const { return current; }
+    pointer operator->() const { return &current; }
+    ArcIterator &operator++() { ++arc; update(); return *this; }
+    bool operator==(const ArcIterator &other) const { return arc == other.arc; }
+    bool operator!=(const ArcIterator &other) const { return arc != other.arc; }
+
+private:
+    void update()
+    {
+        while (source < num_vertices && offsets[source + 1] <= arc) {
+            ++source;
+        }
+        if (source < num_vertices) {
+            current = {static_cast<uint32_t>(source), targets[arc]};
+        }
+    }
+
+    const uint64_t *offsets;
+    const uint32_t *targets;
+    uint64_t num_vertices;
+    uint64_t arc;
+    uint64_t source = 0;
+    value_type current;
+};
+
+int64_t file_mtime(const fs::path &path, error_code &ec)
+{
+    auto time = fs::last_write_time(path, ec);
+    return static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+/**
+ * @brief vérification des tableaux projetés avant la construction du graph : décalages croissants de 0 à m
+ * et cibles inférieures à n, en un seul passage
+ */
+bool arrays_consistent(uint64_t n, uint64_t m, const uint64_t *offsets, const uint32_t *targets)
+{
+    if (offsets[0] != 0 || offsets[n] != m) {
+        return false;
+    }
+    for (uint64_t u = 0; u < n; ++u) {
+        if (offsets[u + 1] < offsets[u] || offsets[u + 1] > m) {
+            return false;
+        }
+        for (uint64_t k = offsets[u]; k < offsets[u + 1]; ++k) {
+            if (targets[k] >= n) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Construction du graph à partir des tableaux projetés du cache
+bool build_from_arrays(uint64_t n, uint64_t m, const uint64_t *offsets, const uint32_t *targets, const float *weights, CSRGraph &g)
+{
+    // Copie linéaire des tableaux projetés dans le graph CSR, stockage réservé en une fois
+    g = CSRGraph(edges_are_sorted,
+                 ArcIterator(offsets, targets, n, 0), ArcIterator(offsets, targets, n, m),
+                 weights, n, m);
+    return true;
+}
+
+bool build_from_arrays(uint64_t n, uint64_t, const uint64_t *offsets, const uint32_t *targets, const float *weights, CompactGraph &g)
+{
+    return build_compact(n, offsets, targets, weights, g);
+}
+
+// Construction du graph à partir des arêtes analysées dans les CSV
+bool build_from_edges(size_t n, const vector<pair<int, int>> &edge_list, const vector<float> &weights, CSRGraph &g)
+{
+    g = build_csr(n, edge_list, weights);
+    return true;
+}
+
+bool build_from_edges(size_t n, const vector<pair<int, int>> &edge_list, const vector<float> &weights, CompactGraph &g)
+{
+    if (edge_list.size() > UINT32_MAX) {
+        cerr << "Trop d'arêtes pour la représentation compacte (" << edge_list.size() << ")" << endl;
+        return false;
+    }
+    g = build_compact(n, edge_list, weights);
+    return true;
+}
+
+} // namespace
+
+GraphCacheKey make_cache_key(const string &filename_nodes, const string &filename_edges)
+{
+    GraphCacheKey key;
+    error_code ec_size_n, ec_size_e, ec_time_n, ec_time_e;
+    key.nodes_size = fs::file_size(filename_nodes, ec_size_n);
+    key.nodes_mtime = file_mtime(filename_nodes, ec_time_n);
+    key.edges_size = fs::file_size(filename_edges, ec_size_e);
+    key.edges_mtime = file_mtime(filename_edges, ec_time_e);
+    key.valid = !ec_size_n && !ec_size_e && !ec_time_n && !ec_time_e;
+    return key;
+}
+
+template <typename G>
+static bool load_graph_cache_impl(const string &filename, const GraphCacheKey &key, CoordinateStore &coord_list, G &g)
+{
+    ScopedTimer timer(Phase::CacheLoad);
+    if (!key.valid) {
+        return false;
+    }
+
+    MappedFile file(filename);
+    if (!file.is_open() || file.size() < sizeof(GraphCacheHeader)) {
+        return false;
+    }
+
+    GraphCacheHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, GRAPH_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != GRAPH_CACHE_VERSION || header.header_size != sizeof(GraphCacheHeader)) {
+        cout << "Cache '" << filename << "' d'un format différent, relecture des fichiers CSV" << endl;
+        return false;
+    }
+
+    GraphCacheKey stored;
+    stored.nodes_size = header.nodes_size;
+    stored.nodes_mtime = header.nodes_mtime;
+    stored.edges_size = header.edges_size;
+    stored.edges_mtime = header.edges_mtime;
+    stored.weight_precision = header.weight_precision;
+    if (!(stored == key)) {
+        cout << "Cache '" << filename << "' périmé, relecture des fichiers CSV" << endl;
+        return false;
+    }
+
+    // Tailles bornées par celle du fichier avant tout calcul de position (pas de débordement des produits)
+    uint64_t n = header.num_vertices, m = header.num_arcs;
+    if (n > UINT32_MAX || n > file.size() / (3 * sizeof(double) + sizeof(uint64_t)) ||
+        m > file.size() / (sizeof(uint32_t) + sizeof(float))) {
+        cerr << "Cache '" << filename << "' tronqué ou corrompu, relecture des fichiers CSV" << endl;
+        return false;
+    }
+    size_t coords_offset = align8(sizeof(GraphCacheHeader));
+    size_t offsets_offset = coords_offset + align8(3 * n * sizeof(double));
+    size_t targets_offset = offsets_offset + align8((n + 1) * sizeof(uint64_t));
+    size_t weights_offset = targets_offset + align8(m * sizeof(uint32_t));
+    size_t total = weights_offset + align8(m * sizeof(float));
+    if (file.size() != total) {
+        cerr << "Cache '" << filename << "' tronqué ou corrompu, relecture des fichiers CSV" << endl;
+        return false;
+    }
+
+    const double *coords = reinterpret_cast<const double *>(file.data() + coords_offset);
+    const uint64_t *offsets = reinterpret_cast<const uint64_t *>(file.data() + offsets_offset);
+    const uint32_t *targets = reinterpret_cast<const uint32_t *>(file.data() + targets_offset);
+    const float *weights = reinterpret_cast<const float *>(file.data() + weights_offset);
+
+    if (!arrays_consistent(n, m, offsets, targets)) {
+        cerr << "Cache '" << filename << "' incohérent, relecture des fichiers CSV" << endl;
+        return false;
+    }
+
+    coord_list.resize(n);
+    memcpy(coord_list.x_data(), coords, n * sizeof(double));
+    memcpy(coord_list.y_data(), coords + n, n * sizeof(double));
+    memcpy(coord_list.z_data(), coords + 2 * n, n * sizeof(double));
+
+    return build_from_arrays(n, m, offsets, targets, weights, g);
+}
+
+bool load_graph_cache(const string &filename, const GraphCacheKey &key, CoordinateStore &coord_list, CSRGraph &g)
+{
+    return load_graph_cache_impl(filename, key, coord_list, g);
+}
+
+bool load_graph_cache(const string &filename, const GraphCacheKey &key, CoordinateStore &coord_list, CompactGraph &g)
+{
+    return load_graph_cache_impl(filename, key, coord_list, g);
+}
+
+template <typename G>
+static bool save_graph_cache_impl(const string &filename, const GraphCacheKey &key, const CoordinateStore &coord_list, const G &g)
+{
+    ScopedTimer timer(Phase::CacheSave);
+    if (!key.valid) {
+        return false;
+    }
+
+    string tmp_filename = filename + ".tmp";
+    ofstream file(tmp_filename, ios::out | ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        cerr << "Impossible d'écrire le cache '" << filename << "'" << endl;
+        return false;
+    }
+
+    // num_edges compte les arcs (deux par arête) pour les deux graphs : même fichier pour l'un et l'autre
+    uint64_t n = num_vertices(g), m = num_edges(g);
+
+    GraphCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, GRAPH_CACHE_MAGIC, sizeof(header.magic));
+    header.version = GRAPH_CACHE_VERSION;
+    header.header_size = sizeof(GraphCacheHeader);
+    header.nodes_size = key.nodes_size;
+    header.nodes_mtime = key.nodes_mtime;
+    header.edges_size = key.edges_size;
+    header.edges_mtime = key.edges_mtime;
+    header.num_vertices = n;
+    header.num_arcs = m;
+    header.weight_precision = key.weight_precision;
+
+    const char padding[8] = {};
+    auto pad = [&](size_t bytes) { file.write(padding, align8(bytes) - bytes); };
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    pad(sizeof(header));
+
+    file.write(reinterpret_cast<const char *>(coord_list.x_data()), n * sizeof(double));
+    file.write(reinterpret_cast<const char *>(coord_list.y_data()), n * sizeof(double));
+    file.write(reinterpret_cast<const char *>(coord_list.z_data()), n * sizeof(double));
+    pad(3 * n * sizeof(double));
+
+    // Écriture par blocs pour limiter la mémoire temporaire
+    const size_t BLOCK = 1 << 16;
+    vector<uint64_t> offsets;
+    offsets.reserve(BLOCK);
+    uint64_t arc = 0;
+    offsets.push_back(0);
+    for (uint32_t u = 0; u < n; ++u) {
+        arc += out_degree(u, g);
+        offsets.push_back(arc);
+        if (offsets.size() == BLOCK) {
+            file.write(reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(uint64_t));
+            offsets.clear();
+        }
+    }
+    file.write(reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    pad((n + 1) * sizeof(uint64_t));
+
+    vector<uint32_t> targets;
+    vector<float> weights;
+    targets.reserve(BLOCK);
+    weights.reserve(BLOCK);
+    auto weight = get(edge_weight, g);
+    auto flush_targets = [&]() {
+        file.write(reinterpret_cast<const char *>(targets.data()), targets.size() * sizeof(uint32_t));
+        targets.clear();
+    };
+    for (uint32_t u = 0; u < n; ++u) {
+        for (auto [ei, ei_end] = out_edges(u, g); ei != ei_end; ++ei) {
+            targets.push_back(target(*ei, g));
+            if (targets.size() == BLOCK) flush_targets();
+        }
+    }
+    flush_targets();
+    pad(m * sizeof(uint32_t));
+
+    auto flush_weights = [&]() {
+        file.write(reinterpret_cast<const char *>(weights.data()), weights.size() * sizeof(float));
+        weights.clear();
+    };
+    for (uint32_t u = 0; u < n; ++u) {
+        for (auto [ei, ei_end] = out_edges(u, g); ei != ei_end; ++ei) {
+            weights.push_back(get(weight, *ei));
+            if (weights.size() == BLOCK) flush_weights();
+        }
+    }
+    flush_weights();
+    pad(m * sizeof(float));
+
+    file.close();
+    if (!file) {
+        cerr << "Impossible d'écrire le cache '" << filename << "'" << endl;
+        fs::remove(tmp_filename);
+        return false;
+    }
+
+    error_code ec;
+    fs::rename(tmp_filename, filename, ec);
+    if (ec) {
+        cerr << "Impossible d'écrire le cache '" << filename << "' : " << ec.message() << endl;
+        fs::remove(tmp_filename, ec);
+        return false;
+    }
+    return true;
+}
+
+bool save_graph_cache(const string &filename, const GraphCacheKey &key, const CoordinateStore &coord_list, const CSRGraph &g)
+{
+    return save_graph_cache_impl(filename, key, coord_list, g);
+}
+
+bool save_graph_cache(const string &filename, const GraphCacheKey &key, const CoordinateStore &coord_list, const CompactGraph &g)
+{
+    return save_graph_cache_impl(filename, key, coord_list, g);
+}
+
+template <typename G>
+static bool load_graph_impl(const string &filename_nodes, const string &filename_edges, const string &filename_cache,
+                            CoordinateStore &coord_list, G &g, GraphCacheKey &key, unsigned num_threads,
+                            WeightPrecision precision, CycleAnalysis *cycles)
+{
+    // Cache binaire valide (même taille et même date que les CSV) : graph utilisable sans analyse
+    key = make_cache_key(filename_nodes, filename_edges);
+    key.weight_precision = static_cast<uint32_t>(precision);
+    if (!filename_cache.empty() && load_graph_cache(filename_cache, key, coord_list, g)) {
+        if (cycles) {
+            ScopedTimer timer(Phase::Cycles);
+            *cycles = undirected_cycle_analysis(g);
+        }
+        return true;
+    }
+
+    // Fichiers projetés en mémoire et analysés sur place, par tranches parallèles
+    CSVLoadResult nodes_result = load_nodes_csv(filename_nodes, coord_list, num_threads);
+    report_csv_errors(filename_nodes, nodes_result);
+
+    vector<pair<int, int>> edge_list;
+    CSVLoadResult edges_result = load_edges_csv(filename_edges, edge_list, coord_list.size(), num_threads);
+    report_csv_errors(filename_edges, edges_result);
+
+    if (!nodes_result.ok() || !edges_result.ok()) {
+        cerr << "Chargement du graph impossible" << endl;
+        return false;
+    }
+
+    // Union-find sur les arêtes analysées, avant la construction du graph
+    if (cycles) {
+        ScopedTimer timer(Phase::Cycles);
+        *cycles = undirected_cycle_analysis(coord_list.size(), edge_list);
+    }
+
+    vector<float> weights;
+    {
+        ScopedTimer timer(Phase::Weights);
+        compute_edge_weights(coord_list, edge_list, weights, precision, num_threads);
+    }
+
+    // Graph figé, construit une seule fois : un arc par sens pour chaque arête non orientée (CSR) ou chaque
+    // arête stockée une fois (compact)
+    if (!build_from_edges(coord_list.size(), edge_list, weights, g)) {
+        cerr << "Chargement du graph impossible" << endl;
+        return false;
+    }
+
+    if (!filename_cache.empty()) {
+        save_graph_cache(filename_cache, key, coord_list, g);
+    }
+    return true;
+}
+
+bool load_graph(const string &filename_nodes, const string &filename_edges, const string &filename_cache,
+                CoordinateStore &coord_list, CSRGraph &g, GraphCacheKey &key, unsigned num_threads,
+                WeightPrecision precision, CycleAnalysis *cycles)
+{
+    return load_graph_impl(filename_nodes, filename_edges, filename_cache, coord_list, g, key, num_threads, precision, cycles);
+}
+
+bool load_graph(const string &filename_nodes, const string &filename_edges, const string &filename_cache,
+                CoordinateStore &coord_list, CompactGraph &g, GraphCacheKey &key, unsigned num_threads,
+                WeightPrecision precision, CycleAnalysis *cycles)
+{
+    return load_graph_impl(filename_nodes, filename_edges, filename_cache, coord_list, g, key, num_threads, precision, cycles);
+}
@@ -0,0 +1,298 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cmath>
+#include <limits>
+#include "graph_metrics.h"
+#include "ordered_writer.h"
+#include "vertex_order.h"
+
+using namespace std;
+using namespace boost;
+
+/**
+ * @brief découpage de [0, n) en num_threads plages contiguës traitées en parallèle, f(t, begin, end)
+ */
+template <class F>
+static void parallel_ranges(size_t n, unsigned num_threads, F &&f)
+{
+    if (num_threads <= 1) {
+        f(0u, size_t(0), n);
+        return;
+    }
+    vector<thread> pool;
+    for (unsigned t = 0; t < num_threads; ++t) {
+        size_t begin = n * t / num_threads, end = n * (t + 1) / num_threads;
+        pool.emplace_back([&f, t, begin, end] { f(t, begin, end); });
+    }
+    for (auto &th : pool) {
+        th.join();
+    }
+}
+
+/**
+ * @brief racine de v, avec compression de chemin par division (écritures concurrentes sans effet sur la correction)
+ */
+static uint32_t concurrent_find(vector<atomic<uint32_t>> &parent, uint32_t v)
+{
+    for (;;) {
+        uint32_t p = parent[v].load(memory_order_relaxed);
+        if (p == v) {
+            return v;
+        }
+        uint32_t gp = parent[p].load(memory_order_relaxed);
+        if (gp != p) {
+            parent[v].compare_exchange_weak(p, gp, memory_order_relaxed);
+        }
+        v = gp;
+    }
+}
+
+static void concurrent_unite(vector<atomic<uint32_t>> &parent, uint32_t a, uint32_t b)
+{
+    for (;;) {
+        a = concurrent_find(parent, a);
+        b = concurrent_find(parent, b);
+        if (a == b) {
+            return;
+        }
+        // Lien de la plus grande racine vers la plus petite : aucun cycle possible entre liens concurrents
+        if (a < b) {
+            swap(a, b);
+        }
+        uint32_t expected = a;
+        if (parent[a].compare_exchange_strong(expected, b, memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+template <class G>
+static GraphMetrics compute_metrics_impl(const G &g, unsigned num_threads, bool keep_degrees)
+{
+    using VertexG = typename graph_traits<G>::vertex_descriptor;
+
+    struct Partial
+    {
+        size_t min_degree = numeric_limits<size_t>::max();
+        size_t max_degree = 0;
+        size_t isolated = 0;
+        size_t arcs = 0;
+        double sum_sq = 0;
+        double min_weight = numeric_limits<double>::max();
+        double max_weight = 0;
+        double sum_weight = 0;
+        vector<size_t> histogram;
+    };
+
+    GraphMetrics metrics;
+    size_t n = num_vertices(g);
+    metrics.num_vertices = n;
+    if (n == 0) {
+        return metrics;
+    }
+
+    num_threads = resolve_num_threads(num_threads, n);
+    vector<Partial> partials(num_threads);
+    if (keep_degrees) {
+        metrics.degrees.resize(n);
+    }
+
+    vector<atomic<uint32_t>> parent(n);
+    vector<atomic<uint32_t>> sizes(n);
+    auto weight = get(edge_weight, g);
+
+    parallel_ranges(n, num_threads, [&](unsigned t, size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            parent[v].store(static_cast<uint32_t>(v), memory_order_relaxed);
+            sizes[v].store(0, memory_order_relaxed);
+        }
+    });
+
+    // Premier passage : degrés, poids et unions (tous les arcs, composantes faiblement connexes si le graph est orienté)
+    parallel_ranges(n, num_threads, [&](unsigned t, size_t begin, size_t end) {
+        Partial &p = partials[t];
+        for (size_t u = begin; u < end; ++u) {
+            size_t degree = 0;
+            for (auto [ei, ei_end] = out_edges(static_cast<VertexG>(u), g); ei != ei_end; ++ei) {
+                size_t v = target(*ei, g);
+                double w = get(weight, *ei);
+                p.min_weight = min(p.min_weight, w);
+                p.max_weight = max(p.max_weight, w);
+                p.sum_weight += w;
+                degree++;
+                if (u != v) {
+                    concurrent_unite(parent, static_cast<uint32_t>(u), static_cast<uint32_t>(v));
+                }
+            }
+
+            p.arcs += degree;
+            p.min_degree = min(p.min_degree, degree);
+            p.max_degree = max(p.max_degree, degree);
+            p.sum_sq += double(degree) * degree;
+            p.isolated += degree == 0;
+            if (p.histogram.size() <= degree) {
+                p.histogram.resize(degree + 1, 0);
+            }
+            p.histogram[degree]++;
+            if (keep_degrees) {
+                metrics.degrees[u] = static_cast<uint32_t>(degree);
+            }
+        }
+    });
+
+    // Second passage : taille des composantes, comptée sur leur racine
+    parallel_ranges(n, num_threads, [&](unsigned t, size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            sizes[concurrent_find(parent, static_cast<uint32_t>(v))].fetch_add(1, memory_order_relaxed);
+        }
+    });
+
+    vector<vector<size_t>> partial_sizes(num_threads);
+    parallel_ranges(n, num_threads, [&](unsigned t, size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            if (parent[v].load(memory_order_relaxed) == v) {
+                partial_sizes[t].push_back(sizes[v].load(memory_order_relaxed));
+            }
+        }
+    });
+
+    // Fusion des résultats partiels
+    metrics.min_degree = numeric_limits<size_t>::max();
+    metrics.min_weight = numeric_limits<double>::max();
+    double sum_sq = 0, sum_weight = 0;
+    for (const Partial &p : partials) {
+        metrics.num_arcs += p.arcs;
+        metrics.min_degree = min(metrics.min_degree, p.min_degree);
+        metrics.max_degree = max(metrics.max_degree, p.max_degree);
+        metrics.isolated_vertices += p.isolated;
+        metrics.min_weight = min(metrics.min_weight, p.min_weight);
+        metrics.max_weight = max(metrics.max_weight, p.max_weight);
+        sum_sq += p.sum_sq;
+        sum_weight += p.sum_weight;
+        if (metrics.degree_histogram.size() < p.histogram.size()) {
+            metrics.degree_histogram.resize(p.histogram.size(), 0);
+        }
+        for (size_t d = 0; d < p.histogram.size(); ++d) {
+            metrics.degree_histogram[d] += p.histogram[d];
+        }
+    }
+    if (metrics.num_arcs == 0) {
+        metrics.min_weight = 0;
+    }
+
+    metrics.mean_degree = double(metrics.num_arcs) / n;
+    metrics.degree_stddev = sqrt(max(0.0, sum_sq / n - metrics.mean_degree * metrics.mean_degree));
+    metrics.mean_weight = metrics.num_arcs ? sum_weight / metrics.num_arcs : 0;
+
+    size_t cumulated = 0;
+    for (size_t d = 0; d < metrics.degree_histogram.size(); ++d) {
+        cumulated += metrics.degree_histogram[d];
+        if (2 * cumulated >= n) {
+            metrics.median_degree = d;
+            break;
+        }
+    }
+
+    for (const auto &part : partial_sizes) {
+        metrics.component_sizes.insert(metrics.component_sizes.end(), part.begin(), part.end());
+    }
+    sort(metrics.component_sizes.begin(), metrics.component_sizes.end(), greater<size_t>());
+    metrics.num_components = metrics.component_sizes.size();
+    return metrics;
+}
+
+GraphMetrics compute_metrics(const Graph &g, unsigned num_threads, bool keep_degrees)
+{
+    return compute_metrics_impl(g, num_threads, keep_degrees);
+}
+
+GraphMetrics compute_metrics(const CSRGraph &g, unsigned num_threads, bool keep_degrees)
+{
+    return compute_metrics_impl(g, num_threads, keep_degrees);
+}
+
+GraphMetrics compute_metrics(const CompactGraph &g, unsigned num_threads, bool keep_degrees)
+{
+    return compute_metrics_impl(g, num_threads, keep_degrees);
+}
+
+void print_metrics_summary(ostream &out, const GraphMetrics &metrics)
+{
+    out << "Vertices: " << metrics.num_vertices << ", arcs: " << metrics.num_arcs << "\n";
+    out << "Degree: min " << metrics.min_degree << ", max " << metrics.max_degree << ", mean " << metrics.mean_degree
+        << ", median " << metrics.median_degree << ", stddev " << metrics.degree_stddev
+        << ", isolated vertices " << metrics.isolated_vertices << "\n";
+    out << "Arc weight: min " << metrics.min_weight << ", max " << metrics.max_weight << ", mean " << metrics.mean_weight << "\n";
+    out << "Connected components: " << metrics.num_components;
+    if (!metrics.component_sizes.empty()) {
+        out << " (largest: " << metrics.component_sizes.front() << " vertices, smallest: " << metrics.component_sizes.back() << " vertices)";
+    }
+    out << endl;
+}
+
+void print_vertex_degrees(ostream &out, const GraphMetrics &metrics, const VertexNumbering &numbering)
+{
+    string text = "Node degree: {";
+    for (size_t i = 0; i < metrics.degrees.size(); ++i) {
+        if (i > 0) text += ", ";
+        text += to_string(i + 1);
+        text += ':';
+        text += to_string(metrics.degrees[numbering.internal(i)]);
+    }
+    text += "}\n";
+    out << text << flush;
+}
+
+bool write_metrics_json(const string &filename, const GraphMetrics &metrics, const VertexNumbering &numbering)
+{
+    ofstream file(filename, ios::out | ios::trunc);
+    if (!file.is_open()) {
+        cerr << "Impossible d'ouvrir le fichier '" << filename << "'" << endl;
+        return false;
+    }
+
+    auto write_array = [&](const auto &values) {
+        file << "[";
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i > 0) file << ",";
+            file << values[i];
+        }
+        file << "]";
+    };
+
+    file << "{\n";
+    file << "  \"num_vertices\": " << metrics.num_vertices << ",\n";
+    file << "  \"num_arcs\": " << metrics.num_arcs << ",\n";
+    file << "  \"degree\": {\"min\": " << metrics.min_degree << ", \"max\": " << metrics.max_degree
+         << ", \"mean\": " << metrics.mean_degree << ", \"median\": " << metrics.median_degree
+         << ", \"stddev\": " << metrics.degree_stddev << ", \"isolated\": " << metrics.isolated_vertices << "},\n";
+    file << "  \"degree_histogram\": ";
+    write_array(metrics.degree_histogram);
+    file << ",\n";
+    file << "  \"weight\": {\"min\": " << metrics.min_weight << ", \"max\": " << metrics.max_weight
+         << ", \"mean\": " << metrics.mean_weight << "},\n";
+    file << "  \"connected\": " << (metrics.connected() ? "true" : "false") << ",\n";
+    file << "  \"num_components\": " << metrics.num_components << ",\n";
+    file << "  \"component_sizes\": ";
+    write_array(metrics.component_sizes);
+    if (!metrics.degrees.empty()) {
+        // Degrés dans l'ordre des sommets des fichiers
+        file << ",\n  \"vertex_degrees\": [";
+        for (size_t i = 0; i < metrics.degrees.size(); ++i) {
+            if (i > 0) file << ",";
+            file << metrics.degrees[numbering.internal(i)];
+        }
+        file << "]";
+    }
+    file << "\n}\n";
+
+    file.close();
+    if (!file) {
+        cerr << "Erreur d'écriture du fichier '" << filename << "'" << endl;
+        return false;
+    }
+    return true;
+}
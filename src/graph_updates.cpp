@@ -0,0 +1,1141 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <numeric>
+#include <charconv>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <atomic>
+#include <thread>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+#include "graph_updates.h"
+#include "path_search.h"
+#include "ordered_writer.h"
+#include "vertex_order.h"
+#include "instrumentation.h"
+
+using namespace std;
+using namespace boost;
+namespace fs = std::filesystem;
+
+namespace {
+
+const double INF = numeric_limits<double>::max();
+const uint32_t NONE = numeric_limits<uint32_t>::max();
+
+using CSRVertex = graph_traits<CSRGraph>::vertex_descriptor;
+
+uint64_t pair_key(Vertex u, Vertex v)
+{
+    if (u > v) {
+        swap(u, v);
+    }
+    return (uint64_t(u) << 32) | uint64_t(v);
+}
+
+/**
+ * @brief poids effectif de la paire (u, v) : le plus petit des arcs u -> v, INF s'il n'y en a aucun
+ */
+double arc_weight(const CSRGraph &g, Vertex u, Vertex v)
+{
+    auto weight = get(edge_weight, g);
+    double best = INF;
+    for (auto [ei, ei_end] = out_edges(static_cast<CSRVertex>(u), g); ei != ei_end; ++ei) {
+        if (target(*ei, g) == v) {
+            best = min(best, double(get(weight, *ei)));
+        }
+    }
+    return best;
+}
+
+double effective_weight(const vector<float> &weights)
+{
+    return weights.empty() ? INF : double(*min_element(weights.begin(), weights.end()));
+}
+
+/**
+ * @brief champ entier suivi de ';' ou de la fin de ligne, identifiant des fichiers traduit en sommet interne
+ */
+bool parse_vertex(const char *&p, const char *end, size_t n, const VertexNumbering &numbering, Vertex &v, string &error)
+{
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    uint64_t id = 0;
+    auto [ptr, ec] = from_chars(p, end, id);
+    if (ec != errc() || ptr == p) {
+        error = "identifiant de sommet invalide : '" + string(p, find(p, end, ';')) + "'";
+        return false;
+    }
+    if (id < 1 || id > n) {
+        error = "sommet " + to_string(id) + " hors de 1.." + to_string(n);
+        return false;
+    }
+    v = numbering.internal(static_cast<Vertex>(id - 1));
+    p = ptr;
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+    return true;
+}
+
+/**
+ * @brief arbre concerné par le lot : un de ses arcs est allongé ou fermé, ou un arc raccourci ou ouvert l'améliore
+ */
+bool tree_affected(const vector<ArcChange> &changes, const ShortestPathTree &tree)
+{
+    const auto &dist = tree.distances;
+    const auto &pred = tree.predecessors;
+    for (const ArcChange &c : changes) {
+        if (!c.weight_changed()) {
+            continue;
+        }
+        for (int side = 0; side < 2; ++side) {
+            Vertex a = side ? c.v : c.u, b = side ? c.u : c.v;
+            if (c.new_weight > c.old_weight) {
+                if (b != tree.source && pred[b] == a && dist[b] != INF) {
+                    return true;
+                }
+            } else if (dist[a] != INF && dist[a] + c.new_weight < dist[b]) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+CSVLoadResult load_edge_updates(const string &filename, const CoordinateStore &coord_list, const VertexNumbering &numbering, vector<EdgeUpdate> &updates)
+{
+    CSVLoadResult result;
+    updates.clear();
+    MappedFile file(filename);
+    if (!file.is_open()) {
+        cerr << "Ouverture du fichier impossible : " << filename << endl;
+        return result;
+    }
+    result.opened = true;
+
+    size_t n = coord_list.size();
+    const char *begin = file.data();
+    const char *end = begin + file.size();
+    size_t line = 0;
+
+    auto fail = [&](const string &message) {
+        if (result.errors.size() < CSVLoadResult::MAX_REPORTED) {
+            result.errors.push_back({line, message});
+        }
+        result.malformed++;
+    };
+
+    while (begin < end) {
+        const char *nl = static_cast<const char *>(memchr(begin, '\n', end - begin));
+        const char *p = begin, *line_end = nl ? nl : end;
+        begin = nl ? nl + 1 : end;
+        if (++line == 1) {
+            continue;
+        }
+        while (p < line_end && (*p == ' ' || *p == '\t')) ++p;
+        if (p == line_end || *p == '\r') {
+            continue;
+        }
+
+        // Opération
+        const char *op_end = find(p, line_end, ';');
+        string op(p, op_end);
+        while (!op.empty() && (op.back() == ' ' || op.back() == '\t')) op.pop_back();
+        EdgeUpdate update;
+        update.line = line;
+        if (op == "insert") update.kind = EdgeUpdateKind::Insert;
+        else if (op == "delete") update.kind = EdgeUpdateKind::Delete;
+        else if (op == "reweight") update.kind = EdgeUpdateKind::Reweight;
+        else {
+            fail("opération inconnue : '" + op + "' (insert, delete ou reweight)");
+            continue;
+        }
+        if (op_end == line_end) {
+            fail("séparateur ';' attendu");
+            continue;
+        }
+        p = op_end + 1;
+
+        // Extrémités
+        string error;
+        if (!parse_vertex(p, line_end, n, numbering, update.u, error)) {
+            fail(error);
+            continue;
+        }
+        if (p >= line_end || *p != ';') {
+            fail("séparateur ';' attendu");
+            continue;
+        }
+        ++p;
+        if (!parse_vertex(p, line_end, n, numbering, update.v, error)) {
+            fail(error);
+            continue;
+        }
+        if (update.u == update.v) {
+            fail("boucle sur le sommet " + to_string(numbering.external(update.u) + 1));
+            continue;
+        }
+
+        // Poids éventuel
+        bool has_weight = false;
+        if (p < line_end && *p == ';') {
+            ++p;
+            while (p < line_end && (*p == ' ' || *p == '\t')) ++p;
+            if (p < line_end && *p != '\r') {
+                auto [ptr, ec] = from_chars(p, line_end, update.weight);
+                if (ec != errc() || ptr == p || !isfinite(update.weight)) {
+                    fail("poids invalide : '" + string(p, line_end) + "'");
+                    continue;
+                }
+                has_weight = true;
+                p = ptr;
+            }
+        }
+        while (p < line_end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+        if (p < line_end) {
+            fail("caractères inattendus après la dernière valeur");
+            continue;
+        }
+
+        double distance = calcul_distance(update.u, update.v, coord_list);
+        if (update.kind == EdgeUpdateKind::Delete) {
+            update.weight = 0;
+        } else if (!has_weight) {
+            if (update.kind == EdgeUpdateKind::Reweight) {
+                fail("poids manquant pour reweight");
+                continue;
+            }
+            update.weight = distance;
+        } else if (static_cast<float>(update.weight) < static_cast<float>(distance)) {
+            fail("poids " + to_string(update.weight) + " inférieur à la distance euclidienne " + to_string(distance));
+            continue;
+        }
+
+        updates.push_back(update);
+        result.records++;
+    }
+    return result;
+}
+
+vector<ArcChange> apply_edge_updates(CSRGraph &g, const vector<EdgeUpdate> &updates, const VertexNumbering &numbering)
+{
+    ScopedTimer timer(Phase::Update);
+    size_t n = num_vertices(g);
+    auto weight = get(edge_weight, g);
+
+    // Poids des arêtes parallèles de chaque paire touchée, avant le lot et au fil du lot
+    struct PairState
+    {
+        Vertex u, v;
+        vector<float> before, after;
+    };
+    vector<PairState> pairs;
+    std::unordered_map<uint64_t, size_t> index;
+
+    for (const EdgeUpdate &update : updates) {
+        auto [it, inserted] = index.emplace(pair_key(update.u, update.v), pairs.size());
+        if (inserted) {
+            PairState state{min(update.u, update.v), max(update.u, update.v), {}, {}};
+            for (auto [ei, ei_end] = out_edges(static_cast<CSRVertex>(state.u), g); ei != ei_end; ++ei) {
+                if (target(*ei, g) == state.v) {
+                    state.before.push_back(get(weight, *ei));
+                }
+            }
+            state.after = state.before;
+            pairs.push_back(std::move(state));
+        }
+        PairState &state = pairs[it->second];
+
+        if (update.kind == EdgeUpdateKind::Insert) {
+            state.after.push_back(static_cast<float>(update.weight));
+        } else if (state.after.empty()) {
+            cerr << "Arête " << numbering.external(update.u) + 1 << "-" << numbering.external(update.v) + 1 << " absente (ligne " << update.line << "), modification ignorée" << endl;
+        } else if (update.kind == EdgeUpdateKind::Delete) {
+            state.after.clear();
+        } else {
+            fill(state.after.begin(), state.after.end(), static_cast<float>(update.weight));
+        }
+    }
+
+    vector<ArcChange> changes;
+    vector<const PairState *> changed;
+    bool rebuild = false;
+    for (const PairState &state : pairs) {
+        if (state.before == state.after) {
+            continue;
+        }
+        ArcChange change;
+        change.u = state.u;
+        change.v = state.v;
+        change.old_weight = effective_weight(state.before);
+        change.new_weight = effective_weight(state.after);
+        change.old_count = static_cast<uint32_t>(state.before.size());
+        change.new_count = static_cast<uint32_t>(state.after.size());
+        rebuild |= change.old_count != change.new_count;
+        changes.push_back(change);
+        changed.push_back(&state);
+    }
+
+    if (!rebuild) {
+        // Même nombre d'arcs : poids écrits en place, dans le même ordre dans les deux sens
+        for (const PairState *state : changed) {
+            for (int side = 0; side < 2; ++side) {
+                Vertex a = side ? state->v : state->u, b = side ? state->u : state->v;
+                size_t k = 0;
+                for (auto [ei, ei_end] = out_edges(static_cast<CSRVertex>(a), g); ei != ei_end; ++ei) {
+                    if (target(*ei, g) == b) {
+                        put(weight, *ei, state->after[k++]);
+                    }
+                }
+            }
+        }
+        return changes;
+    }
+
+    // Ouvertures ou fermetures : reconstruction unique des tableaux, arcs des paires modifiées émis depuis leur état final
+    vector<char> touched(n, 0);
+    vector<std::tuple<uint32_t, uint32_t, float>> appended;
+    std::unordered_set<uint64_t> replaced;
+    for (const PairState *state : changed) {
+        touched[state->u] = touched[state->v] = 1;
+        replaced.insert(pair_key(state->u, state->v));
+        for (float w : state->after) {
+            appended.emplace_back(state->u, state->v, w);
+            appended.emplace_back(state->v, state->u, w);
+        }
+    }
+    stable_sort(appended.begin(), appended.end(), [](const auto &a, const auto &b) { return get<0>(a) < get<0>(b); });
+
+    vector<pair<uint32_t, uint32_t>> arcs;
+    vector<float> arc_weights;
+    arcs.reserve(num_edges(g) + appended.size());
+    arc_weights.reserve(num_edges(g) + appended.size());
+    size_t next = 0;
+    for (size_t u = 0; u < n; ++u) {
+        for (auto [ei, ei_end] = out_edges(static_cast<CSRVertex>(u), g); ei != ei_end; ++ei) {
+            Vertex v = target(*ei, g);
+            if (touched[u] && replaced.count(pair_key(u, v))) {
+                continue;
+            }
+            arcs.emplace_back(u, v);
+            arc_weights.push_back(get(weight, *ei));
+        }
+        for (; next < appended.size() && get<0>(appended[next]) == u; ++next) {
+            arcs.emplace_back(get<0>(appended[next]), get<1>(appended[next]));
+            arc_weights.push_back(get<2>(appended[next]));
+        }
+    }
+
+    g = CSRGraph(edges_are_sorted, arcs.begin(), arcs.end(), arc_weights.begin(), n, arcs.size());
+    return changes;
+}
+
+size_t repair_shortest_path_tree(const CSRGraph &g, const vector<ArcChange> &changes, ShortestPathTree &tree)
+{
+    if (!tree_affected(changes, tree)) {
+        return 0;
+    }
+
+    auto &dist = tree.distances;
+    auto &pred = tree.predecessors;
+    size_t n = dist.size();
+    auto weight = get(edge_weight, g);
+    greater<pair<double, Vertex>> cmp;
+    vector<pair<double, Vertex>> heap;
+    SearchCounters counters;
+
+    // État d'origine des sommets modifiés, pour compter ceux qui ont réellement changé
+    vector<char> recorded(n, 0);
+    vector<std::tuple<Vertex, double, uint32_t>> originals;
+    auto update = [&](Vertex x, double d, Vertex p) {
+        if (!recorded[x]) {
+            recorded[x] = 1;
+            originals.emplace_back(x, dist[x], pred[x]);
+        }
+        dist[x] = d;
+        pred[x] = static_cast<uint32_t>(p);
+    };
+    auto push = [&](double d, Vertex x) {
+        heap.emplace_back(d, x);
+        push_heap(heap.begin(), heap.end(), cmp);
+        counters.pushes++;
+    };
+
+    // Arcs de l'arbre allongés ou fermés : racines des sous-arbres à détacher
+    vector<Vertex> roots;
+    for (const ArcChange &c : changes) {
+        if (!c.weight_changed() || c.new_weight < c.old_weight) {
+            continue;
+        }
+        for (int side = 0; side < 2; ++side) {
+            Vertex a = side ? c.v : c.u, b = side ? c.u : c.v;
+            if (b != tree.source && pred[b] == a && dist[b] != INF) {
+                roots.push_back(b);
+            }
+        }
+    }
+
+    if (!roots.empty()) {
+        // Fils de chaque sommet dans l'arbre, regroupés par prédécesseur
+        vector<uint32_t> offsets(n + 1, 0), children(n);
+        for (size_t v = 0; v < n; ++v) {
+            if (v != tree.source && dist[v] != INF) {
+                offsets[pred[v] + 1]++;
+            }
+        }
+        partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        vector<uint32_t> fill_pos(offsets.begin(), offsets.end() - 1);
+        for (size_t v = 0; v < n; ++v) {
+            if (v != tree.source && dist[v] != INF) {
+                children[fill_pos[pred[v]]++] = static_cast<uint32_t>(v);
+            }
+        }
+
+        // Sous-arbres détachés : distances provisoirement infinies
+        vector<Vertex> detached;
+        vector<char> in_detached(n, 0);
+        for (Vertex r : roots) {
+            if (in_detached[r]) {
+                continue;
+            }
+            size_t first = detached.size();
+            detached.push_back(r);
+            in_detached[r] = 1;
+            for (size_t i = first; i < detached.size(); ++i) {
+                Vertex x = detached[i];
+                for (uint32_t k = offsets[x]; k < offsets[x + 1]; ++k) {
+                    if (!in_detached[children[k]]) {
+                        in_detached[children[k]] = 1;
+                        detached.push_back(children[k]);
+                    }
+                }
+            }
+        }
+        for (Vertex x : detached) {
+            update(x, INF, x);
+        }
+
+        // Raccrochage depuis le bord : meilleur voisin resté attaché
+        for (Vertex x : detached) {
+            double best = INF;
+            Vertex parent = x;
+            for (auto [ei, ei_end] = out_edges(static_cast<CSRVertex>(x), g); ei != ei_end; ++ei) {
+                Vertex y = target(*ei, g);
+                counters.relaxations++;
+                if (dist[y] != INF && dist[y] + get(weight, *ei) < best) {
+                    best = dist[y] + get(weight, *ei);
+                    parent = y;
+                }
+            }
+            if (best != INF) {
+                update(x, best, parent);
+                push(best, x);
+            }
+        }
+    }
+
+    // Arcs raccourcis ou ouverts
+    for (const ArcChange &c : changes) {
+        if (!c.weight_changed() || c.new_weight > c.old_weight) {
+            continue;
+        }
+        for (int side = 0; side < 2; ++side) {
+            Vertex a = side ? c.v : c.u, b = side ? c.u : c.v;
+            if (dist[a] != INF && dist[a] + c.new_weight < dist[b]) {
+                update(b, dist[a] + c.new_weight, a);
+                push(dist[b], b);
+            }
+        }
+    }
+
+    // Propagation des distances provisoires, comme un Dijkstra limité aux sommets améliorés
+    while (!heap.empty()) {
+        pop_heap(heap.begin(), heap.end(), cmp);
+        auto [d, x] = heap.back();
+        heap.pop_back();
+        counters.pops++;
+        if (d > dist[x]) {
+            continue;
+        }
+        counters.settled++;
+        for (auto [ei, ei_end] = out_edges(static_cast<CSRVertex>(x), g); ei != ei_end; ++ei) {
+            Vertex y = target(*ei, g);
+            double nd = d + get(weight, *ei);
+            counters.relaxations++;
+            if (nd < dist[y]) {
+                update(y, nd, x);
+                push(nd, y);
+            }
+        }
+    }
+    record_search(counters);
+
+    size_t modified = 0;
+    for (const auto &[x, d, p] : originals) {
+        modified += dist[x] != d || pred[x] != p;
+    }
+    return modified;
+}
+
+size_t repair_tree_cache(const CSRGraph &g, const vector<ArcChange> &changes, ShortestPathTreeCache &cache)
+{
+    ScopedTimer timer(Phase::Update);
+    return cache.replace_trees([&](const ShortestPathTree &tree) -> std::shared_ptr<const ShortestPathTree> {
+        if (!tree_affected(changes, tree)) {
+            return nullptr;
+        }
+        auto repaired = std::make_shared<ShortestPathTree>(tree);
+        if (repair_shortest_path_tree(g, changes, *repaired) == 0) {
+            return nullptr;
+        }
+        return repaired;
+    });
+}
+
+IncrementalMetrics::IncrementalMetrics(const CSRGraph &g, unsigned num_threads)
+{
+    current = compute_metrics(g, num_threads, true);
+
+    // Étiquetage des composantes par parcours en largeur
+    size_t n = num_vertices(g);
+    label.assign(n, NONE);
+    owner.assign(n, NONE);
+    for (size_t s = 0; s < n; ++s) {
+        if (label[s] != NONE) {
+            continue;
+        }
+        uint32_t l = static_cast<uint32_t>(members.size());
+        members.emplace_back();
+        vector<uint32_t> &queue = members.back();
+        queue.push_back(static_cast<uint32_t>(s));
+        label[s] = l;
+        for (size_t i = 0; i < queue.size(); ++i) {
+            for (auto [ei, ei_end] = out_edges(queue[i], g); ei != ei_end; ++ei) {
+                Vertex v = target(*ei, g);
+                if (label[v] == NONE) {
+                    label[v] = l;
+                    queue.push_back(static_cast<uint32_t>(v));
+                }
+            }
+        }
+        label_size.push_back(queue.size());
+    }
+}
+
+uint32_t IncrementalMetrics::new_label()
+{
+    if (!free_labels.empty()) {
+        uint32_t l = free_labels.back();
+        free_labels.pop_back();
+        return l;
+    }
+    label_size.push_back(0);
+    members.emplace_back();
+    return static_cast<uint32_t>(members.size() - 1);
+}
+
+void IncrementalMetrics::split_components(const CSRGraph &g, uint32_t old_label, vector<Vertex> &endpoints)
+{
+    sort(endpoints.begin(), endpoints.end());
+    endpoints.erase(unique(endpoints.begin(), endpoints.end()), endpoints.end());
+    size_t k = endpoints.size();
+    if (k < 2) {
+        return;
+    }
+
+    // Un parcours par extrémité ; deux parcours qui se rencontrent fusionnent (union-find sur les parcours)
+    struct Search
+    {
+        vector<uint32_t> visited;
+        vector<uint32_t> frontier;
+        size_t head = 0;
+        bool active = true;
+    };
+    vector<Search> searches(k);
+    vector<uint32_t> parent(k);
+    iota(parent.begin(), parent.end(), 0);
+    auto find_root = [&](uint32_t i) {
+        while (parent[i] != i) {
+            i = parent[i] = parent[parent[i]];
+        }
+        return i;
+    };
+    for (uint32_t i = 0; i < k; ++i) {
+        owner[endpoints[i]] = i;
+        searches[i].visited.push_back(static_cast<uint32_t>(endpoints[i]));
+        searches[i].frontier.push_back(static_cast<uint32_t>(endpoints[i]));
+    }
+
+    // Un sommet par parcours actif et par tour ; le dernier parcours actif garde l'ancienne étiquette
+    size_t active = k;
+    while (active > 1) {
+        for (uint32_t i = 0; i < k && active > 1; ++i) {
+            if (!searches[i].active) {
+                continue;
+            }
+            if (searches[i].head == searches[i].frontier.size()) {
+                // Parcours épuisé : composante complète, détachée sous une nouvelle étiquette
+                Search &s = searches[i];
+                uint32_t l = new_label();
+                for (uint32_t x : s.visited) {
+                    label[x] = l;
+                }
+                label_size[l] = s.visited.size();
+                label_size[old_label] -= s.visited.size();
+                members[l] = s.visited;
+                s.active = false;
+                active--;
+                continue;
+            }
+
+            uint32_t current_search = i;
+            Vertex x = searches[i].frontier[searches[i].head++];
+            for (auto [ei, ei_end] = out_edges(static_cast<CSRVertex>(x), g); ei != ei_end; ++ei) {
+                Vertex y = target(*ei, g);
+                if (label[y] != old_label) {
+                    continue;
+                }
+                if (owner[y] == NONE) {
+                    owner[y] = current_search;
+                    searches[current_search].visited.push_back(static_cast<uint32_t>(y));
+                    searches[current_search].frontier.push_back(static_cast<uint32_t>(y));
+                    continue;
+                }
+                uint32_t other = find_root(owner[y]);
+                if (other == current_search) {
+                    continue;
+                }
+                // Rencontre : le plus petit parcours est versé dans le plus grand
+                uint32_t keep = current_search, drop = other;
+                if (searches[keep].visited.size() < searches[drop].visited.size()) {
+                    swap(keep, drop);
+                }
+                Search &kept = searches[keep], &dropped = searches[drop];
+                kept.visited.insert(kept.visited.end(), dropped.visited.begin(), dropped.visited.end());
+                kept.frontier.insert(kept.frontier.end(), dropped.frontier.begin() + dropped.head, dropped.frontier.end());
+                dropped.visited.clear();
+                dropped.frontier.clear();
+                dropped.head = 0;
+                dropped.active = false;
+                parent[drop] = keep;
+                active--;
+                current_search = keep;
+            }
+        }
+    }
+
+    for (const Search &s : searches) {
+        for (uint32_t x : s.visited) {
+            owner[x] = NONE;
+        }
+    }
+
+    // Entrées périmées de l'ancienne étiquette retirées lorsqu'elles deviennent majoritaires
+    vector<uint32_t> &old_members = members[old_label];
+    if (old_members.size() > 2 * label_size[old_label]) {
+        old_members.erase(remove_if(old_members.begin(), old_members.end(), [&](uint32_t x) { return label[x] != old_label; }), old_members.end());
+    }
+}
+
+void IncrementalMetrics::merge_components(uint32_t a, uint32_t b)
+{
+    if (label_size[a] < label_size[b]) {
+        swap(a, b);
+    }
+    for (uint32_t x : members[b]) {
+        if (label[x] == b) {
+            label[x] = a;
+            members[a].push_back(x);
+        }
+    }
+    label_size[a] += label_size[b];
+    label_size[b] = 0;
+    vector<uint32_t>().swap(members[b]);
+    free_labels.push_back(b);
+}
+
+void IncrementalMetrics::apply(const CSRGraph &g, const vector<ArcChange> &changes)
+{
+    ScopedTimer timer(Phase::Update);
+    auto &histogram = current.degree_histogram;
+
+    // Degrés des extrémités, un arc par sens
+    for (const ArcChange &c : changes) {
+        int64_t delta = int64_t(c.new_count) - int64_t(c.old_count);
+        if (delta == 0) {
+            continue;
+        }
+        for (Vertex x : {c.u, c.v}) {
+            size_t degree = current.degrees[x];
+            histogram[degree]--;
+            degree = size_t(int64_t(degree) + delta);
+            if (histogram.size() <= degree) {
+                histogram.resize(degree + 1, 0);
+            }
+            histogram[degree]++;
+            current.degrees[x] = static_cast<uint32_t>(degree);
+        }
+        current.num_arcs = size_t(int64_t(current.num_arcs) + 2 * delta);
+    }
+
+    // Fermetures d'abord, regroupées par composante : parcours sur le graph après le lot, limités à la composante
+    std::unordered_map<uint32_t, vector<Vertex>> closed;
+    for (const ArcChange &c : changes) {
+        if (c.old_count > 0 && c.new_count == 0) {
+            auto &endpoints = closed[label[c.u]];
+            endpoints.push_back(c.u);
+            endpoints.push_back(c.v);
+        }
+    }
+    for (auto &[l, endpoints] : closed) {
+        split_components(g, l, endpoints);
+    }
+
+    // Puis ouvertures entre composantes distinctes
+    for (const ArcChange &c : changes) {
+        if (c.old_count == 0 && c.new_count > 0 && label[c.u] != label[c.v]) {
+            merge_components(label[c.u], label[c.v]);
+        }
+    }
+
+    update_summary(g);
+}
+
+void IncrementalMetrics::update_summary(const CSRGraph &g)
+{
+    auto &histogram = current.degree_histogram;
+    size_t n = current.num_vertices;
+    while (!histogram.empty() && histogram.back() == 0) {
+        histogram.pop_back();
+    }
+
+    // Statistiques des degrés tirées de l'histogramme
+    double sum_sq = 0;
+    size_t cumulated = 0;
+    bool median_found = false;
+    current.max_degree = histogram.empty() ? 0 : histogram.size() - 1;
+    current.min_degree = 0;
+    while (current.min_degree < histogram.size() && histogram[current.min_degree] == 0) {
+        current.min_degree++;
+    }
+    for (size_t d = 0; d < histogram.size(); ++d) {
+        sum_sq += double(d) * d * histogram[d];
+        cumulated += histogram[d];
+        if (!median_found && 2 * cumulated >= n) {
+            current.median_degree = d;
+            median_found = true;
+        }
+    }
+    current.isolated_vertices = histogram.empty() ? 0 : histogram[0];
+    current.mean_degree = n ? double(current.num_arcs) / n : 0;
+    current.degree_stddev = n ? sqrt(max(0.0, sum_sq / n - current.mean_degree * current.mean_degree)) : 0;
+
+    // Poids : un passage sur le tableau contigu des poids
+    auto weight = get(edge_weight, g);
+    double min_weight = INF, max_weight = 0, sum_weight = 0;
+    for (auto [ei, ei_end] = edges(g); ei != ei_end; ++ei) {
+        double w = get(weight, *ei);
+        min_weight = min(min_weight, w);
+        max_weight = max(max_weight, w);
+        sum_weight += w;
+    }
+    current.min_weight = current.num_arcs ? min_weight : 0;
+    current.max_weight = max_weight;
+    current.mean_weight = current.num_arcs ? sum_weight / current.num_arcs : 0;
+
+    current.component_sizes.clear();
+    for (size_t size : label_size) {
+        if (size > 0) {
+            current.component_sizes.push_back(size);
+        }
+    }
+    sort(current.component_sizes.begin(), current.component_sizes.end(), greater<size_t>());
+    current.num_components = current.component_sizes.size();
+}
+
+namespace {
+
+/**
+ * @brief ligne d'export à recalculer : position dans le fichier, couple et texte de remplacement
+ */
+struct StaleRow
+{
+    const char *begin;
+    const char *end;
+    double start;
+    double goal;
+    string text;
+};
+
+/**
+ * @brief analyse d'une ligne "départ;arrivée;longueur;[chemin]" ou "départ;arrivée;Inf;No Path" (sommets à partir de 0 dans path)
+ */
+bool parse_export_row(const char *p, const char *end, size_t n, const VertexNumbering &numbering, double &start, double &goal, bool &found, double &length,
+                      vector<Vertex> &path)
+{
+    while (end > p && (end[-1] == '\r' || end[-1] == ' ')) --end;
+    auto number = [&](double &value) {
+        auto [ptr, ec] = from_chars(p, end, value);
+        if (ec != errc() || ptr == p) {
+            return false;
+        }
+        p = ptr;
+        return true;
+    };
+    if (!number(start) || p == end || *p++ != ';' || !number(goal) || p == end || *p++ != ';') {
+        return false;
+    }
+    if (!valid_pair(start, goal, n)) {
+        return false;
+    }
+    // Export écrit dans la numérotation des fichiers
+    start = numbering.internal(static_cast<Vertex>(start) - 1) + 1.0;
+    goal = numbering.internal(static_cast<Vertex>(goal) - 1) + 1.0;
+    path.clear();
+    if (end - p == 11 && memcmp(p, "Inf;No Path", 11) == 0) {
+        found = false;
+        length = INF;
+        return true;
+    }
+    found = true;
+    if (!number(length) || p == end || *p++ != ';' || p == end || *p++ != '[') {
+        return false;
+    }
+    while (p < end && *p != ']') {
+        uint64_t id;
+        auto [ptr, ec] = from_chars(p, end, id);
+        if (ec != errc() || ptr == p || id < 1 || id > n) {
+            return false;
+        }
+        path.push_back(numbering.internal(static_cast<Vertex>(id - 1)));
+        p = ptr;
+        if (p < end && *p == ',') ++p;
+    }
+    return p < end && !path.empty();
+}
+
+} // namespace
+
+ExportUpdateResult update_export_csv(const CSRGraph &g, const VertexNumbering &numbering, const vector<ArcChange> &changes, const string &filename,
+                                     unsigned num_threads, ShortestPathTreeCache *cache)
+{
+    ScopedTimer timer(Phase::Update);
+    ExportUpdateResult result;
+    size_t n = num_vertices(g);
+
+    // Paires allongées ou fermées, anciens poids des paires modifiées, et distances depuis les extrémités
+    // des paires raccourcies ou ouvertes (graph symétrique : d(s, u) = d(u, s))
+    struct Shortcut
+    {
+        double weight;
+        vector<double> from_u, from_v;
+    };
+    std::unordered_set<uint64_t> lengthened;
+    std::unordered_map<uint64_t, double> old_weights;
+    vector<Shortcut> shortcuts;
+    SearchScratch scratch;
+    for (const ArcChange &c : changes) {
+        if (!c.weight_changed()) {
+            continue;
+        }
+        old_weights[pair_key(c.u, c.v)] = c.old_weight;
+        if (c.new_weight > c.old_weight) {
+            lengthened.insert(pair_key(c.u, c.v));
+            continue;
+        }
+        Shortcut shortcut;
+        shortcut.weight = c.new_weight;
+        dijkstra_to_goals(g, c.u, {}, scratch);
+        shortcut.from_u = scratch.distances;
+        dijkstra_to_goals(g, c.v, {}, scratch);
+        shortcut.from_v = scratch.distances;
+        shortcuts.push_back(std::move(shortcut));
+    }
+
+    // Longueur exacte d'un ancien chemin, sommée dans l'ordre du chemin comme le Dijkstra qui l'a produit
+    auto old_length = [&](const vector<Vertex> &path) {
+        double length = 0;
+        for (size_t i = 1; i < path.size(); ++i) {
+            auto it = old_weights.find(pair_key(path[i - 1], path[i]));
+            length += it != old_weights.end() ? it->second : arc_weight(g, path[i - 1], path[i]);
+        }
+        return length;
+    };
+
+    {
+        MappedFile file(filename);
+        if (!file.is_open()) {
+            cerr << "Ouverture du fichier impossible : " << filename << endl;
+            return result;
+        }
+        const char *begin = file.data();
+        const char *end = begin + file.size();
+        const char *header_end = begin ? static_cast<const char *>(memchr(begin, '\n', end - begin)) : nullptr;
+        if (!header_end) {
+            cerr << "Export '" << filename << "' vide ou sans en-tête" << endl;
+            return result;
+        }
+
+        // Sélection des lignes dont le chemin a pu changer
+        vector<StaleRow> stale;
+        vector<Vertex> path;
+        size_t line = 1;
+        for (const char *p = header_end + 1; p < end;) {
+            const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+            const char *line_end = nl ? nl : end;
+            const char *line_begin = p;
+            p = nl ? nl + 1 : end;
+            line++;
+            if (line_begin == line_end || (line_end - line_begin == 1 && *line_begin == '\r')) {
+                continue;
+            }
+
+            double start, goal, length;
+            bool found;
+            if (!parse_export_row(line_begin, line_end, n, numbering, start, goal, found, length, path)) {
+                cerr << "Export '" << filename << "' ligne " << line << " illisible, mise à jour abandonnée" << endl;
+                return result;
+            }
+            result.rows++;
+
+            bool is_stale = false;
+            for (size_t i = 1; i < path.size() && !is_stale && !lengthened.empty(); ++i) {
+                is_stale = lengthened.count(pair_key(path[i - 1], path[i])) > 0;
+            }
+
+            Vertex s = static_cast<Vertex>(start - 1), t = static_cast<Vertex>(goal - 1);
+            double exact = -1;
+            for (size_t k = 0; k < shortcuts.size() && !is_stale; ++k) {
+                const Shortcut &sc = shortcuts[k];
+                double candidate = INF;
+                if (sc.from_u[s] != INF && sc.from_v[t] != INF) candidate = min(candidate, sc.from_u[s] + sc.weight + sc.from_v[t]);
+                if (sc.from_v[s] != INF && sc.from_u[t] != INF) candidate = min(candidate, sc.from_v[s] + sc.weight + sc.from_u[t]);
+                if (candidate == INF) {
+                    continue;
+                }
+                if (!found) {
+                    is_stale = true;
+                    continue;
+                }
+                // Longueur affichée arrondie : comparaison exacte seulement pour les candidats proches
+                if (candidate >= length * (1 + 1e-5)) {
+                    continue;
+                }
+                if (exact < 0) {
+                    exact = old_length(path);
+                }
+                is_stale = candidate < exact;
+            }
+
+            if (is_stale) {
+                stale.push_back({line_begin, line_end, start, goal, string()});
+            }
+        }
+        result.recomputed = stale.size();
+
+        // Recalcul des lignes sélectionnées, regroupées par source
+        vector<size_t> order(stale.size());
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return stale[a].start < stale[b].start; });
+        vector<size_t> groups;
+        for (size_t i = 0; i < order.size(); ++i) {
+            if (i == 0 || stale[order[i]].start != stale[order[i - 1]].start) {
+                groups.push_back(i);
+            }
+        }
+        result.sources = groups.size();
+        groups.push_back(order.size());
+
+        atomic<size_t> next_group{0}, rewritten{0};
+        auto recompute = [&]() {
+            SearchScratch local;
+            local.engine_threads = 1;
+            vector<Vertex> goals, row_path;
+            for (size_t gi; (gi = next_group.fetch_add(1)) + 1 < groups.size();) {
+                Vertex source = static_cast<Vertex>(stale[order[groups[gi]]].start - 1);
+                std::shared_ptr<const ShortestPathTree> tree = cache ? cache->find(source) : nullptr;
+                if (!tree) {
+                    goals.clear();
+                    for (size_t i = groups[gi]; i < groups[gi + 1]; ++i) {
+                        goals.push_back(static_cast<Vertex>(stale[order[i]].goal - 1));
+                    }
+                    dijkstra_to_goals(g, source, goals, local);
+                }
+                for (size_t i = groups[gi]; i < groups[gi + 1]; ++i) {
+                    StaleRow &row = stale[order[i]];
+                    Vertex goal = static_cast<Vertex>(row.goal - 1);
+                    bool found = tree ? tree->extract_path(goal, row_path) : extract_path(local, source, goal, row_path);
+                    write_path_row(row.text, row.start, row.goal, found, tree ? tree->distances[goal] : local.distances[goal], row_path, numbering);
+                    if (row.text.compare(0, row.text.size() - 1, row.begin, row.end - row.begin) != 0) {
+                        rewritten.fetch_add(1);
+                    }
+                }
+            }
+        };
+        num_threads = resolve_num_threads(num_threads, result.sources);
+        vector<thread> pool;
+        for (unsigned t = 1; t < num_threads; ++t) {
+            pool.emplace_back(recompute);
+        }
+        recompute();
+        for (auto &th : pool) {
+            th.join();
+        }
+        result.rewritten = rewritten.load();
+
+        // Réécriture : lignes inchangées recopiées, lignes recalculées remplacées
+        if (result.rewritten > 0) {
+            string tmp_filename = filename + ".tmp";
+            ofstream out(tmp_filename, ios::out | ios::binary | ios::trunc);
+            if (!out.is_open()) {
+                cerr << "Impossible d'écrire le fichier '" << tmp_filename << "'" << endl;
+                return result;
+            }
+            const char *cursor = begin;
+            for (const StaleRow &row : stale) {
+                out.write(cursor, row.begin - cursor);
+                write_chunk(out, row.text);
+                cursor = row.end < end ? row.end + 1 : end;
+            }
+            out.write(cursor, end - cursor);
+            out.close();
+            if (!out) {
+                cerr << "Erreur d'écriture du fichier '" << tmp_filename << "'" << endl;
+                fs::remove(tmp_filename);
+                return result;
+            }
+        }
+    }
+
+    if (result.rewritten > 0) {
+        error_code ec;
+        fs::rename(filename + ".tmp", filename, ec);
+        if (ec) {
+            cerr << "Impossible de remplacer le fichier '" << filename << "' : " << ec.message() << endl;
+            fs::remove(filename + ".tmp", ec);
+            return result;
+        }
+    }
+    result.ok = true;
+    return result;
+}
+
+namespace {
+
+const char EXPORT_KEY_MAGIC[8] = {'E', 'X', 'P', 'O', 'R', 'T', 'K', 'Y'};
+const uint32_t EXPORT_KEY_VERSION = 1;
+
+/**
+ * @brief contenu du fichier "<export>.key" : empreinte de l'export, taille et date de l'export empreint
+ */
+struct ExportKeyRecord
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t ordering;
+    uint64_t nodes_size;
+    int64_t nodes_mtime;
+    uint64_t edges_size;
+    int64_t edges_mtime;
+    uint32_t weight_precision;
+    uint32_t reserved;
+    uint64_t pairs_hash;
+    uint64_t updates_hash;
+    uint64_t export_size;
+    int64_t export_mtime;
+};
+
+// FNV-1a 64 bits
+const uint64_t FNV_OFFSET = 14695981039346656037ull;
+const uint64_t FNV_PRIME = 1099511628211ull;
+
+uint64_t fnv1a(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+bool export_file_state(const string &filename, uint64_t &size, int64_t &mtime)
+{
+    error_code ec_size, ec_time;
+    size = fs::file_size(filename, ec_size);
+    mtime = static_cast<int64_t>(fs::last_write_time(filename, ec_time).time_since_epoch().count());
+    return !ec_size && !ec_time;
+}
+
+ExportKeyRecord make_export_key_record(const ExportFingerprint &fingerprint)
+{
+    ExportKeyRecord record{};
+    memcpy(record.magic, EXPORT_KEY_MAGIC, sizeof(EXPORT_KEY_MAGIC));
+    record.version = EXPORT_KEY_VERSION;
+    record.ordering = fingerprint.graph.ordering;
+    record.nodes_size = fingerprint.graph.nodes_size;
+    record.nodes_mtime = fingerprint.graph.nodes_mtime;
+    record.edges_size = fingerprint.graph.edges_size;
+    record.edges_mtime = fingerprint.graph.edges_mtime;
+    record.weight_precision = fingerprint.graph.weight_precision;
+    record.pairs_hash = fingerprint.pairs_hash;
+    record.updates_hash = fingerprint.updates_hash;
+    return record;
+}
+
+} // namespace
+
+uint64_t hash_export_pairs(const vector<pair<double, double>> &pairs)
+{
+    uint64_t hash = FNV_OFFSET;
+    for (const auto &[start, goal] : pairs) {
+        hash = fnv1a(hash, &start, sizeof(start));
+        hash = fnv1a(hash, &goal, sizeof(goal));
+    }
+    return hash;
+}
+
+bool chain_update_batch(ExportFingerprint &fingerprint, const string &filename)
+{
+    MappedFile file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    uint64_t hash = fnv1a(FNV_OFFSET, &fingerprint.updates_hash, sizeof(fingerprint.updates_hash));
+    fingerprint.updates_hash = fnv1a(hash, file.data(), file.size());
+    return true;
+}
+
+bool save_export_fingerprint(const string &filename, const ExportFingerprint &fingerprint)
+{
+    string key_filename = filename + ".key";
+    ExportKeyRecord record = make_export_key_record(fingerprint);
+    if (!fingerprint.graph.valid || !export_file_state(filename, record.export_size, record.export_mtime)) {
+        error_code ec;
+        fs::remove(key_filename, ec);
+        return false;
+    }
+    ofstream file(key_filename, ios::out | ios::binary | ios::trunc);
+    file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+    if (!file) {
+        cerr << "Impossible d'écrire l'empreinte de l'export '" << key_filename << "'" << endl;
+        return false;
+    }
+    return true;
+}
+
+bool export_matches_fingerprint(const string &filename, const ExportFingerprint &fingerprint)
+{
+    ExportKeyRecord expected = make_export_key_record(fingerprint);
+    if (!fingerprint.graph.valid || !export_file_state(filename, expected.export_size, expected.export_mtime)) {
+        return false;
+    }
+    ExportKeyRecord stored;
+    ifstream file(filename + ".key", ios::in | ios::binary);
+    if (!file.read(reinterpret_cast<char *>(&stored), sizeof(stored))) {
+        return false;
+    }
+    return memcmp(&stored, &expected, sizeof(stored)) == 0;
+}
@@ -0,0 +1,233 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include "instrumentation.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <psapi.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+const size_t NUM_PHASES = static_cast<size_t>(Phase::Count);
+const size_t NUM_COUNTERS = static_cast<size_t>(Counter::Count);
+
+const char *const PHASE_NAMES[NUM_PHASES] = {
+    "load", "parse", "weights", "build", "cache_load", "cache_save", "preprocess",
+    "metrics", "cycles", "single_path", "export", "search", "write", "update"};
+
+const char *const COUNTER_NAMES[NUM_COUNTERS] = {
+    "searches", "heap_pushes", "heap_pops", "relaxations", "settled_vertices", "bytes_written"};
+
+// Totaux globaux, chacun sur sa propre ligne de cache pour éviter le faux partage entre threads
+struct alignas(64) Slot
+{
+    atomic<uint64_t> value{0};
+    atomic<uint64_t> calls{0};
+};
+
+Slot phases[NUM_PHASES];
+Slot counters[NUM_COUNTERS];
+
+} // namespace
+
+void add_phase_time(Phase phase, uint64_t nanoseconds)
+{
+    Slot &slot = phases[static_cast<size_t>(phase)];
+    slot.value.fetch_add(nanoseconds, memory_order_relaxed);
+    slot.calls.fetch_add(1, memory_order_relaxed);
+}
+
+void add_counter(Counter counter, uint64_t value)
+{
+    counters[static_cast<size_t>(counter)].value.fetch_add(value, memory_order_relaxed);
+}
+
+void record_search(const SearchCounters &c)
+{
+    add_counter(Counter::Searches);
+    add_counter(Counter::HeapPushes, c.pushes);
+    add_counter(Counter::HeapPops, c.pops);
+    add_counter(Counter::Relaxations, c.relaxations);
+    add_counter(Counter::SettledVertices, c.settled);
+}
+
+uint64_t phase_nanoseconds(Phase phase)
+{
+    return phases[static_cast<size_t>(phase)].value.load(memory_order_relaxed);
+}
+
+uint64_t phase_calls(Phase phase)
+{
+    return phases[static_cast<size_t>(phase)].calls.load(memory_order_relaxed);
+}
+
+uint64_t counter_value(Counter counter)
+{
+    return counters[static_cast<size_t>(counter)].value.load(memory_order_relaxed);
+}
+
+const char *phase_name(Phase phase)
+{
+    return PHASE_NAMES[static_cast<size_t>(phase)];
+}
+
+const char *counter_name(Counter counter)
+{
+    return COUNTER_NAMES[static_cast<size_t>(counter)];
+}
+
+void reset_instrumentation()
+{
+    for (Slot &slot : phases) {
+        slot.value.store(0, memory_order_relaxed);
+        slot.calls.store(0, memory_order_relaxed);
+    }
+    for (Slot &slot : counters) {
+        slot.value.store(0, memory_order_relaxed);
+    }
+}
+
+bool resident_memory(uint64_t &current, uint64_t &peak)
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return false;
+    }
+    current = counters.WorkingSetSize;
+    peak = counters.PeakWorkingSetSize;
+    return true;
+#elif defined(__linux__)
+    ifstream status("/proc/self/status");
+    bool found_current = false, found_peak = false;
+    string line;
+    while (getline(status, line)) {
+        // Lignes "VmRSS:     1234 kB"
+        istringstream fields(line);
+        string name;
+        uint64_t kilobytes;
+        if (!(fields >> name >> kilobytes)) {
+            continue;
+        }
+        if (name == "VmRSS:") {
+            current = kilobytes * 1024;
+            found_current = true;
+        } else if (name == "VmHWM:") {
+            peak = kilobytes * 1024;
+            found_peak = true;
+        }
+    }
+    return found_current && found_peak;
+#else
+    (void)current;
+    (void)peak;
+    return false;
+#endif
+}
+
+static string format_bytes(uint64_t bytes)
+{
+    ostringstream out;
+    out << fixed << setprecision(1) << bytes / (1024.0 * 1024.0) << " MiB";
+    return out.str();
+}
+
+void print_memory_report(ostream &out, const MemoryReport &report)
+{
+    size_t width = 0;
+    uint64_t total = 0;
+    for (const auto &[name, bytes] : report.components) {
+        width = max(width, name.size());
+        total += bytes;
+    }
+    out << "Memory report:" << endl;
+    for (const auto &[name, bytes] : report.components) {
+        out << "  " << left << setw(static_cast<int>(width)) << name << right << "  " << setw(12) << format_bytes(bytes) << endl;
+    }
+    out << "  " << left << setw(static_cast<int>(width)) << "total" << right << "  " << setw(12) << format_bytes(total) << endl;
+
+    uint64_t current, peak;
+    if (resident_memory(current, peak)) {
+        out << "  resident " << format_bytes(current) << ", peak resident " << format_bytes(peak) << endl;
+    } else {
+        out << "  resident memory not available on this platform" << endl;
+    }
+}
+
+static void write_prometheus(ostream &file)
+{
+    file << "# HELP graph_phase_seconds_total Cumulated time spent in each phase.\n";
+    file << "# TYPE graph_phase_seconds_total counter\n";
+    for (size_t p = 0; p < NUM_PHASES; ++p) {
+        file << "graph_phase_seconds_total{phase=\"" << PHASE_NAMES[p] << "\"} " << phase_nanoseconds(Phase(p)) * 1e-9 << "\n";
+    }
+    file << "# HELP graph_phase_calls_total Number of timed calls of each phase.\n";
+    file << "# TYPE graph_phase_calls_total counter\n";
+    for (size_t p = 0; p < NUM_PHASES; ++p) {
+        file << "graph_phase_calls_total{phase=\"" << PHASE_NAMES[p] << "\"} " << phase_calls(Phase(p)) << "\n";
+    }
+    for (size_t c = 0; c < NUM_COUNTERS; ++c) {
+        file << "# TYPE graph_" << COUNTER_NAMES[c] << "_total counter\n";
+        file << "graph_" << COUNTER_NAMES[c] << "_total " << counter_value(Counter(c)) << "\n";
+    }
+    uint64_t current, peak;
+    if (resident_memory(current, peak)) {
+        file << "# HELP graph_resident_bytes Resident memory of the process.\n";
+        file << "# TYPE graph_resident_bytes gauge\n";
+        file << "graph_resident_bytes " << current << "\n";
+        file << "# HELP graph_peak_resident_bytes Peak resident memory of the process.\n";
+        file << "# TYPE graph_peak_resident_bytes gauge\n";
+        file << "graph_peak_resident_bytes " << peak << "\n";
+    }
+}
+
+static void write_json(ostream &file)
+{
+    file << "{\n  \"phases\": {\n";
+    for (size_t p = 0; p < NUM_PHASES; ++p) {
+        file << "    \"" << PHASE_NAMES[p] << "\": {\"seconds\": " << phase_nanoseconds(Phase(p)) * 1e-9
+             << ", \"calls\": " << phase_calls(Phase(p)) << "}" << (p + 1 < NUM_PHASES ? "," : "") << "\n";
+    }
+    file << "  },\n  \"counters\": {\n";
+    for (size_t c = 0; c < NUM_COUNTERS; ++c) {
+        file << "    \"" << COUNTER_NAMES[c] << "\": " << counter_value(Counter(c)) << (c + 1 < NUM_COUNTERS ? "," : "") << "\n";
+    }
+    file << "  }";
+    uint64_t current, peak;
+    if (resident_memory(current, peak)) {
+        file << ",\n  \"memory\": {\"resident_bytes\": " << current << ", \"peak_resident_bytes\": " << peak << "}";
+    }
+    file << "\n}\n";
+}
+
+bool write_instrumentation(const string &filename)
+{
+    ofstream file(filename, ios::out | ios::trunc);
+    if (!file.is_open()) {
+        cerr << "Impossible d'ouvrir le fichier '" << filename << "'" << endl;
+        return false;
+    }
+
+    file.precision(9);
+    const string PROMETHEUS_EXTENSION = ".prom";
+    if (filename.size() >= PROMETHEUS_EXTENSION.size() &&
+        filename.compare(filename.size() - PROMETHEUS_EXTENSION.size(), PROMETHEUS_EXTENSION.size(), PROMETHEUS_EXTENSION) == 0) {
+        write_prometheus(file);
+    } else {
+        write_json(file);
+    }
+
+    file.close();
+    if (!file) {
+        cerr << "Erreur d'écriture du fichier '" << filename << "'" << endl;
+        return false;
+    }
+    return true;
+}
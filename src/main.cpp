@@ -2,9 +2,17 @@
 #include <fstream>
 #include <vector>
 #include <string>
-#include <tuple>
 #include <cmath>
 #include <limits>
+#include <cstdlib>
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 #ifdef _WIN32
     #include <windows.h>
@@ -12,6 +20,15 @@
 #endif
 
 #include "graph_analysis.h"
+#include "path_search.h"
+#include "graph_cache.h"
+#include "contraction_hierarchy.h"
+#include "sssp_cache.h"
+#include "cycle_analysis.h"
+#include "vertex_order.h"
+#include "render_index.h"
+#include "spatial_index.h"
+#include "instrumentation.h"
 #include <QApplication>
 #include <QWindow>
 #include <QSurfaceFormat>
@@ -19,6 +36,10 @@
 #include <QGraphicsScene>
 #include <QGraphicsEllipseItem>
 #include <QGraphicsLineItem>
+#include <QStyleOptionGraphicsItem>
+#include <QWheelEvent>
+#include <QMouseEvent>
+#include <QPainter>
 #include <QPen>
 #include <QBrush>
 #include <QHBoxLayout>
@@ -27,6 +48,8 @@
 #include <QVBoxLayout>
 #include <QMessageBox>
 #include <QTabWidget>
+#include <QComboBox>
+#include <QLabel>
 
 #include <boost/graph/graph_utility.hpp>
 #include <boost/graph/adjacency_list.hpp>
@@ -38,118 +61,327 @@ using namespace boost;
 #define WIDTH 800
 #define HEIGHT 600
 
-class GraphView : public QGraphicsView
+// Rayon des disques des sommets et épaisseur des arêtes, en unités des coordonnées
+#define VERTEX_RADIUS 50
+#define EDGE_WIDTH 6
+
+// Niveaux de détail, d'après la taille à l'écran d'un disque de sommet (en pixels) : points en dessous
+// de DISC_MIN_PIXELS, disques au-delà, numéros à partir de LABEL_MIN_PIXELS
+#define DISC_MIN_PIXELS 4
+#define LABEL_MIN_PIXELS 30
+// Nombre de lignes ou de points par appel de dessin
+#define DRAW_BATCH 4096
+// Distance maximale (en pixels) entre un clic et le sommet sélectionné, et déplacement au-delà duquel le clic est un glisser
+#define PICK_PIXELS 8
+
+/**
+ * @brief stylo d'épaisseur width (unités des coordonnées), remplacé par un trait d'un pixel quand il serait plus fin
+ */
+static QPen layer_pen(const QColor &color, double width, double lod)
+{
+    QPen pen(color, width * lod < 1.5 ? 0 : width);
+    pen.setCapStyle(Qt::RoundCap);
+    return pen;
+}
+
+/**
+ * @brief couche des arêtes : chaque arête non orientée tracée une fois, par lots, dans la zone exposée seulement
+ *
+ * Les arêtes plus courtes qu'un pixel, confondues avec leurs extrémités, sont ignorées.
+ */
+class EdgeLayer : public QGraphicsItem
 {
 public:
-    GraphView(QWidget *parent = nullptr) : QGraphicsView(parent)
+    EdgeLayer(const RenderIndex &index, const QRectF &bounds) : index(index), bounds(bounds)
     {
-        scene = new QGraphicsScene(this);
-        setScene(scene);
+        setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    }
 
-        setRenderHint(QPainter::Antialiasing);
-        setRenderHint(QPainter::TextAntialiasing);
-        setRenderHint(QPainter::SmoothPixmapTransform);
+    QRectF boundingRect() const override { return bounds; }
+
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *) override
+    {
+        double lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+        const QRectF &exposed = option->exposedRect;
+        painter->setRenderHint(QPainter::Antialiasing, 2 * VERTEX_RADIUS * lod >= DISC_MIN_PIXELS);
+        painter->setPen(layer_pen(Qt::black, EDGE_WIDTH, lod));
+
+        lines.clear();
+        index.for_each_edge({exposed.left(), exposed.top(), exposed.right(), exposed.bottom()}, 1 / lod, [&](uint32_t u, uint32_t v)
+        {
+            lines.emplace_back(index.x(u), index.y(u), index.x(v), index.y(v));
+            if (lines.size() == DRAW_BATCH)
+            {
+                painter->drawLines(lines.data(), static_cast<int>(lines.size()));
+                lines.clear();
+            }
+        });
+        painter->drawLines(lines.data(), static_cast<int>(lines.size()));
     }
 
-    void drawEdges(const Graph &g, const vector<std::tuple<double, double, double>> &coord_list)
+private:
+    const RenderIndex &index;
+    QRectF bounds;
+    vector<QLineF> lines;
+};
+
+/**
+ * @brief couche des sommets, dessinée selon le zoom : points regroupés par couleur, disques, puis disques numérotés
+ *
+ * Lorsqu'une case de l'index est plus petite qu'un pixel, un seul sommet par case est dessiné.
+ */
+class VertexLayer : public QGraphicsItem
+{
+public:
+    VertexLayer(const RenderIndex &index, const CoordinateStore &coord_list, const VertexNumbering &numbering, const QRectF &bounds)
+        : index(index), numbering(numbering), bounds(bounds)
     {
-        // Draw edges
-        for (auto [ei, ei_end] = edges(g); ei != ei_end; ++ei)
+        setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+        // Rouge selon l'altitude, de 80 (z = -1000) à 255 (z = 1000)
+        red.resize(coord_list.size());
+        for (size_t i = 0; i < coord_list.size(); ++i)
         {
-            auto e = *ei;
-            auto u = source(e, g);
-            auto v = target(e, g);
-            double x1 = get<0>(coord_list[u]);
-            double y1 = get<1>(coord_list[u]);
-            double x2 = get<0>(coord_list[v]);
-            double y2 = get<1>(coord_list[v]);
-
-            scene->addLine(x1, y1, x2, y2, QPen(Qt::black, 6));
+            double z = coord_list.z(i);
+            red[i] = static_cast<uint8_t>(clamp(80 + ((z + 1000) / 2000) * (255 - 80), 0.0, 255.0));
         }
+        font.setPointSize(40);
     }
 
-    void drawVertices(const Graph &g, const vector<std::tuple<double, double, double>> &coord_list)
+    QRectF boundingRect() const override { return bounds; }
+
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *) override
     {
-        // Draw vertices
-        for (size_t i = 0; i < coord_list.size(); ++i)
+        double lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+        double disc = 2 * VERTEX_RADIUS * lod;
+        // Disques à moitié visibles compris
+        QRectF exposed = option->exposedRect.adjusted(-VERTEX_RADIUS, -VERTEX_RADIUS, VERTEX_RADIUS, VERTEX_RADIUS);
+        RenderRect visible{exposed.left(), exposed.top(), exposed.right(), exposed.bottom()};
+
+        if (disc < DISC_MIN_PIXELS)
         {
-            double x = get<0>(coord_list[i]);
-            double y = get<1>(coord_list[i]);
-            double z = get<2>(coord_list[i]);
+            // Points de la taille du disque (au moins un pixel), seize nuances de rouge
+            painter->setRenderHint(QPainter::Antialiasing, false);
+            for (auto &points : color_points)
+            {
+                points.clear();
+            }
+            index.for_each_vertex(visible, index.cell_size() * lod < 1, [&](uint32_t v)
+            {
+                color_points[red[v] >> 4].emplace_back(index.x(v), index.y(v));
+            });
+            for (size_t c = 0; c < color_points.size(); ++c)
+            {
+                QPen pen(QColor(static_cast<int>(c << 4 | 8), 0, 0), max(1.0, disc));
+                pen.setCosmetic(true);
+                painter->setPen(pen);
+                const vector<QPointF> &points = color_points[c];
+                for (size_t i = 0; i < points.size(); i += DRAW_BATCH)
+                {
+                    painter->drawPoints(points.data() + i, static_cast<int>(min<size_t>(DRAW_BATCH, points.size() - i)));
+                }
+            }
+            return;
+        }
 
-            int r = 80 + ((z + 1000) / 2000) * (255 - 80);
-            QColor color(r, 0, 0);
+        painter->setRenderHint(QPainter::Antialiasing, true);
+        painter->setPen(QPen(Qt::black));
+        bool labels = disc >= LABEL_MIN_PIXELS;
+        if (labels)
+        {
+            painter->setFont(font);
+        }
+        index.for_each_vertex(visible, false, [&](uint32_t v)
+        {
+            QPointF center(index.x(v), index.y(v));
+            painter->setBrush(QColor(red[v], 0, 0));
+            painter->drawEllipse(center, VERTEX_RADIUS, VERTEX_RADIUS);
+            if (labels)
+            {
+                // Numéro des fichiers CSV, même si les sommets ont été renumérotés
+                QRectF box(center.x() - VERTEX_RADIUS, center.y() - VERTEX_RADIUS, 2 * VERTEX_RADIUS, 2 * VERTEX_RADIUS);
+                painter->drawText(box, Qt::AlignCenter, QString::number(numbering.external(v) + 1));
+            }
+        });
+    }
 
-            scene->addEllipse(x - 50, y - 50, 100, 100, QPen(Qt::black), QBrush(color));
+private:
+    const RenderIndex &index;
+    const VertexNumbering &numbering;
+    QRectF bounds;
+    vector<uint8_t> red;
+    QFont font;
+    std::array<vector<QPointF>, 16> color_points;
+};
 
-            auto *text = scene->addText(QString::number(i + 1));
-            text->setPos(x - (i < 10 ? 25 : 45), y - 45);
-            QFont font = text->font();
-            font.setPointSize(40);
-            text->setFont(font);
+/**
+ * @brief couche du chemin trouvé, entre les arêtes et les sommets, remplacée à chaque recherche
+ */
+class PathLayer : public QGraphicsItem
+{
+public:
+    void setPath(vector<QLineF> path_lines)
+    {
+        prepareGeometryChange();
+        lines = std::move(path_lines);
+        bounds = QRectF();
+        for (const QLineF &line : lines)
+        {
+            bounds |= QRectF(line.p1(), line.p2()).normalized();
         }
+        bounds.adjust(-EDGE_WIDTH, -EDGE_WIDTH, EDGE_WIDTH, EDGE_WIDTH);
+        update();
+    }
+
+    QRectF boundingRect() const override { return bounds; }
 
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) override
+    {
+        double lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+        painter->setPen(layer_pen(Qt::green, EDGE_WIDTH, lod));
+        painter->drawLines(lines.data(), static_cast<int>(lines.size()));
     }
 
-    void drawGraph(const Graph &g, const vector<std::tuple<double, double, double>> &coord_list)
+private:
+    vector<QLineF> lines;
+    QRectF bounds;
+};
+
+class GraphView : public QGraphicsView
+{
+public:
+    GraphView(QWidget *parent = nullptr) : QGraphicsView(parent)
     {
-        scene->clear();
+        scene = new QGraphicsScene(this);
+        // Trois éléments seulement : l'index de la scène est inutile, les couches ont le leur
+        scene->setItemIndexMethod(QGraphicsScene::NoIndex);
+        setScene(scene);
 
-        // Draw edges
-        drawEdges(g, coord_list);
+        setRenderHint(QPainter::Antialiasing);
+        setRenderHint(QPainter::TextAntialiasing);
+        setRenderHint(QPainter::SmoothPixmapTransform);
 
-        // Draw vertices
-        drawVertices(g, coord_list);
+        // Zoom à la molette autour du curseur, déplacement par glisser
+        setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
+        setDragMode(QGraphicsView::ScrollHandDrag);
+        // Redimensionnement : zoom conservé, même point de la scène au centre de la vue
+        setResizeAnchor(QGraphicsView::AnchorViewCenter);
+    }
 
+    /**
+     * @brief construction des couches du graph ; numbering (étiquettes des sommets) doit rester valide tant que la vue l'affiche
+     */
+    template <class G>
+    void drawGraph(const G &g, const CoordinateStore &coord_list, const VertexNumbering &numbering)
+    {
+        scene->clear();
+
+        index = RenderIndex::build(g, coord_list);
+        // Sélection au clic : sommet le plus proche dans le plan de la vue
+        picker = SpatialIndex::build(coord_list, true);
+        const RenderRect &box = index.bounds();
+        QRectF bounds = QRectF(box.x0, box.y0, box.x1 - box.x0, box.y1 - box.y0)
+                            .adjusted(-VERTEX_RADIUS - EDGE_WIDTH, -VERTEX_RADIUS - EDGE_WIDTH, VERTEX_RADIUS + EDGE_WIDTH, VERTEX_RADIUS + EDGE_WIDTH);
+
+        // Arêtes, chemin puis sommets au premier plan
+        auto *edges = new EdgeLayer(index, bounds);
+        pathLayer = new PathLayer();
+        auto *vertices = new VertexLayer(index, coord_list, numbering, bounds);
+        edges->setZValue(0);
+        pathLayer->setZValue(1);
+        vertices->setZValue(2);
+        scene->addItem(edges);
+        scene->addItem(pathLayer);
+        scene->addItem(vertices);
+        scene->setSceneRect(bounds);
+
+        // Nouvelle scène : graph entier affiché, jusqu'au premier zoom ou déplacement
+        fitPending = true;
         fitInView(scene->itemsBoundingRect(), Qt::KeepAspectRatio);
     }
 
-    void highlightShortestPath(const Graph &g, const vector<std::tuple<double, double, double>> &coord_list, int start, int goal)
+    /**
+     * @brief remplacement du seul tracé du chemin, sans toucher aux couches du graph
+     */
+    void drawPath(const CoordinateStore &coord_list, const PathResult &result)
     {
+        if (!pathLayer)
+        {
+            return;
+        }
+        vector<QLineF> lines;
+        const vector<Vertex> &path = result.path;
+        for (size_t i = 0; result.found && i + 1 < path.size(); ++i)
+        {
+            lines.emplace_back(coord_list.x(path[i]), coord_list.y(path[i]),
+                               coord_list.x(path[i + 1]), coord_list.y(path[i + 1]));
+        }
+        pathLayer->setPath(std::move(lines));
+    }
 
-        vector<int> distances(num_vertices(g), numeric_limits<int>::max());
-        vector<Vertex> predecessors(num_vertices(g));
+    /**
+     * @brief fonction appelée avec le sommet (numérotation interne) le plus proche d'un clic et le bouton utilisé
+     */
+    void setVertexPicked(function<void(uint32_t, Qt::MouseButton)> callback)
+    {
+        vertexPicked = std::move(callback);
+    }
 
-        dijkstra_shortest_paths(g, start,
-            predecessor_map(make_iterator_property_map(predecessors.begin(), get(vertex_index, g))).
-            distance_map(make_iterator_property_map(distances.begin(), get(vertex_index, g))).
-            weight_map(get(edge_weight, g))
-        );
+protected:
+    void mousePressEvent(QMouseEvent *event) override
+    {
+        pressPosition = event->pos();
+        QGraphicsView::mousePressEvent(event);
+    }
 
-        if (distances[goal] == numeric_limits<int>::max()) {
-            QMessageBox::warning(this, "No Path", "There is no path between the selected vertices.");
+    void mouseReleaseEvent(QMouseEvent *event) override
+    {
+        QGraphicsView::mouseReleaseEvent(event);
+        // Glisser (déplacement de la vue) : pas de sélection
+        if ((event->pos() - pressPosition).manhattanLength() > PICK_PIXELS)
+        {
+            fitPending = false;
             return;
         }
-
-        vector<Vertex> path;
-        for (Vertex v = goal; static_cast<int>(v) != static_cast<int>(start); v = predecessors[v]) {
-            path.push_back(v);
+        if (!vertexPicked)
+        {
+            return;
         }
-        path.push_back(start);
-
-        for (size_t i = 0; i < path.size() - 1; ++i)
+        QPointF p = mapToScene(event->pos());
+        NearestVertex nearest;
+        // Tolérance en unités des coordonnées : PICK_PIXELS au zoom courant, au moins le disque du sommet
+        double tolerance = max<double>(PICK_PIXELS / transform().m11(), VERTEX_RADIUS);
+        if (picker.nearest(p.x(), p.y(), 0, nearest) && nearest.distance <= tolerance)
         {
-            double x1 = get<0>(coord_list[path[i]]);
-            double y1 = get<1>(coord_list[path[i]]);
-            double x2 = get<0>(coord_list[path[i + 1]]);
-            double y2 = get<1>(coord_list[path[i + 1]]);
-
-            scene->addLine(x1, y1, x2, y2, QPen(Qt::green, 6));
+            vertexPicked(nearest.vertex, event->button());
         }
-
-        //draw again so there are on first plan
-        drawVertices(g, coord_list);
     }
 
-protected:
     void resizeEvent(QResizeEvent *event) override
     {
         QGraphicsView::resizeEvent(event);
-        fitInView(scene->itemsBoundingRect(), Qt::KeepAspectRatio);
+        // Premier affichage : la taille définitive de la vue n'est connue qu'ici
+        if (fitPending)
+        {
+            fitInView(scene->itemsBoundingRect(), Qt::KeepAspectRatio);
+        }
+    }
+
+    void wheelEvent(QWheelEvent *event) override
+    {
+        double factor = pow(1.25, event->angleDelta().y() / 120.0);
+        scale(factor, factor);
+        fitPending = false;
+        event->accept();
     }
 
 private:
     QGraphicsScene *scene;
+    RenderIndex index;
+    SpatialIndex picker;
+    PathLayer *pathLayer = nullptr;
+    bool fitPending = true;
+    function<void(uint32_t, Qt::MouseButton)> vertexPicked;
+    QPoint pressPosition;
 };
 
 class ColorLegend : public QWidget {
@@ -182,6 +414,101 @@ protected:
 };
 
 
+/**
+ * @brief recherches de chemin de l'interface, exécutées sur un thread dédié
+ *
+ * Une seule recherche à la fois : une nouvelle demande remplace celle qui attend et fait abandonner celle en
+ * cours (SearchScratch::cancel). Le résultat est remis au thread de l'interface par un appel mis en file sur
+ * receiver, avec le numéro de sa demande ; une recherche abandonnée ne remet rien.
+ */
+class PathQueryWorker
+{
+public:
+    using Task = std::function<PathResult(SearchScratch &)>;
+    // Appelée sur le thread de l'interface : numéro de la demande, résultat, durée de la recherche en millisecondes
+    using Done = std::function<void(uint64_t, const PathResult &, double)>;
+
+    PathQueryWorker(QObject *receiver, Done done) : receiver(receiver), done(std::move(done))
+    {
+        scratch.cancel = &cancel;
+        worker = std::thread([this]() { run(); });
+    }
+
+    ~PathQueryWorker()
+    {
+        {
+            lock_guard<mutex> lock(m);
+            stopping = true;
+            cancel.store(true);
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    /**
+     * @brief nouvelle demande, qui périme les précédentes
+     *
+     * @return numéro de la demande
+     */
+    uint64_t submit(Task task)
+    {
+        {
+            lock_guard<mutex> lock(m);
+            pending = std::move(task);
+            cancel.store(true);
+            latest_request = ++generation;
+        }
+        wake.notify_one();
+        return latest_request;
+    }
+
+    /**
+     * @brief numéro de la dernière demande (thread de l'interface)
+     */
+    uint64_t latest() const { return latest_request; }
+
+private:
+    void run()
+    {
+        unique_lock<mutex> lock(m);
+        for (;;)
+        {
+            wake.wait(lock, [this]() { return stopping || pending; });
+            if (stopping)
+            {
+                return;
+            }
+            Task task = std::move(pending);
+            pending = nullptr;
+            uint64_t id = generation;
+            cancel.store(false);
+            lock.unlock();
+
+            auto begin = chrono::steady_clock::now();
+            PathResult result = task(scratch);
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+            if (!result.cancelled)
+            {
+                Done callback = done;
+                QMetaObject::invokeMethod(receiver, [callback, id, result, ms]() { callback(id, result, ms); }, Qt::QueuedConnection);
+            }
+            lock.lock();
+        }
+    }
+
+    QObject *receiver;
+    Done done;
+    SearchScratch scratch;
+    std::atomic<bool> cancel{false};
+    mutex m;
+    condition_variable wake;
+    Task pending;
+    uint64_t generation = 0;
+    bool stopping = false;
+    // Copie de generation réservée au thread de l'interface
+    uint64_t latest_request = 0;
+    std::thread worker;
+};
 
 int main(int argc, char *argv[])
 {
@@ -216,41 +543,118 @@ int main(int argc, char *argv[])
     cout << "|                                                           |" << endl;
     cout << "+-----------------------------------------------------------+\n" << endl;
 
-    Graph g;
-
     const string filename_edges = "data/edges.csv";
     const string filename_nodes = "data/nodes.csv";
-    vector<string> edges;
-    vector<string> nodes;
 
-    readCSV(filename_edges, edges);
-    readCSV(filename_nodes, nodes);
+    const string filename_cache = "data/graph.bin";
+
+    // Option --ch : hiérarchie de contraction prétraitée une fois et enregistrée à côté des données
+    // Option --tree-cache-mb N : budget mémoire du cache des arbres de plus courts chemins
+    // Option --path-matrix : export binaire des arbres de plus courts chemins au lieu du CSV
+    // Option --per-vertex : affichage du degré de chaque sommet
+    // Option --metrics-json F : écriture des métriques du graph au format JSON
+    // Option --engine binary|radix|buckets|delta : file de priorité des recherches de Dijkstra
+    // Option --weights double|float : précision du calcul des poids des arêtes au chargement
+    // Option --reorder hilbert|morton|rcm : renumérotation des sommets pour la localité mémoire (numéros des CSV conservés à l'affichage)
+    // Option --instrumentation F : temps par phase et compteurs écrits à la fermeture (JSON, ou texte Prometheus si F finit par .prom)
+    const string filename_ch = "data/graph.ch";
+    bool use_ch = false;
+    size_t tree_cache_budget = ShortestPathTreeCache::DEFAULT_BUDGET_BYTES;
+    ComputeOptions options;
+    string instrumentation_file;
+    VertexOrdering ordering = VertexOrdering::None;
+    WeightPrecision precision = WeightPrecision::Double;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--ch")
+        {
+            use_ch = true;
+        }
+        else if (arg == "--path-matrix")
+        {
+            options.format = ExportFormat::PathMatrix;
+        }
+        else if (arg == "--per-vertex")
+        {
+            options.per_vertex = true;
+        }
+        else if (arg == "--metrics-json" && i + 1 < argc)
+        {
+            options.metrics_json = argv[++i];
+        }
+        else if (arg == "--tree-cache-mb" && i + 1 < argc)
+        {
+            tree_cache_budget = static_cast<size_t>(strtoull(argv[++i], nullptr, 10)) << 20;
+        }
+        else if (arg == "--engine" && i + 1 < argc)
+        {
+            SearchEngine engine;
+            if (parse_search_engine(argv[++i], engine))
+            {
+                set_default_search_engine(engine);
+            }
+            else
+            {
+                cerr << "File de priorité inconnue : " << argv[i] << endl;
+            }
+        }
+        else if (arg == "--weights" && i + 1 < argc)
+        {
+            if (!parse_weight_precision(argv[++i], precision))
+            {
+                cerr << "Précision des poids inconnue : " << argv[i] << endl;
+            }
+        }
+        else if (arg == "--reorder" && i + 1 < argc)
+        {
+            if (!parse_vertex_ordering(argv[++i], ordering))
+            {
+                cerr << "Ordre des sommets inconnu : " << argv[i] << endl;
+            }
+        }
+        else if (arg == "--instrumentation" && i + 1 < argc)
+        {
+            instrumentation_file = argv[++i];
+        }
+    }
+
+    // Options lues avant le chargement : la précision des poids fait partie de l'empreinte du cache
+    GraphCacheKey cache_key;
+    CoordinateStore coord_list;
+    CSRGraph g;
+    // Cycles détectés sur les arêtes dès le chargement, repris à l'étape 4
+    CycleAnalysis cycles;
 
-    vector<pair<int, int>> edge_list;
-    for (const auto &line : edges)
+    if (!load_graph(filename_nodes, filename_edges, filename_cache, coord_list, g, cache_key, 0, precision, &cycles))
     {
-        int node1, node2;
-        sscanf(line.c_str(), "%d;%d", &node1, &node2);
-        edge_list.emplace_back(node1 - 1, node2 - 1);
+        return 1;
     }
+    options.cycles = &cycles;
 
-    vector<std::tuple<double, double, double>> coord_list;
-    for (const auto &line : nodes)
+    // Correspondance avec les identifiants des CSV : export, console, saisie et étiquettes de la vue
+    VertexNumbering numbering;
+    if (ordering != VertexOrdering::None)
     {
-        int node_id;
-        double x, y, z;
-        sscanf(line.c_str(), "%d;%lf;%lf;%lf", &node_id, &x, &y, &z);
-        coord_list.emplace_back(x, y, z);
+        ReorderReport report;
+        numbering = reorder_vertices(g, coord_list, ordering, numbering, report);
+        print_reorder_report(cout, report);
+        cache_key.ordering = static_cast<uint32_t>(ordering);
     }
+    options.numbering = &numbering;
 
-    for (const auto &edge : edge_list)
+    // Partagé par l'export et le bouton « Find Path » : une source déjà calculée ne relance pas de recherche
+    ShortestPathTreeCache path_cache(tree_cache_budget);
+    options.cache = &path_cache;
+
+    ContractionHierarchy ch;
+    if (use_ch)
     {
-        double distance = calcul_distance(edge.first, edge.second, coord_list);
-        add_edge(edge.first, edge.second, property<edge_weight_t, float>(distance), g);
-        add_edge(edge.second, edge.first, property<edge_weight_t, float>(distance), g); // Add reverse edge for undirected graph
+        load_or_build_contraction_hierarchy(g, filename_ch, cache_key, ch);
+        options.ch = &ch;
     }
 
-    compute_graph(g, coord_list);
+    compute_graph(g, coord_list, options);
 
     QWidget mainWidget;
     mainWidget.setWindowTitle("Graph Visualization");
@@ -274,8 +678,20 @@ int main(int argc, char *argv[])
     findPathButton->setFont(QFont("Arial", 12));
     findPathButton->setStyleSheet("background-color:rgb(139, 139, 139); color: white;");
 
+    // Ordre des entrées identique à celui de SearchMode
+    QComboBox *searchModeInput = new QComboBox();
+    searchModeInput->addItems({"Dijkstra", "A*", "Bidirectional"});
+    if (use_ch)
+    {
+        searchModeInput->addItem("Contraction hierarchy");
+    }
+    searchModeInput->setCurrentIndex(static_cast<int>(SearchMode::AStar));
+    searchModeInput->setFixedHeight(40);
+    searchModeInput->setFont(QFont("Arial", 12));
+
     inputLayout->addWidget(startVertexInput);
     inputLayout->addWidget(goalVertexInput);
+    inputLayout->addWidget(searchModeInput);
     inputLayout->addWidget(findPathButton);
 
     mainLayout->addLayout(inputLayout);
@@ -286,7 +702,7 @@ int main(int argc, char *argv[])
     QHBoxLayout *layout2D = new QHBoxLayout(tab2D);
     GraphView *graphView = new GraphView();
     graphView->resize(WIDTH, HEIGHT);
-    graphView->drawGraph(g, coord_list);
+    graphView->drawGraph(g, coord_list, numbering);
     layout2D->addWidget(graphView);
 
     ColorLegend *colorLegend = new ColorLegend();
@@ -298,6 +714,45 @@ int main(int argc, char *argv[])
 
     mainLayout->addWidget(tabWidget);
 
+    QLabel *statusLabel = new QLabel("Enter two vertices, or click them in the view (left: start, right: goal), and press Find Path.");
+    statusLabel->setFont(QFont("Arial", 11));
+    mainLayout->addWidget(statusLabel);
+
+    // Clic gauche : départ, clic droit : arrivée, saisis dans la numérotation des CSV
+    graphView->setVertexPicked([&](uint32_t v, Qt::MouseButton button) {
+        QString label = QString::number(numbering.external(v) + 1);
+        if (button == Qt::LeftButton)
+        {
+            startVertexInput->setText(label);
+            statusLabel->setText("Start vertex " + label);
+        }
+        else if (button == Qt::RightButton)
+        {
+            goalVertexInput->setText(label);
+            statusLabel->setText("Goal vertex " + label);
+        }
+    });
+
+    // Recherches hors du thread de l'interface ; seule la couche du chemin est remplacée à l'arrivée du résultat.
+    // Le graph, les coordonnées et la hiérarchie ne changent plus : le thread de recherche les lit sans verrou
+    CHQueryScratch ch_scratch;
+    PathQueryWorker worker(graphView, [&](uint64_t id, const PathResult &result, double ms) {
+        if (id != worker.latest())
+        {
+            return;
+        }
+        graphView->drawPath(coord_list, result);
+        QString status = QString("%1 ms, %2 settled vertices").arg(ms, 0, 'f', 2).arg(static_cast<qulonglong>(result.settled));
+        if (result.found)
+        {
+            statusLabel->setText(QString("Path length %1 (%2 vertices) found in ").arg(result.length).arg(static_cast<qulonglong>(result.path.size())) + status);
+        }
+        else
+        {
+            statusLabel->setText("No path between the selected vertices, searched in " + status);
+        }
+    });
+
     QObject::connect(findPathButton, &QPushButton::clicked, [&]() {
         bool ok1, ok2;
         int start = startVertexInput->text().toInt(&ok1) - 1;
@@ -308,8 +763,40 @@ int main(int argc, char *argv[])
             static_cast<decltype(num_vertices(g))>(start) < num_vertices(g) && 
             static_cast<decltype(num_vertices(g))>(goal) < num_vertices(g))
     {
-            graphView->drawGraph(g, coord_list);
-            graphView->highlightShortestPath(g, coord_list, start, goal);
+            // Saisie dans la numérotation des CSV
+            Vertex external_start = start, external_goal = goal;
+            start = static_cast<int>(numbering.internal(start));
+            goal = static_cast<int>(numbering.internal(goal));
+            statusLabel->setText(QString("Searching %1 -> %2...").arg(static_cast<qulonglong>(external_start + 1)).arg(static_cast<qulonglong>(external_goal + 1)));
+            if (use_ch && searchModeInput->currentIndex() == searchModeInput->count() - 1)
+            {
+                // Recherches montantes dans la hiérarchie, raccourcis dépliés en chemin du graph d'origine
+                worker.submit([&, start, goal](SearchScratch &) {
+                    PathResult result = ch.query(start, goal, ch_scratch);
+                    cout << "Contraction hierarchy " << numbering.external(start) + 1 << " -> " << numbering.external(goal) + 1 << " : " << result.settled << " settled vertices" << endl;
+                    return result;
+                });
+            }
+            else
+            {
+                // Source déjà calculée : simple remontée des prédécesseurs de son arbre en cache ; sinon requête point
+                // à point (A* guidé par les coordonnées par défaut), ou arbre complet mis en cache en mode Dijkstra et
+                // dès la deuxième demande depuis la même source dans les autres modes
+                SearchMode mode = static_cast<SearchMode>(searchModeInput->currentIndex());
+                worker.submit([&, start, goal, mode](SearchScratch &scratch) {
+                    PathResult result = shortest_path_query(g, coord_list, start, goal, mode, scratch, path_cache);
+                    if (result.cancelled)
+                    {
+                        cout << search_mode_name(mode) << " " << numbering.external(start) + 1 << " -> " << numbering.external(goal) + 1 << " : cancelled after " << result.settled << " settled vertices" << endl;
+                    }
+                    else
+                    {
+                        cout << search_mode_name(mode) << " " << numbering.external(start) + 1 << " -> " << numbering.external(goal) + 1 << " : " << result.settled << " settled vertices"
+                             << " (tree cache: " << path_cache.hits() << " hits, " << path_cache.misses() << " misses)" << endl;
+                    }
+                    return result;
+                });
+            }
         } else {
             QMessageBox::warning(&mainWidget, "Invalid Input", "Please enter valid vertex numbers.");
         }
@@ -317,7 +804,12 @@ int main(int argc, char *argv[])
 
     mainWidget.show();
 
-    return app.exec();
+    int status = app.exec();
+    if (!instrumentation_file.empty() && write_instrumentation(instrumentation_file))
+    {
+        cout << "Instrumentation written to '" << instrumentation_file << "'" << endl;
+    }
+    return status;
 }
 
 
@@ -0,0 +1,202 @@
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include "path_matrix.h"
+#include "path_search.h"
+#include "ordered_writer.h"
+#include "vertex_order.h"
+
+using namespace std;
+using namespace boost;
+
+static const char PATH_MATRIX_MAGIC[8] = {'P', 'A', 'T', 'H', 'M', 'A', 'T', '1'};
+
+static size_t align8(size_t bytes)
+{
+    return (bytes + 7) & ~size_t(7);
+}
+
+template <class G>
+static void write_path_matrix_impl(const G &g, const vector<pair<double, double>> &list_Node, const VertexNumbering &numbering, const string &filename,
+                                   unsigned num_threads)
+{
+    ofstream file(filename, ios::out | ios::binary | ios::trunc);
+
+    if (!file.is_open()) {
+        cerr << "Impossible d'ouvrir le fichier de sortie" << endl;
+        return;
+    }
+
+    size_t n = num_vertices(g);
+    PairBatches batches = group_pairs_by_source(list_Node, n);
+    size_t k = batches.size();
+
+    PathMatrixHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PATH_MATRIX_MAGIC, sizeof(header.magic));
+    header.version = PATH_MATRIX_VERSION;
+    header.header_size = sizeof(PathMatrixHeader);
+    header.num_vertices = n;
+    header.num_sources = k;
+    header.index_offset = align8(sizeof(PathMatrixHeader));
+    header.row_size = align8(n * sizeof(uint32_t)) + n * sizeof(double);
+
+    // Lignes dans l'ordre des sources de list_Node, index trié par source pour la recherche dichotomique
+    uint64_t rows_offset = header.index_offset + k * sizeof(PathMatrixIndexEntry);
+    vector<PathMatrixIndexEntry> index(k);
+    for (size_t b = 0; b < k; ++b) {
+        index[b] = {static_cast<uint32_t>(numbering.external(batches.sources[b])), 0, rows_offset + b * header.row_size};
+    }
+    sort(index.begin(), index.end(), [](const PathMatrixIndexEntry &a, const PathMatrixIndexEntry &b) { return a.source < b.source; });
+
+    const char padding[8] = {};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(padding, header.index_offset - sizeof(header));
+    file.write(reinterpret_cast<const char *>(index.data()), index.size() * sizeof(PathMatrixIndexEntry));
+
+    struct RowWorker
+    {
+        RowWorker() { scratch.engine_threads = 1; }
+        SearchScratch scratch;
+        vector<uint32_t> predecessors;
+        vector<double> distances;
+    };
+
+    // Une tranche par source : arbre complet calculé en parallèle, lignes écrites dans l'ordre
+    num_threads = resolve_num_threads(num_threads, k);
+    write_chunks_in_order<RowWorker>(file, k, num_threads, [&](RowWorker &w, size_t b, string &row) {
+        dijkstra_to_goals(g, batches.sources[b], {}, w.scratch);
+
+        // Sommets et prédécesseurs dans la numérotation des fichiers, même après renumérotation
+        const vector<double> *distances = &w.scratch.distances;
+        const vector<uint32_t> *predecessors = &w.scratch.predecessors;
+        if (numbering.renumbered()) {
+            w.predecessors.resize(n);
+            w.distances.resize(n);
+            for (size_t v = 0; v < n; ++v) {
+                Vertex u = numbering.internal(v);
+                w.predecessors[v] = static_cast<uint32_t>(numbering.external(w.scratch.predecessors[u]));
+                w.distances[v] = w.scratch.distances[u];
+            }
+            distances = &w.distances;
+            predecessors = &w.predecessors;
+        }
+        row.reserve(header.row_size);
+        row.append(reinterpret_cast<const char *>(predecessors->data()), n * sizeof(uint32_t));
+        row.append(padding, align8(n * sizeof(uint32_t)) - n * sizeof(uint32_t));
+        row.append(reinterpret_cast<const char *>(distances->data()), n * sizeof(double));
+    });
+
+    file.close();
+    if (!file) {
+        cerr << "Erreur d'écriture du fichier '" << filename << "'" << endl;
+        return;
+    }
+    cout << "Matrice de prédécesseurs '" << filename << "' générée avec succès (" << k << " sources)." << endl;
+}
+
+void write_path_matrix(const Graph &g, const vector<pair<double, double>> &list_Node, const VertexNumbering &numbering, const string &filename,
+                       unsigned num_threads)
+{
+    write_path_matrix_impl(g, list_Node, numbering, filename, num_threads);
+}
+
+void write_path_matrix(const CSRGraph &g, const vector<pair<double, double>> &list_Node, const VertexNumbering &numbering, const string &filename,
+                       unsigned num_threads)
+{
+    write_path_matrix_impl(g, list_Node, numbering, filename, num_threads);
+}
+
+void write_path_matrix(const CompactGraph &g, const vector<pair<double, double>> &list_Node, const VertexNumbering &numbering, const string &filename,
+                       unsigned num_threads)
+{
+    write_path_matrix_impl(g, list_Node, numbering, filename, num_threads);
+}
+
+bool PathMatrixReader::open(const string &filename)
+{
+    file = make_unique<MappedFile>(filename);
+    index.clear();
+    n = 0;
+    if (!file->is_open() || file->size() < sizeof(PathMatrixHeader)) {
+        cerr << "Impossible de lire la matrice '" << filename << "'" << endl;
+        return false;
+    }
+
+    PathMatrixHeader header;
+    memcpy(&header, file->data(), sizeof(header));
+    if (memcmp(header.magic, PATH_MATRIX_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != PATH_MATRIX_VERSION || header.header_size != sizeof(PathMatrixHeader)) {
+        cerr << "Matrice '" << filename << "' d'un format différent" << endl;
+        return false;
+    }
+
+    uint64_t rows_offset = header.index_offset + header.num_sources * sizeof(PathMatrixIndexEntry);
+    if (header.row_size != align8(header.num_vertices * sizeof(uint32_t)) + header.num_vertices * sizeof(double) ||
+        file->size() != rows_offset + header.num_sources * header.row_size) {
+        cerr << "Matrice '" << filename << "' tronquée ou corrompue" << endl;
+        return false;
+    }
+
+    index.resize(header.num_sources);
+    memcpy(index.data(), file->data() + header.index_offset, index.size() * sizeof(PathMatrixIndexEntry));
+    n = header.num_vertices;
+    return true;
+}
+
+vector<Vertex> PathMatrixReader::sources() const
+{
+    vector<Vertex> result;
+    result.reserve(index.size());
+    for (const auto &entry : index) {
+        result.push_back(entry.source);
+    }
+    return result;
+}
+
+const PathMatrixIndexEntry *PathMatrixReader::find(Vertex source) const
+{
+    auto it = lower_bound(index.begin(), index.end(), source, [](const PathMatrixIndexEntry &e, Vertex s) { return e.source < s; });
+    if (it == index.end() || it->source != source) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+bool PathMatrixReader::has_source(Vertex source) const
+{
+    return find(source) != nullptr;
+}
+
+bool PathMatrixReader::path(Vertex source, Vertex goal, vector<Vertex> &path, double &length) const
+{
+    path.clear();
+    length = numeric_limits<double>::max();
+    const PathMatrixIndexEntry *entry = find(source);
+    if (!entry || goal >= n) {
+        return false;
+    }
+
+    // Lignes alignées sur 8 octets dans le fichier projeté : lecture directe des tableaux
+    const char *row = file->data() + entry->offset;
+    const uint32_t *predecessors = reinterpret_cast<const uint32_t *>(row);
+    const double *distances = reinterpret_cast<const double *>(row + align8(n * sizeof(uint32_t)));
+
+    if (distances[goal] == numeric_limits<double>::max()) {
+        return false;
+    }
+    for (Vertex v = goal; v != source; v = predecessors[v]) {
+        if (v == predecessors[v]) {
+            cerr << "Erreur dans le chemin, arrêt prématuré" << endl;
+            path.clear();
+            return false;
+        }
+        path.push_back(v);
+    }
+    path.push_back(source);
+    reverse(path.begin(), path.end());
+    length = distances[goal];
+    return true;
+}
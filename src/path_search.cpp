@@ -0,0 +1,648 @@
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <charconv>
+#include "path_search.h"
+#include "vertex_order.h"
+#include "instrumentation.h"
+
+using namespace std;
+using namespace boost;
+
+void SearchScratch::resize(size_t n)
+{
+    distances.assign(n, numeric_limits<double>::max());
+    predecessors.resize(n);
+    for (size_t v = 0; v < n; ++v) {
+        predecessors[v] = v;
+    }
+    goal_epoch.assign(n, 0);
+    touched.clear();
+    heap.clear();
+    epoch = 0;
+    settled = 0;
+    cancelled = false;
+}
+
+void SearchScratch::reset()
+{
+    for (uint32_t v : touched) {
+        distances[v] = numeric_limits<double>::max();
+        predecessors[v] = v;
+    }
+    touched.clear();
+    heap.clear();
+    settled = 0;
+    cancelled = false;
+}
+
+size_t SearchScratch::mark_goals(const vector<Vertex> &goals)
+{
+    if (++epoch == 0) {
+        fill(goal_epoch.begin(), goal_epoch.end(), 0);
+        epoch = 1;
+    }
+    size_t marked = 0;
+    for (Vertex t : goals) {
+        if (goal_epoch[t] != epoch) {
+            goal_epoch[t] = epoch;
+            marked++;
+        }
+    }
+    return marked;
+}
+
+void SearchScratch::prepare(size_t n)
+{
+    if (distances.size() != n) {
+        resize(n);
+    } else {
+        reset();
+    }
+}
+
+size_t SearchScratch::memory_used() const
+{
+    size_t bytes = distances.capacity() * sizeof(double) + predecessors.capacity() * sizeof(uint32_t) +
+                   touched.capacity() * sizeof(uint32_t) + goal_epoch.capacity() * sizeof(uint32_t) +
+                   heap.capacity() * sizeof(heap[0]);
+    for (const auto &bucket : queues.radix) {
+        bytes += bucket.capacity() * sizeof(bucket[0]);
+    }
+    for (const auto &bucket : queues.buckets) {
+        bytes += bucket.capacity() * sizeof(bucket[0]);
+    }
+    for (const auto &bucket : queues.delta_buckets) {
+        bytes += bucket.capacity() * sizeof(bucket[0]);
+    }
+    bytes += queues.overflow.capacity() * sizeof(queues.overflow[0]) + queues.capacity * sizeof(std::atomic<uint64_t>) +
+             queues.relaxed.capacity() * sizeof(double) + queues.removed.capacity() * sizeof(queues.removed[0]);
+    if (backward) {
+        bytes += backward->memory_used();
+    }
+    return bytes;
+}
+
+CSVLoadResult read_pairs(istream &in, vector<pair<double, double>> &list_Node)
+{
+    CSVLoadResult result;
+    result.opened = true;
+    size_t line_number = 0;
+    bool first = true;
+    string line;
+    auto fail = [&](const string &message) {
+        if (result.errors.size() < CSVLoadResult::MAX_REPORTED) {
+            result.errors.push_back({line_number, message});
+        }
+        result.malformed++;
+    };
+
+    while (getline(in, line)) {
+        ++line_number;
+        const char *p = line.data(), *end = line.data() + line.size();
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+        if (p == end) {
+            continue;
+        }
+        // En-tête "Start;End" (colonnes de l'export) sur la première ligne seulement
+        if (first && line.compare(p - line.data(), 9, "Start;End") == 0) {
+            first = false;
+            continue;
+        }
+        first = false;
+
+        // Deux valeurs séparées par ';', colonnes suivantes d'une ligne d'export ignorées
+        double values[2];
+        string error;
+        for (int k = 0; k < 2 && error.empty(); ++k) {
+            while (p < end && (*p == ' ' || *p == '\t')) ++p;
+            auto [ptr, ec] = from_chars(p, end, values[k]);
+            if (ec != errc() || ptr == p || !isfinite(values[k])) {
+                error = "sommet invalide : '" + string(p, find(p, end, ';')) + "' (\"départ;arrivée\" attendu)";
+                break;
+            }
+            p = ptr;
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+            if (k == 0) {
+                if (p == end || *p != ';') {
+                    error = "séparateur ';' attendu (\"départ;arrivée\" attendu)";
+                } else {
+                    ++p;
+                }
+            } else if (p != end && *p != ';') {
+                error = "caractères inattendus après l'arrivée";
+            }
+        }
+        if (!error.empty()) {
+            fail(error);
+            continue;
+        }
+        list_Node.push_back({values[0], values[1]});
+        result.records++;
+    }
+    return result;
+}
+
+PairBatches group_pairs_by_source(const vector<pair<double, double>> &list_Node, size_t n)
+{
+    const size_t NONE = numeric_limits<size_t>::max();
+    PairBatches batches;
+    batches.n = n;
+    vector<size_t> batch_of(n, NONE);
+    vector<size_t> counts;
+    size_t current = NONE;
+
+    // Premier passage : validation, ordre de première apparition des sources et détection des plages contiguës
+    for (size_t r = 0; r < list_Node.size(); ++r) {
+        const auto &[start, goal] = list_Node[r];
+        if (!valid_pair(start, goal, n)) {
+            cerr << "Erreur : Indices de sommet invalides (" << start << ", " << goal << ")" << endl;
+            continue;
+        }
+
+        Vertex start_idx = start - 1;
+        if (batch_of[start_idx] == NONE) {
+            batch_of[start_idx] = batches.sources.size();
+            batches.sources.push_back(start_idx);
+            batches.offsets.push_back(r);
+            counts.push_back(0);
+        } else if (batch_of[start_idx] != current) {
+            batches.contiguous = false;
+        }
+        current = batch_of[start_idx];
+        counts[current]++;
+    }
+
+    if (batches.contiguous) {
+        batches.offsets.push_back(list_Node.size());
+        return batches;
+    }
+
+    // Second passage : tri par dénombrement des lignes selon leur source (stable)
+    batches.offsets.assign(batches.size() + 1, 0);
+    for (size_t b = 0; b < batches.size(); ++b) {
+        batches.offsets[b + 1] = batches.offsets[b] + counts[b];
+    }
+    batches.rows.resize(batches.offsets.back());
+    vector<size_t> cursor(batches.offsets.begin(), batches.offsets.end() - 1);
+    for (size_t r = 0; r < list_Node.size(); ++r) {
+        const auto &[start, goal] = list_Node[r];
+        if (valid_pair(start, goal, n)) {
+            batches.rows[cursor[batch_of[static_cast<Vertex>(start - 1)]]++] = r;
+        }
+    }
+    return batches;
+}
+
+template <class G>
+static void dijkstra_to_goals_impl(const G &g, Vertex source, const vector<Vertex> &goals, SearchScratch &scratch)
+{
+    using VertexG = typename graph_traits<G>::vertex_descriptor;
+    ScopedTimer timer(Phase::Search);
+    scratch.prepare(num_vertices(g));
+
+    auto &distances = scratch.distances;
+    auto &predecessors = scratch.predecessors;
+    auto &heap = scratch.heap;
+    auto weight = get(edge_weight, g);
+    greater<pair<double, Vertex>> cmp;
+
+    size_t remaining = scratch.mark_goals(goals);
+    bool stop_at_goals = remaining > 0;
+
+    SearchCounters counters;
+    distances[source] = 0;
+    scratch.touched.push_back(source);
+    heap.emplace_back(0.0, source);
+    counters.pushes++;
+
+    while (!heap.empty()) {
+        pop_heap(heap.begin(), heap.end(), cmp);
+        auto [d, u] = heap.back();
+        heap.pop_back();
+        counters.pops++;
+
+        // Entrée périmée : le sommet a déjà été fixé avec une distance plus courte
+        if (d > distances[u]) {
+            continue;
+        }
+        scratch.settled++;
+        if (scratch.poll_cancel(scratch.settled)) {
+            break;
+        }
+
+        if (stop_at_goals && scratch.goal_epoch[u] == scratch.epoch && --remaining == 0) {
+            break;
+        }
+
+        for (auto [ei, ei_end] = out_edges(static_cast<VertexG>(u), g); ei != ei_end; ++ei) {
+            Vertex v = target(*ei, g);
+            double nd = d + get(weight, *ei);
+            counters.relaxations++;
+            if (nd < distances[v]) {
+                if (distances[v] == numeric_limits<double>::max()) {
+                    scratch.touched.push_back(v);
+                }
+                distances[v] = nd;
+                predecessors[v] = u;
+                heap.emplace_back(nd, v);
+                push_heap(heap.begin(), heap.end(), cmp);
+                counters.pushes++;
+            }
+        }
+    }
+
+    counters.settled = scratch.settled;
+    record_search(counters);
+}
+
+void dijkstra_to_goals(const Graph &g, Vertex source, const vector<Vertex> &goals, SearchScratch &scratch)
+{
+    if (scratch.engine != SearchEngine::BinaryHeap) {
+        engine_dijkstra(g, source, goals, scratch);
+        return;
+    }
+    dijkstra_to_goals_impl(g, source, goals, scratch);
+}
+
+void dijkstra_to_goals(const CSRGraph &g, Vertex source, const vector<Vertex> &goals, SearchScratch &scratch)
+{
+    if (scratch.engine != SearchEngine::BinaryHeap) {
+        engine_dijkstra(g, source, goals, scratch);
+        return;
+    }
+    dijkstra_to_goals_impl(g, source, goals, scratch);
+}
+
+void dijkstra_to_goals(const CompactGraph &g, Vertex source, const vector<Vertex> &goals, SearchScratch &scratch)
+{
+    if (scratch.engine != SearchEngine::BinaryHeap) {
+        engine_dijkstra(g, source, goals, scratch);
+        return;
+    }
+    dijkstra_to_goals_impl(g, source, goals, scratch);
+}
+
+template <class G>
+static void astar_to_goal_impl(const G &g, const CoordinateStore &coord_list, Vertex source, Vertex goal, SearchScratch &scratch)
+{
+    using VertexG = typename graph_traits<G>::vertex_descriptor;
+    ScopedTimer timer(Phase::Search);
+    scratch.prepare(num_vertices(g));
+
+    auto &distances = scratch.distances;
+    auto &predecessors = scratch.predecessors;
+    auto &heap = scratch.heap;
+    auto weight = get(edge_weight, g);
+    greater<pair<double, Vertex>> cmp;
+
+    // Minoration relative couvrant l'arrondi en float des poids (et leur calcul en float, WeightPrecision::Float),
+    // pour garder l'heuristique consistante
+    const double HEURISTIC_SCALE = 1.0 - 1e-6;
+    auto heuristic = [&](Vertex v) {
+        return HEURISTIC_SCALE * coord_list.distance(v, goal);
+    };
+
+    SearchCounters counters;
+    distances[source] = 0;
+    scratch.touched.push_back(source);
+    heap.emplace_back(heuristic(source), source);
+    counters.pushes++;
+
+    while (!heap.empty()) {
+        pop_heap(heap.begin(), heap.end(), cmp);
+        auto [f, u] = heap.back();
+        heap.pop_back();
+        counters.pops++;
+
+        // Entrée périmée : la clé ne correspond plus à la distance courante
+        if (f > distances[u] + heuristic(u)) {
+            continue;
+        }
+        scratch.settled++;
+        if (scratch.poll_cancel(scratch.settled)) {
+            break;
+        }
+
+        if (u == goal) {
+            break;
+        }
+
+        double d = distances[u];
+        for (auto [ei, ei_end] = out_edges(static_cast<VertexG>(u), g); ei != ei_end; ++ei) {
+            Vertex v = target(*ei, g);
+            double nd = d + get(weight, *ei);
+            counters.relaxations++;
+            if (nd < distances[v]) {
+                if (distances[v] == numeric_limits<double>::max()) {
+                    scratch.touched.push_back(v);
+                }
+                distances[v] = nd;
+                predecessors[v] = u;
+                heap.emplace_back(nd + heuristic(v), v);
+                push_heap(heap.begin(), heap.end(), cmp);
+                counters.pushes++;
+            }
+        }
+    }
+
+    counters.settled = scratch.settled;
+    record_search(counters);
+}
+
+void astar_to_goal(const Graph &g, const CoordinateStore &coord_list, Vertex source, Vertex goal, SearchScratch &scratch)
+{
+    astar_to_goal_impl(g, coord_list, source, goal, scratch);
+}
+
+void astar_to_goal(const CSRGraph &g, const CoordinateStore &coord_list, Vertex source, Vertex goal, SearchScratch &scratch)
+{
+    astar_to_goal_impl(g, coord_list, source, goal, scratch);
+}
+
+void astar_to_goal(const CompactGraph &g, const CoordinateStore &coord_list, Vertex source, Vertex goal, SearchScratch &scratch)
+{
+    astar_to_goal_impl(g, coord_list, source, goal, scratch);
+}
+
+template <class G>
+static bool bidirectional_dijkstra_impl(const G &g, Vertex source, Vertex goal, SearchScratch &scratch, Vertex &meeting)
+{
+    using VertexG = typename graph_traits<G>::vertex_descriptor;
+    constexpr bool has_in_edges = std::is_convertible<typename graph_traits<G>::traversal_category, bidirectional_graph_tag>::value;
+    const double INF = numeric_limits<double>::max();
+
+    ScopedTimer timer(Phase::Search);
+    if (!scratch.backward) {
+        scratch.backward = make_unique<SearchScratch>();
+    }
+    SearchScratch &fwd = scratch;
+    SearchScratch &bwd = *scratch.backward;
+    fwd.prepare(num_vertices(g));
+    bwd.prepare(num_vertices(g));
+
+    auto weight = get(edge_weight, g);
+    greater<pair<double, Vertex>> cmp;
+
+    double best = INF;
+    meeting = source;
+    if (source == goal) {
+        fwd.distances[source] = 0;
+        fwd.touched.push_back(source);
+        return true;
+    }
+
+    fwd.distances[source] = 0;
+    fwd.touched.push_back(source);
+    fwd.heap.emplace_back(0.0, source);
+    bwd.distances[goal] = 0;
+    bwd.touched.push_back(goal);
+    bwd.heap.emplace_back(0.0, goal);
+    SearchCounters counters;
+    counters.pushes = 2;
+
+    auto relax = [&](SearchScratch &side, const SearchScratch &other, Vertex u, Vertex v, double nd) {
+        counters.relaxations++;
+        if (nd < side.distances[v]) {
+            if (side.distances[v] == INF) {
+                side.touched.push_back(v);
+            }
+            side.distances[v] = nd;
+            side.predecessors[v] = u;
+            side.heap.emplace_back(nd, v);
+            push_heap(side.heap.begin(), side.heap.end(), cmp);
+            counters.pushes++;
+        }
+        if (other.distances[v] != INF && nd + other.distances[v] < best) {
+            best = nd + other.distances[v];
+            meeting = v;
+        }
+    };
+
+    while (!fwd.heap.empty() && !bwd.heap.empty()) {
+        // Règle d'arrêt : aucun chemin passant par un sommet non fixé ne peut améliorer best
+        if (fwd.heap.front().first + bwd.heap.front().first >= best) {
+            break;
+        }
+
+        // Expansion du côté dont la file est la plus petite
+        bool forward = fwd.heap.size() <= bwd.heap.size();
+        SearchScratch &side = forward ? fwd : bwd;
+        SearchScratch &other = forward ? bwd : fwd;
+
+        pop_heap(side.heap.begin(), side.heap.end(), cmp);
+        auto [d, u] = side.heap.back();
+        side.heap.pop_back();
+        counters.pops++;
+        if (d > side.distances[u]) {
+            continue;
+        }
+        side.settled++;
+        if (fwd.poll_cancel(counters.pops)) {
+            break;
+        }
+
+        if (forward || !has_in_edges) {
+            for (auto [ei, ei_end] = out_edges(static_cast<VertexG>(u), g); ei != ei_end; ++ei) {
+                relax(side, other, u, target(*ei, g), d + get(weight, *ei));
+            }
+        } else if constexpr (has_in_edges) {
+            for (auto [ei, ei_end] = in_edges(static_cast<VertexG>(u), g); ei != ei_end; ++ei) {
+                relax(side, other, u, boost::source(*ei, g), d + get(weight, *ei));
+            }
+        }
+    }
+
+    fwd.settled += bwd.settled;
+    counters.settled = fwd.settled;
+    record_search(counters);
+    return best != INF && !fwd.cancelled;
+}
+
+bool bidirectional_dijkstra(const Graph &g, Vertex source, Vertex goal, SearchScratch &scratch, Vertex &meeting)
+{
+    return bidirectional_dijkstra_impl(g, source, goal, scratch, meeting);
+}
+
+bool bidirectional_dijkstra(const CSRGraph &g, Vertex source, Vertex goal, SearchScratch &scratch, Vertex &meeting)
+{
+    return bidirectional_dijkstra_impl(g, source, goal, scratch, meeting);
+}
+
+bool bidirectional_dijkstra(const CompactGraph &g, Vertex source, Vertex goal, SearchScratch &scratch, Vertex &meeting)
+{
+    return bidirectional_dijkstra_impl(g, source, goal, scratch, meeting);
+}
+
+/**
+ * @brief plus petit poids d'un arc u -> v (arcs parallèles possibles)
+ */
+template <class G>
+static double arc_weight(const G &g, Vertex u, Vertex v)
+{
+    using VertexG = typename graph_traits<G>::vertex_descriptor;
+    auto weight = get(edge_weight, g);
+    double best = numeric_limits<double>::max();
+    for (auto [ei, ei_end] = out_edges(static_cast<VertexG>(u), g); ei != ei_end; ++ei) {
+        if (target(*ei, g) == v) {
+            best = min<double>(best, get(weight, *ei));
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief assemblage du chemin start -> meeting -> goal d'une recherche bidirectionnelle
+ *
+ * La longueur est recalculée dans l'ordre du chemin, comme la somme cumulée d'un Dijkstra classique,
+ * pour obtenir exactement la même valeur.
+ */
+template <class G>
+static void join_bidirectional_path(const G &g, const SearchScratch &scratch, Vertex start, Vertex goal, Vertex meeting, PathResult &result)
+{
+    if (!extract_path(scratch, start, meeting, result.path)) {
+        result.found = false;
+        return;
+    }
+    double length = scratch.distances[meeting];
+    const SearchScratch *bwd = scratch.backward.get();
+    for (Vertex v = meeting; v != goal && bwd; ) {
+        Vertex next = bwd->predecessors[v];
+        if (next == v) {
+            result.found = false;
+            result.path.clear();
+            return;
+        }
+        length += arc_weight(g, v, next);
+        result.path.push_back(next);
+        v = next;
+    }
+    result.found = true;
+    result.length = length;
+}
+
+template <class G>
+static PathResult shortest_path_query_impl(const G &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, SearchScratch &scratch)
+{
+    PathResult result;
+    Vertex meeting;
+
+    switch (mode) {
+    case SearchMode::Bidirectional:
+        result.found = bidirectional_dijkstra(g, start, goal, scratch, meeting);
+        result.settled = scratch.settled;
+        result.cancelled = scratch.cancelled;
+        if (result.found) {
+            join_bidirectional_path(g, scratch, start, goal, meeting, result);
+        }
+        if (!result.found) {
+            result.length = numeric_limits<double>::max();
+        }
+        return result;
+    case SearchMode::AStar:
+        astar_to_goal(g, coord_list, start, goal, scratch);
+        break;
+    case SearchMode::Dijkstra:
+    default:
+        dijkstra_to_goals(g, start, {goal}, scratch);
+        break;
+    }
+
+    result.settled = scratch.settled;
+    if (scratch.cancelled) {
+        // Distances partielles : un sommet atteint mais non fixé n'a pas encore sa distance définitive
+        result.cancelled = true;
+        result.length = numeric_limits<double>::max();
+        return result;
+    }
+    result.found = extract_path(scratch, start, goal, result.path);
+    result.length = result.found ? scratch.distances[goal] : numeric_limits<double>::max();
+    return result;
+}
+
+PathResult shortest_path_query(const Graph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, SearchScratch &scratch)
+{
+    return shortest_path_query_impl(g, coord_list, start, goal, mode, scratch);
+}
+
+PathResult shortest_path_query(const CSRGraph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, SearchScratch &scratch)
+{
+    return shortest_path_query_impl(g, coord_list, start, goal, mode, scratch);
+}
+
+PathResult shortest_path_query(const CompactGraph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, SearchScratch &scratch)
+{
+    return shortest_path_query_impl(g, coord_list, start, goal, mode, scratch);
+}
+
+const char *search_mode_name(SearchMode mode)
+{
+    switch (mode) {
+    case SearchMode::AStar:
+        return "A*";
+    case SearchMode::Bidirectional:
+        return "Bidirectional Dijkstra";
+    case SearchMode::Dijkstra:
+    default:
+        return "Dijkstra";
+    }
+}
+
+bool extract_path(const SearchScratch &scratch, Vertex source, Vertex goal, vector<Vertex> &path)
+{
+    path.clear();
+    if (scratch.distances[goal] == numeric_limits<double>::max()) {
+        return false;
+    }
+
+    for (Vertex v = goal; v != source; v = scratch.predecessors[v]) {
+        if (v == scratch.predecessors[v]) {
+            cerr << "Erreur dans le chemin, arrêt prématuré" << endl;
+            path.clear();
+            return false;
+        }
+        path.push_back(v);
+    }
+    path.push_back(source);
+    reverse(path.begin(), path.end());
+    return true;
+}
+
+/**
+ * @brief ajout d'un nombre au format par défaut des flux (équivalent de printf("%g"), 6 chiffres significatifs)
+ */
+static void append_number(string &out, double value)
+{
+    char buffer[32];
+    auto [end, ec] = to_chars(buffer, buffer + sizeof(buffer), value, chars_format::general, 6);
+    out.append(buffer, end);
+}
+
+void write_path_row(string &out, double start, double goal, bool found, double length, const vector<Vertex> &path,
+                    const VertexNumbering &numbering)
+{
+    // Sommets réécrits dans la numérotation des fichiers si le graph a été renuméroté
+    if (numbering.renumbered()) {
+        start = numbering.external(static_cast<Vertex>(start) - 1) + 1.0;
+        goal = numbering.external(static_cast<Vertex>(goal) - 1) + 1.0;
+    }
+    append_number(out, start);
+    out += ';';
+    append_number(out, goal);
+    if (!found) {
+        out += ";Inf;No Path\n";
+        return;
+    }
+
+    out += ';';
+    append_number(out, length);
+    out += ";[";
+    char buffer[24];
+    for (size_t i = 0; i < path.size(); ++i) {
+        if (i > 0) out += ',';
+        auto [end, ec] = to_chars(buffer, buffer + sizeof(buffer), numbering.external(path[i]) + 1);
+        out.append(buffer, end);
+    }
+    out += "]\n";
+}
@@ -0,0 +1,680 @@
+#include <iostream>
+#include <algorithm>
+#include <thread>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <condition_variable>
+#include <cstring>
+#include <cstdlib>
+#include "query_server.h"
+#include "graph_cache.h"
+#include "graph_updates.h"
+#include "path_search.h"
+#include "ordered_writer.h"
+
+#ifndef _WIN32
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <poll.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <csignal>
+    #include <cerrno>
+#endif
+
+using namespace std;
+
+/**
+ * @brief état d'un thread du pool, réutilisé d'une tâche à l'autre
+ */
+struct ServerWorker
+{
+    // Requêtes déjà servies en parallèle par le pool : une recherche n'occupe que son thread
+    ServerWorker() { scratch.engine_threads = 1; }
+    SearchScratch scratch;
+    CHQueryScratch ch_scratch;
+};
+
+/**
+ * @brief réglages d'une connexion (MODE, ENGINE), attachés à chaque requête au moment de sa lecture
+ */
+struct QuerySettings
+{
+    SearchMode mode = SearchMode::AStar;
+    bool use_ch = false;
+    SearchEngine engine = SearchEngine::BinaryHeap;
+};
+
+/**
+ * @brief tâche du pool : bloc de requêtes consécutives d'une connexion, ou commande RELOAD / UPDATE
+ */
+struct ServerTask
+{
+    uint64_t connection = 0;
+    uint64_t sequence = 0;
+    std::shared_ptr<const GraphSnapshot> snapshot;
+    QuerySettings settings;
+    // Requêtes, une par ligne terminée par '\n' (vide pour une commande)
+    string lines;
+    string command;
+    string argument;
+};
+
+/**
+ * @brief réponse d'une tâche, remise à la boucle de lecture qui la replace dans l'ordre de sa connexion
+ */
+struct ServerReply
+{
+    uint64_t connection = 0;
+    uint64_t sequence = 0;
+    string text;
+    uint64_t queries = 0;
+    bool command = false;
+};
+
+/**
+ * @brief connexion suivie par la boucle de lecture
+ *
+ * Chaque requête ou bloc de requêtes reçoit un numéro ; les réponses arrivées avant leur tour attendent
+ * dans ready, puis passent dans out dans l'ordre des numéros.
+ */
+struct ServerConnection
+{
+    int fd = -1;
+    // Octets reçus pas encore traités, dont les lignes retenues derrière une commande en attente
+    string pending;
+    QuerySettings settings;
+    uint64_t next_sequence = 0;
+    uint64_t next_reply = 0;
+    std::map<uint64_t, string> ready;
+    string out;
+    // Tâches du pool pas encore revenues
+    size_t in_flight = 0;
+    // RELOAD ou UPDATE en cours : les lignes suivantes attendent le nouveau graph
+    bool waiting_command = false;
+    // Fin de lecture : client parti, QUIT ou ligne trop longue
+    bool eof = false;
+    bool closing = false;
+    // Numéro de la réponse à SHUTDOWN, arrêt du démon une fois envoyée
+    uint64_t shutdown_after = UINT64_MAX;
+};
+
+QueryServer::QueryServer(const QueryServerConfig &config) : config(config)
+{
+}
+
+QueryServer::~QueryServer()
+{
+    stop();
+}
+
+std::shared_ptr<const GraphSnapshot> QueryServer::snapshot() const
+{
+    return std::atomic_load(&current);
+}
+
+bool QueryServer::reload()
+{
+    // Un seul rechargement à la fois ; les requêtes continuent sur le graph courant pendant la lecture
+    lock_guard<mutex> lock(reload_mutex);
+
+    auto next = std::make_shared<GraphSnapshot>();
+    GraphCacheKey key;
+    if (!load_graph(config.filename_nodes, config.filename_edges, config.filename_cache, next->coord_list, next->g, key, config.num_threads, config.weight_precision)) {
+        return false;
+    }
+    if (!config.filename_ch.empty()) {
+        load_or_build_contraction_hierarchy(next->g, config.filename_ch, key, next->ch);
+        next->has_ch = true;
+    }
+
+    std::shared_ptr<const GraphSnapshot> previous = snapshot();
+    next->generation = previous ? previous->generation + 1 : 1;
+    std::atomic_store(&current, std::shared_ptr<const GraphSnapshot>(std::move(next)));
+    return true;
+}
+
+bool QueryServer::apply_updates(const string &filename, size_t &changed)
+{
+    lock_guard<mutex> lock(reload_mutex);
+    std::shared_ptr<const GraphSnapshot> previous = snapshot();
+
+    vector<EdgeUpdate> updates;
+    CSVLoadResult loaded = load_edge_updates(filename, previous->coord_list, previous->numbering, updates);
+    if (!loaded.ok()) {
+        report_csv_errors(filename, loaded);
+        return false;
+    }
+
+    // Copie du graph servi : les requêtes en cours gardent l'ancien jusqu'au remplacement
+    auto next = std::make_shared<GraphSnapshot>();
+    next->coord_list = previous->coord_list;
+    next->g = previous->g;
+    next->numbering = previous->numbering;
+    changed = apply_edge_updates(next->g, updates, next->numbering).size();
+    if (previous->has_ch) {
+        next->ch = ContractionHierarchy::build(next->g);
+        next->has_ch = true;
+    }
+
+    next->generation = previous->generation + 1;
+    std::atomic_store(&current, std::shared_ptr<const GraphSnapshot>(std::move(next)));
+    return true;
+}
+
+static bool parse_mode(const string &name, SearchMode &mode, bool &use_ch)
+{
+    use_ch = false;
+    if (name == "dijkstra") mode = SearchMode::Dijkstra;
+    else if (name == "astar") mode = SearchMode::AStar;
+    else if (name == "bidirectional") mode = SearchMode::Bidirectional;
+    else if (name == "ch") use_ch = true;
+    else return false;
+    return true;
+}
+
+/**
+ * @brief ligne "OK vertices <n> arcs <m> generation <g>" décrivant le graph servi
+ */
+static void append_graph_summary(string &out, const GraphSnapshot &snapshot)
+{
+    out += "OK vertices " + to_string(snapshot.coord_list.size()) + " arcs " + to_string(num_edges(snapshot.g))
+         + " generation " + to_string(snapshot.generation);
+}
+
+/**
+ * @brief requête "départ arrivée" ou "départ;arrivée", sans espaces de bord : ligne d'export ajoutée à out
+ *
+ * @return false si le couple est invalide (ligne "ERR" ajoutée à la place)
+ */
+static bool answer_query(const char *begin, const char *end, const GraphSnapshot &snap, const QuerySettings &settings,
+                         ServerWorker &worker, string &out)
+{
+    string line(begin, end);
+    char *p;
+    double start = strtod(line.c_str(), &p);
+    while (*p == ' ' || *p == ';' || *p == '\t') ++p;
+    char *q;
+    double goal = strtod(p, &q);
+    size_t n = snap.coord_list.size();
+    if (q == p || *q != '\0' || !valid_pair(start, goal, n)) {
+        out += "ERR invalid pair " + line + "\n";
+        return false;
+    }
+
+    Vertex start_idx = static_cast<Vertex>(start - 1), goal_idx = static_cast<Vertex>(goal - 1);
+    worker.scratch.engine = settings.engine;
+    PathResult result = settings.use_ch ? snap.ch.query(start_idx, goal_idx, worker.ch_scratch)
+                                        : shortest_path_query(snap.g, snap.coord_list, start_idx, goal_idx, settings.mode, worker.scratch);
+    write_path_row(out, start, goal, result.found, result.length, result.path, snap.numbering);
+    return true;
+}
+
+void QueryServer::run_task(const ServerTask &task, ServerWorker &worker, ServerReply &reply)
+{
+    reply.connection = task.connection;
+    reply.sequence = task.sequence;
+    if (task.command.empty()) {
+        const char *p = task.lines.data();
+        const char *end = p + task.lines.size();
+        while (p < end) {
+            const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+            reply.queries += answer_query(p, nl, *task.snapshot, task.settings, worker, reply.text);
+            p = nl + 1;
+        }
+        return;
+    }
+
+    reply.command = true;
+    if (task.command == "RELOAD") {
+        if (reload()) {
+            append_graph_summary(reply.text, *snapshot());
+            reply.text += "\n";
+        } else {
+            reply.text += "ERR reload failed, graph unchanged\n";
+        }
+    } else {
+        size_t changed = 0;
+        if (apply_updates(task.argument, changed)) {
+            append_graph_summary(reply.text, *snapshot());
+            reply.text += " changed " + to_string(changed) + "\n";
+        } else {
+            reply.text += "ERR update failed, graph unchanged\n";
+        }
+    }
+}
+
+/**
+ * @brief réponse numéro sequence d'une connexion, envoyée après toutes celles qui la précèdent
+ */
+static void deliver(ServerConnection &connection, uint64_t sequence, string text)
+{
+    add_counter(Counter::BytesWritten, text.size());
+    if (sequence != connection.next_reply) {
+        connection.ready.emplace(sequence, std::move(text));
+        return;
+    }
+    connection.out += text;
+    connection.next_reply++;
+    for (auto it = connection.ready.begin(); it != connection.ready.end() && it->first == connection.next_reply; it = connection.ready.erase(it)) {
+        connection.out += it->second;
+        connection.next_reply++;
+    }
+}
+
+#ifndef _WIN32
+
+/**
+ * @brief file des tâches du pool et des réponses rendues à la boucle de lecture, réveillée par un tube
+ */
+class ServerTaskQueue
+{
+public:
+    explicit ServerTaskQueue(int wake_fd) : wake_fd(wake_fd) {}
+
+    void push(ServerTask task)
+    {
+        {
+            lock_guard<mutex> lock(m);
+            tasks.push_back(std::move(task));
+        }
+        cv.notify_one();
+    }
+
+    /**
+     * @brief prochaine tâche, false une fois la file arrêtée (les tâches restantes sont abandonnées)
+     */
+    bool pop(ServerTask &task)
+    {
+        unique_lock<mutex> lock(m);
+        cv.wait(lock, [&] { return stopped || !tasks.empty(); });
+        if (stopped) {
+            return false;
+        }
+        task = std::move(tasks.front());
+        tasks.pop_front();
+        return true;
+    }
+
+    void reply(ServerReply reply)
+    {
+        {
+            lock_guard<mutex> lock(m);
+            replies.push_back(std::move(reply));
+        }
+        // Tube plein : la boucle a déjà un réveil en attente
+        char byte = 0;
+        ssize_t k = ::write(wake_fd, &byte, 1);
+        (void)k;
+    }
+
+    vector<ServerReply> take_replies()
+    {
+        lock_guard<mutex> lock(m);
+        vector<ServerReply> taken;
+        taken.swap(replies);
+        return taken;
+    }
+
+    void stop()
+    {
+        {
+            lock_guard<mutex> lock(m);
+            stopped = true;
+        }
+        cv.notify_all();
+    }
+
+private:
+    mutex m;
+    condition_variable cv;
+    deque<ServerTask> tasks;
+    vector<ServerReply> replies;
+    bool stopped = false;
+    int wake_fd;
+};
+
+void QueryServer::dispatch_lines(uint64_t id, ServerConnection &connection, ServerTaskQueue &tasks)
+{
+    // Blocs de requêtes assez grands pour amortir le passage par le pool, assez petits pour répartir un lot
+    // entre les threads ; au-delà de MAX_IN_FLIGHT blocs en cours, les lignes attendent dans pending
+    const size_t QUERIES_PER_TASK = 32;
+    const size_t MAX_IN_FLIGHT = 64;
+    const size_t MAX_LINE = 4096;
+
+    std::shared_ptr<const GraphSnapshot> snap = snapshot();
+    ServerTask block;
+    size_t block_queries = 0;
+    auto flush_block = [&]() {
+        if (block_queries == 0) {
+            return;
+        }
+        block.connection = id;
+        block.sequence = connection.next_sequence++;
+        block.snapshot = snap;
+        block.settings = connection.settings;
+        connection.in_flight++;
+        tasks.push(std::move(block));
+        block = ServerTask();
+        block_queries = 0;
+    };
+    auto reply_now = [&](string text) {
+        deliver(connection, connection.next_sequence++, std::move(text));
+    };
+
+    string &pending = connection.pending;
+    size_t line_begin = 0;
+    while (!connection.waiting_command && !connection.closing && connection.in_flight < MAX_IN_FLIGHT) {
+        size_t nl = pending.find('\n', line_begin);
+        if (nl == string::npos) {
+            break;
+        }
+        const char *begin = pending.data() + line_begin;
+        const char *end = pending.data() + nl;
+        while (begin < end && (*begin == ' ' || *begin == '\t')) ++begin;
+        while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) --end;
+        if (begin == end) {
+            line_begin = nl + 1;
+            continue;
+        }
+
+        // Requête "départ arrivée" ou "départ;arrivée", servie par le pool avec ses voisines
+        if ((*begin >= '0' && *begin <= '9') || *begin == '.') {
+            block.lines.append(begin, end);
+            block.lines += '\n';
+            line_begin = nl + 1;
+            if (++block_queries == QUERIES_PER_TASK) {
+                flush_block();
+            }
+            continue;
+        }
+
+        // Commande : les requêtes qui la précèdent gardent les réglages d'avant
+        flush_block();
+        string command(begin, end);
+        string argument;
+        size_t space = command.find(' ');
+        if (space != string::npos) {
+            argument = command.substr(command.find_first_not_of(' ', space));
+            command.resize(space);
+        }
+
+        if (command == "MODE") {
+            SearchMode mode = connection.settings.mode;
+            bool use_ch = false;
+            if (!parse_mode(argument, mode, use_ch)) {
+                reply_now("ERR unknown mode " + argument + "\n");
+            } else if (use_ch && !snap->has_ch) {
+                reply_now("ERR no contraction hierarchy loaded\n");
+            } else {
+                connection.settings.mode = mode;
+                connection.settings.use_ch = use_ch;
+                reply_now("OK\n");
+            }
+            line_begin = nl + 1;
+            continue;
+        }
+        if (command == "ENGINE") {
+            reply_now(parse_search_engine(argument, connection.settings.engine) ? "OK\n" : "ERR unknown engine " + argument + "\n");
+            line_begin = nl + 1;
+            continue;
+        }
+
+        // Autres commandes : exécutées une fois revenues les réponses de toutes les requêtes précédentes
+        if (connection.in_flight > 0) {
+            break;
+        }
+        line_begin = nl + 1;
+        if (command == "STATS") {
+            string text;
+            append_graph_summary(text, *snap);
+            reply_now(text + " queries " + to_string(queries.load()) + " connections " + to_string(connections.load()) + "\n");
+        } else if (command == "RELOAD" || command == "UPDATE") {
+            if (command == "UPDATE" && argument.empty()) {
+                reply_now("ERR missing update file\n");
+                continue;
+            }
+            // Relecture dans le pool ; les lignes suivantes attendent le nouveau graph
+            ServerTask task;
+            task.connection = id;
+            task.sequence = connection.next_sequence++;
+            task.command = command;
+            task.argument = argument;
+            connection.in_flight++;
+            connection.waiting_command = true;
+            tasks.push(std::move(task));
+        } else if (command == "QUIT") {
+            connection.closing = true;
+        } else if (command == "SHUTDOWN") {
+            connection.shutdown_after = connection.next_sequence;
+            reply_now("OK\n");
+            connection.closing = true;
+        } else {
+            reply_now("ERR unknown command " + command + "\n");
+        }
+    }
+    flush_block();
+    pending.erase(0, line_begin);
+
+    if (!connection.closing && pending.size() > MAX_LINE && pending.find('\n') == string::npos) {
+        reply_now("ERR line too long\n");
+        connection.closing = true;
+    }
+}
+
+/**
+ * @brief envoi sans blocage des réponses prêtes
+ *
+ * @return false si le client est parti
+ */
+static bool send_ready(ServerConnection &connection)
+{
+    size_t sent = 0;
+    while (sent < connection.out.size()) {
+        ssize_t k = ::send(connection.fd, connection.out.data() + sent, connection.out.size() - sent, 0);
+        if (k < 0 && errno == EINTR) {
+            continue;
+        }
+        if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (k <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(k);
+    }
+    connection.out.erase(0, sent);
+    return true;
+}
+
+static bool set_nonblocking(int fd)
+{
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+bool QueryServer::run()
+{
+    if (!snapshot() && !reload()) {
+        return false;
+    }
+
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (config.socket_path.size() >= sizeof(address.sun_path)) {
+        cerr << "Chemin de socket trop long : " << config.socket_path << endl;
+        return false;
+    }
+    strcpy(address.sun_path, config.socket_path.c_str());
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        cerr << "Création de la socket impossible : " << strerror(errno) << endl;
+        return false;
+    }
+    ::unlink(config.socket_path.c_str());
+    if (::bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || ::listen(listener, SOMAXCONN) != 0) {
+        cerr << "Écoute impossible sur '" << config.socket_path << "' : " << strerror(errno) << endl;
+        ::close(listener);
+        return false;
+    }
+    int wake[2];
+    if (::pipe(wake) != 0 || !set_nonblocking(wake[0]) || !set_nonblocking(wake[1]) || !set_nonblocking(listener)) {
+        cerr << "Création du tube de réveil impossible : " << strerror(errno) << endl;
+        ::close(listener);
+        ::unlink(config.socket_path.c_str());
+        return false;
+    }
+
+    // Une écriture vers un client parti renvoie une erreur au lieu d'interrompre le processus
+    signal(SIGPIPE, SIG_IGN);
+
+    // Pool : exécute les blocs de requêtes et les rechargements, quelle que soit leur connexion
+    unsigned num_threads = resolve_num_threads(config.num_threads, SIZE_MAX);
+    ServerTaskQueue tasks(wake[1]);
+    vector<thread> pool;
+    for (unsigned t = 0; t < num_threads; ++t) {
+        pool.emplace_back([&]() {
+            ServerWorker worker;
+            ServerTask task;
+            while (tasks.pop(task)) {
+                ServerReply reply;
+                run_task(task, worker, reply);
+                task = ServerTask();
+                tasks.reply(std::move(reply));
+            }
+        });
+    }
+
+    std::shared_ptr<const GraphSnapshot> snap = snapshot();
+    cout << "Serving " << snap->coord_list.size() << " vertices on '" << config.socket_path << "' with " << num_threads << " threads" << endl;
+    snap.reset();
+
+    // Boucle de lecture : un seul thread surveille la socket d'écoute, le tube de réveil et tous les clients,
+    // avec réveil régulier pour prendre en compte stop()
+    const int POLL_TIMEOUT_MS = 200;
+    const size_t READ_SIZE = 1 << 16;
+    // Lecture suspendue tant qu'une connexion a autant d'octets reçus non traités ou de réponses non envoyées
+    const size_t BACKLOG_LIMIT = 1 << 20;
+    unordered_map<uint64_t, ServerConnection> open;
+    uint64_t next_id = 0;
+    vector<pollfd> fds;
+    vector<uint64_t> ids;
+    vector<char> buffer(READ_SIZE);
+    while (!stopping.load()) {
+        fds.assign({{listener, POLLIN, 0}, {wake[0], POLLIN, 0}});
+        ids.clear();
+        for (const auto &[id, connection] : open) {
+            short events = 0;
+            if (!connection.eof && !connection.closing && connection.pending.size() < BACKLOG_LIMIT && connection.out.size() < BACKLOG_LIMIT) {
+                events |= POLLIN;
+            }
+            if (!connection.out.empty()) {
+                events |= POLLOUT;
+            }
+            // Sans événement attendu, le descripteur est ignoré (un client parti signalerait POLLHUP sans fin)
+            fds.push_back({events ? connection.fd : -1, events, 0});
+            ids.push_back(id);
+        }
+        if (::poll(fds.data(), fds.size(), POLL_TIMEOUT_MS) <= 0) {
+            continue;
+        }
+
+        // Réponses du pool, replacées dans l'ordre de leur connexion (connexion fermée entre-temps : ignorées)
+        if (fds[1].revents & POLLIN) {
+            while (::read(wake[0], buffer.data(), buffer.size()) > 0) {
+            }
+            for (ServerReply &reply : tasks.take_replies()) {
+                queries.fetch_add(reply.queries);
+                auto it = open.find(reply.connection);
+                if (it == open.end()) {
+                    continue;
+                }
+                ServerConnection &connection = it->second;
+                connection.in_flight--;
+                if (reply.command) {
+                    connection.waiting_command = false;
+                    std::shared_ptr<const GraphSnapshot> current_snapshot = snapshot();
+                    if (connection.settings.use_ch && !current_snapshot->has_ch) {
+                        connection.settings.use_ch = false;
+                    }
+                }
+                deliver(connection, reply.sequence, std::move(reply.text));
+            }
+        }
+
+        // Lectures : lignes reçues ajoutées à pending ; fin de flux ou erreur
+        for (size_t i = 0; i < ids.size(); ++i) {
+            ServerConnection &connection = open[ids[i]];
+            if (!(fds[i + 2].revents & (POLLIN | POLLHUP | POLLERR)) || connection.eof || connection.closing) {
+                continue;
+            }
+            ssize_t k = ::recv(connection.fd, buffer.data(), buffer.size(), 0);
+            if (k > 0) {
+                connection.pending.append(buffer.data(), static_cast<size_t>(k));
+            } else if (k == 0 || (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)) {
+                connection.eof = true;
+            }
+        }
+
+        // Requêtes confiées au pool, réponses prêtes envoyées, connexions terminées fermées
+        for (auto it = open.begin(); it != open.end();) {
+            uint64_t id = it->first;
+            ServerConnection &connection = it->second;
+            dispatch_lines(id, connection, tasks);
+            bool alive = send_ready(connection);
+            if (connection.next_reply > connection.shutdown_after && connection.out.empty()) {
+                stop();
+            }
+            bool finished = (connection.eof || connection.closing) && connection.in_flight == 0 && connection.out.empty();
+            if (!alive || finished) {
+                ::close(connection.fd);
+                it = open.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            for (int fd; (fd = ::accept(listener, nullptr, nullptr)) >= 0;) {
+                if (!set_nonblocking(fd)) {
+                    ::close(fd);
+                    continue;
+                }
+                connections.fetch_add(1);
+                ServerConnection &connection = open[next_id++];
+                connection.fd = fd;
+                connection.settings.mode = config.default_mode;
+                connection.settings.engine = config.default_engine;
+            }
+        }
+    }
+
+    // Arrêt : plus de nouvelles connexions, tâches en attente abandonnées, clients déconnectés
+    ::close(listener);
+    ::unlink(config.socket_path.c_str());
+    tasks.stop();
+    for (auto &t : pool) {
+        t.join();
+    }
+    for (auto &[id, connection] : open) {
+        ::close(connection.fd);
+    }
+    ::close(wake[0]);
+    ::close(wake[1]);
+
+    cout << "Server stopped after " << queries.load() << " queries on " << connections.load() << " connections" << endl;
+    return true;
+}
+
+#else
+
+bool QueryServer::run()
+{
+    cerr << "Le démon de requêtes nécessite les sockets Unix, non disponibles sur cette plateforme" << endl;
+    return false;
+}
+
+#endif
@@ -0,0 +1,188 @@
+#include <cmath>
+#include <limits>
+#include "render_index.h"
+
+using namespace std;
+using namespace boost;
+
+// Nombre moyen de sommets par case, et borne du nombre de cases
+static const double VERTICES_PER_CELL = 4;
+static const size_t MAX_CELLS = size_t(1) << 22;
+
+static size_t clamp_index(double value, size_t count)
+{
+    return static_cast<size_t>(min(static_cast<double>(count - 1), max(0.0, value)));
+}
+
+/**
+ * @brief case d'un point dans une grille de cols x rows cases de côté cell, d'origine (x0, y0)
+ */
+static size_t cell_of(const RenderRect &box, double cell, size_t cols, size_t rows, double x, double y)
+{
+    return clamp_index((y - box.y0) / cell, rows) * cols + clamp_index((x - box.x0) / cell, cols);
+}
+
+bool RenderIndex::cell_range(const RenderRect &r, double margin, size_t &c0, size_t &c1, size_t &r0, size_t &r1) const
+{
+    if (n == 0 || r.x1 + margin < box.x0 || r.x0 - margin > box.x1 || r.y1 + margin < box.y0 || r.y0 - margin > box.y1) {
+        return false;
+    }
+    c0 = clamp_index((r.x0 - margin - box.x0) / cell, cols);
+    c1 = clamp_index((r.x1 + margin - box.x0) / cell, cols);
+    r0 = clamp_index((r.y0 - margin - box.y0) / cell, rows);
+    r1 = clamp_index((r.y1 + margin - box.y0) / cell, rows);
+    return true;
+}
+
+bool RenderIndex::level_range(const EdgeLevel &level, const RenderRect &r, size_t &c0, size_t &c1, size_t &r0, size_t &r1) const
+{
+    // Une arête rangée dans une case en déborde d'au plus une demi-case
+    double margin = level.cell;
+    if (level.edges.empty() || r.x1 + margin < box.x0 || r.x0 - margin > box.x1 || r.y1 + margin < box.y0 || r.y0 - margin > box.y1) {
+        return false;
+    }
+    c0 = clamp_index((r.x0 - margin - box.x0) / level.cell, level.cols);
+    c1 = clamp_index((r.x1 + margin - box.x0) / level.cell, level.cols);
+    r0 = clamp_index((r.y0 - margin - box.y0) / level.cell, level.rows);
+    r1 = clamp_index((r.y1 + margin - box.y0) / level.cell, level.rows);
+    return true;
+}
+
+/**
+ * @brief rangement des éléments par case : décalages start (cases + 1) et éléments triés par case
+ */
+static void bucket_by_cell(size_t num_cells, const vector<uint32_t> &items, const vector<size_t> &cell_of_item,
+                           vector<uint64_t> &start, vector<uint32_t> &sorted)
+{
+    start.assign(num_cells + 1, 0);
+    for (size_t c : cell_of_item) {
+        start[c + 1]++;
+    }
+    for (size_t c = 0; c < num_cells; ++c) {
+        start[c + 1] += start[c];
+    }
+    vector<uint64_t> cursor(start.begin(), start.end() - 1);
+    sorted.resize(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        sorted[cursor[cell_of_item[i]]++] = items[i];
+    }
+}
+
+template <class G>
+RenderIndex RenderIndex::build_impl(const G &g, const CoordinateStore &coord_list)
+{
+    using VertexG = typename graph_traits<G>::vertex_descriptor;
+    RenderIndex index;
+    size_t n = coord_list.size();
+    index.n = n;
+    index.xs = coord_list.x_data();
+    index.ys = coord_list.y_data();
+    index.box = {numeric_limits<double>::max(), numeric_limits<double>::max(), -numeric_limits<double>::max(), -numeric_limits<double>::max()};
+    for (size_t v = 0; v < n; ++v) {
+        index.box.x0 = min(index.box.x0, index.xs[v]);
+        index.box.y0 = min(index.box.y0, index.ys[v]);
+        index.box.x1 = max(index.box.x1, index.xs[v]);
+        index.box.y1 = max(index.box.y1, index.ys[v]);
+    }
+    if (n == 0) {
+        index.box = RenderRect();
+        index.vertex_start.assign(2, 0);
+        return index;
+    }
+
+    // Cases carrées, environ VERTICES_PER_CELL sommets par case pour une répartition uniforme
+    double width = index.box.x1 - index.box.x0, height = index.box.y1 - index.box.y0;
+    double target_cells = max(1.0, min(static_cast<double>(MAX_CELLS), n / VERTICES_PER_CELL));
+    if (width > 0 && height > 0) {
+        index.cell = sqrt(width * height / target_cells);
+    } else if (width > 0 || height > 0) {
+        index.cell = max(width, height) / target_cells;
+    }
+    index.cell = max(index.cell, max(width, height) / sqrt(static_cast<double>(MAX_CELLS)));
+    if (!(index.cell > 0)) {
+        index.cell = 1;
+    }
+    index.cols = static_cast<size_t>(width / index.cell) + 1;
+    index.rows = static_cast<size_t>(height / index.cell) + 1;
+    size_t num_cells = index.cols * index.rows;
+
+    vector<uint32_t> items(n);
+    vector<size_t> cells(n);
+    for (size_t v = 0; v < n; ++v) {
+        items[v] = static_cast<uint32_t>(v);
+        cells[v] = cell_of(index.box, index.cell, index.cols, index.rows, index.xs[v], index.ys[v]);
+    }
+    bucket_by_cell(num_cells, items, cells, index.vertex_start, index.cell_vertices);
+
+    // Arêtes non orientées une seule fois : arcs u -> v avec u < v, arcs parallèles fusionnés
+    vector<uint32_t> targets;
+    for (size_t u = 0; u < n; ++u) {
+        targets.clear();
+        for (auto [ei, ei_end] = out_edges(static_cast<VertexG>(u), g); ei != ei_end; ++ei) {
+            size_t v = target(*ei, g);
+            if (v > u) {
+                targets.push_back(static_cast<uint32_t>(v));
+            }
+        }
+        sort(targets.begin(), targets.end());
+        targets.erase(unique(targets.begin(), targets.end()), targets.end());
+        for (uint32_t v : targets) {
+            index.edge_list.emplace_back(static_cast<uint32_t>(u), v);
+        }
+    }
+
+    // Niveau de chaque arête : premier niveau dont les cases sont au moins aussi grandes qu'elle ; le dernier
+    // niveau a une seule case couvrant la boîte englobante
+    size_t num_levels = 1;
+    while (index.cell * (size_t(1) << (num_levels - 1)) < max(width, height)) {
+        num_levels++;
+    }
+    size_t m = index.edge_list.size();
+    vector<uint8_t> edge_level(m);
+    vector<size_t> level_count(num_levels, 0);
+    index.edge_length.resize(m);
+    for (size_t e = 0; e < m; ++e) {
+        auto [u, v] = index.edge_list[e];
+        double dx = index.xs[v] - index.xs[u], dy = index.ys[v] - index.ys[u];
+        index.edge_length[e] = static_cast<float>(sqrt(dx * dx + dy * dy));
+        double extent = max(fabs(dx), fabs(dy));
+        size_t level = 0;
+        while (level + 1 < num_levels && index.cell * (size_t(1) << level) < extent) {
+            level++;
+        }
+        edge_level[e] = static_cast<uint8_t>(level);
+        level_count[level]++;
+    }
+
+    for (size_t l = 0; l < num_levels; ++l) {
+        EdgeLevel level;
+        level.cell = index.cell * (size_t(1) << l);
+        level.cols = static_cast<size_t>(width / level.cell) + 1;
+        level.rows = static_cast<size_t>(height / level.cell) + 1;
+        items.clear();
+        cells.clear();
+        items.reserve(level_count[l]);
+        cells.reserve(level_count[l]);
+        for (size_t e = 0; e < m; ++e) {
+            if (edge_level[e] != l) {
+                continue;
+            }
+            auto [u, v] = index.edge_list[e];
+            items.push_back(static_cast<uint32_t>(e));
+            cells.push_back(cell_of(index.box, level.cell, level.cols, level.rows, (index.xs[u] + index.xs[v]) / 2, (index.ys[u] + index.ys[v]) / 2));
+        }
+        bucket_by_cell(level.cols * level.rows, items, cells, level.start, level.edges);
+        index.edge_levels.push_back(std::move(level));
+    }
+    return index;
+}
+
+RenderIndex RenderIndex::build(const Graph &g, const CoordinateStore &coord_list)
+{
+    return build_impl(g, coord_list);
+}
+
+RenderIndex RenderIndex::build(const CSRGraph &g, const CoordinateStore &coord_list)
+{
+    return build_impl(g, coord_list);
+}
@@ -0,0 +1,617 @@
+#include <algorithm>
+#include <thread>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <condition_variable>
+#include "search_engines.h"
+#include "path_search.h"
+#include "instrumentation.h"
+#include "ordered_writer.h"
+
+using namespace std;
+using namespace boost;
+
+static atomic<SearchEngine> default_engine{SearchEngine::BinaryHeap};
+
+const char *search_engine_name(SearchEngine engine)
+{
+    switch (engine) {
+        case SearchEngine::BinaryHeap: return "binary";
+        case SearchEngine::RadixHeap: return "radix";
+        case SearchEngine::BucketQueue: return "buckets";
+        case SearchEngine::DeltaStepping: return "delta";
+    }
+    return "unknown";
+}
+
+bool parse_search_engine(const string &name, SearchEngine &engine)
+{
+    for (SearchEngine e : {SearchEngine::BinaryHeap, SearchEngine::RadixHeap, SearchEngine::BucketQueue, SearchEngine::DeltaStepping}) {
+        if (name == search_engine_name(e)) {
+            engine = e;
+            return true;
+        }
+    }
+    return false;
+}
+
+void set_default_search_engine(SearchEngine engine)
+{
+    default_engine.store(engine, memory_order_relaxed);
+}
+
+SearchEngine default_search_engine()
+{
+    return default_engine.load(memory_order_relaxed);
+}
+
+// Les distances étant positives, l'ordre de leurs représentations IEEE 754 est celui des valeurs
+static inline uint64_t distance_bits(double d)
+{
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    return bits;
+}
+
+static inline double bits_distance(uint64_t bits)
+{
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+static const uint64_t INFINITE_BITS = distance_bits(numeric_limits<double>::max());
+
+/**
+ * @brief poids minimal, maximal et moyen des arcs, recalculés seulement si le graph a changé
+ */
+template <class G>
+static void update_weight_range(const G &g, EngineBuffers &q)
+{
+    if (q.weights_graph == &g && q.weights_arcs == num_edges(g)) {
+        return;
+    }
+    auto weight = get(edge_weight, g);
+    double lo = numeric_limits<double>::max(), hi = 0, sum = 0;
+    size_t arcs = 0;
+    for (auto [ei, ei_end] = edges(g); ei != ei_end; ++ei) {
+        double w = get(weight, *ei);
+        lo = min(lo, w);
+        hi = max(hi, w);
+        sum += w;
+        arcs++;
+    }
+    q.weights_graph = &g;
+    q.weights_arcs = num_edges(g);
+    q.min_weight = arcs ? lo : 0;
+    q.max_weight = hi;
+    q.mean_weight = arcs ? sum / arcs : 0;
+}
+
+/**
+ * @brief sommet à atteindre fixé : retrait de la liste des buts, vrai si c'était le dernier
+ */
+static inline bool settle_goal(SearchScratch &scratch, Vertex v, size_t &remaining)
+{
+    if (scratch.goal_epoch[v] != scratch.epoch) {
+        return false;
+    }
+    scratch.goal_epoch[v] = 0;
+    return --remaining == 0;
+}
+
+// Tas radix (étiquetage définitif, comme le tas binaire) ----------------------------------------------
+
+template <class G>
+static void radix_dijkstra(const G &g, Vertex source, const vector<Vertex> &goals, SearchScratch &scratch)
+{
+    using VertexG = typename graph_traits<G>::vertex_descriptor;
+    ScopedTimer timer(Phase::Search);
+    scratch.prepare(num_vertices(g));
+
+    auto &distances = scratch.distances;
+    auto &predecessors = scratch.predecessors;
+    auto &radix = scratch.queues.radix;
+    auto weight = get(edge_weight, g);
+    for (auto &bucket : radix) {
+        bucket.clear();
+    }
+
+    size_t remaining = scratch.mark_goals(goals);
+    bool stop_at_goals = remaining > 0;
+
+    // Clé minimale extraite en dernier : toutes les clés du tas lui sont supérieures ou égales
+    uint64_t last = 0;
+    size_t size = 0;
+    auto push = [&](uint64_t key, Vertex v) {
+        radix[key == last ? 0 : 64 - __builtin_clzll(key ^ last)].emplace_back(key, v);
+        size++;
+    };
+
+    SearchCounters counters;
+    distances[source] = 0;
+    scratch.touched.push_back(source);
+    push(distance_bits(0.0), source);
+    counters.pushes++;
+
+    while (size > 0) {
+        if (radix[0].empty()) {
+            // Redistribution du premier seau non vide autour de sa plus petite clé
+            size_t i = 1;
+            while (radix[i].empty()) {
+                ++i;
+            }
+            auto &bucket = radix[i];
+            last = min_element(bucket.begin(), bucket.end())->first;
+            for (const auto &[key, v] : bucket) {
+                radix[key == last ? 0 : 64 - __builtin_clzll(key ^ last)].emplace_back(key, v);
+            }
+            bucket.clear();
+        }
+        auto [key, u] = radix[0].back();
+        radix[0].pop_back();
+        size--;
+        counters.pops++;
+
+        double d = bits_distance(key);
+        if (d > distances[u]) {
+            continue;
+        }
+        scratch.settled++;
+        if (scratch.poll_cancel(scratch.settled)) {
+            break;
+        }
+
+        if (stop_at_goals && settle_goal(scratch, u, remaining)) {
+            break;
+        }
+
+        for (auto [ei, ei_end] = out_edges(static_cast<VertexG>(u), g); ei != ei_end; ++ei) {
+            Vertex v = target(*ei, g);
+            double nd = d + get(weight, *ei);
+            counters.relaxations++;
+            if (nd < distances[v]) {
+                if (distances[v] == numeric_limits<double>::max()) {
+                    scratch.touched.push_back(v);
+                }
+                distances[v] = nd;
+                predecessors[v] = u;
+                push(distance_bits(nd), v);
+                counters.pushes++;
+            }
+        }
+    }
+
+    counters.settled = scratch.settled;
+    record_search(counters);
+}
+
+// Seaux circulaires (Dial) ----------------------------------------------------------------------------
+
+template <class G>
+static void bucket_dijkstra(const G &g, Vertex source, const vector<Vertex> &goals, SearchScratch &scratch)
+{
+    using VertexG = typename graph_traits<G>::vertex_descriptor;
+    ScopedTimer timer(Phase::Search);
+    scratch.prepare(num_vertices(g));
+
+    auto &distances = scratch.distances;
+    auto &predecessors = scratch.predecessors;
+    auto &q = scratch.queues;
+    auto weight = get(edge_weight, g);
+
+    // Largeur des seaux : le plus petit poids, élargie pour qu'un arc ne franchisse pas plus de WINDOW - 2 seaux.
+    // Un sommet relâché dans son propre seau y est retraité (étiquetage correctif), ce qui garde les
+    // distances exactes quelle que soit la largeur.
+    const size_t WINDOW = 1024;
+    update_weight_range(g, q);
+    double width = max(q.min_weight, q.max_weight / (WINDOW - 2));
+    if (!(width > 0)) {
+        width = 1;
+    }
+    if (q.buckets.size() != WINDOW) {
+        q.buckets.assign(WINDOW, {});
+    }
+    q.overflow.clear();
+
+    size_t remaining = scratch.mark_goals(goals);
+    bool stop_at_goals = remaining > 0;
+    vector<Vertex> reached_goals;
+
+    size_t current = 0, pending = 0;
+    double overflow_min = numeric_limits<double>::max();
+    auto push = [&](double nd, Vertex v) {
+        size_t index = max(current, static_cast<size_t>(nd / width));
+        if (index - current < WINDOW) {
+            q.buckets[index % WINDOW].emplace_back(nd, v);
+            pending++;
+        } else {
+            q.overflow.emplace_back(nd, v);
+            overflow_min = min(overflow_min, nd);
+        }
+    };
+
+    SearchCounters counters;
+    distances[source] = 0;
+    scratch.touched.push_back(source);
+    push(0.0, source);
+    counters.pushes++;
+
+    while (pending > 0 || !q.overflow.empty()) {
+        if (scratch.cancel_requested()) {
+            for (auto &b : q.buckets) {
+                b.clear();
+            }
+            q.overflow.clear();
+            break;
+        }
+        if (pending == 0) {
+            current = static_cast<size_t>(overflow_min / width);
+        }
+        if (!q.overflow.empty() && static_cast<size_t>(overflow_min / width) <= current) {
+            // Entrées entrées dans la fenêtre : rangées dans leur seau, les périmées sont abandonnées
+            auto entries = std::move(q.overflow);
+            q.overflow.clear();
+            overflow_min = numeric_limits<double>::max();
+            for (const auto &[d, v] : entries) {
+                if (d == distances[v]) {
+                    push(d, v);
+                }
+            }
+        }
+
+        auto &bucket = q.buckets[current % WINDOW];
+        for (size_t i = 0; i < bucket.size(); ++i) {
+            auto [d, u] = bucket[i];
+            counters.pops++;
+            if (d > distances[u]) {
+                continue;
+            }
+            scratch.settled++;
+            if (stop_at_goals && scratch.goal_epoch[u] == scratch.epoch) {
+                reached_goals.push_back(u);
+            }
+
+            for (auto [ei, ei_end] = out_edges(static_cast<VertexG>(u), g); ei != ei_end; ++ei) {
+                Vertex v = target(*ei, g);
+                double nd = d + get(weight, *ei);
+                counters.relaxations++;
+                if (nd < distances[v]) {
+                    if (distances[v] == numeric_limits<double>::max()) {
+                        scratch.touched.push_back(v);
+                    }
+                    distances[v] = nd;
+                    predecessors[v] = u;
+                    push(nd, v);
+                    counters.pushes++;
+                }
+            }
+        }
+        pending -= bucket.size();
+        bucket.clear();
+        current++;
+
+        // Seau vidé : toutes les distances restantes dépassent sa borne, ses sommets sont fixés
+        bool done = false;
+        for (Vertex t : reached_goals) {
+            done = settle_goal(scratch, t, remaining) || done;
+        }
+        reached_goals.clear();
+        if (done) {
+            for (auto &b : q.buckets) {
+                b.clear();
+            }
+            q.overflow.clear();
+            break;
+        }
+    }
+
+    counters.settled = scratch.settled;
+    record_search(counters);
+}
+
+// Delta-stepping parallèle ----------------------------------------------------------------------------
+
+/**
+ * @brief minimum atomique sur la représentation binaire d'une distance
+ *
+ * @return vrai si value a remplacé la distance courante ; reached indique alors si le sommet était inatteint
+ */
+static inline bool atomic_min(atomic<uint64_t> &slot, double value, bool &reached)
+{
+    uint64_t bits = distance_bits(value);
+    uint64_t current = slot.load(memory_order_relaxed);
+    while (bits < current) {
+        if (slot.compare_exchange_weak(current, bits, memory_order_relaxed)) {
+            reached = current == INFINITE_BITS;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief barrière réutilisable entre les phases du delta-stepping : attente active courte (les phases se
+ * suivent de près), puis attente bloquante
+ */
+class PhaseBarrier
+{
+public:
+    explicit PhaseBarrier(unsigned count) : count(count) {}
+
+    void arrive_and_wait()
+    {
+        unsigned phase = generation.load(memory_order_acquire);
+        if (waiting.fetch_add(1, memory_order_acq_rel) + 1 == count) {
+            waiting.store(0, memory_order_relaxed);
+            {
+                lock_guard<mutex> lock(m);
+                generation.store(phase + 1, memory_order_release);
+            }
+            cv.notify_all();
+            return;
+        }
+        const int SPINS = 1024;
+        for (int i = 0; i < SPINS; ++i) {
+            if (generation.load(memory_order_acquire) != phase) {
+                return;
+            }
+            this_thread::yield();
+        }
+        unique_lock<mutex> lock(m);
+        cv.wait(lock, [&] { return generation.load(memory_order_acquire) != phase; });
+    }
+
+private:
+    const unsigned count;
+    atomic<unsigned> waiting{0};
+    atomic<unsigned> generation{0};
+    mutex m;
+    condition_variable cv;
+};
+
+template <class G>
+static void delta_stepping(const G &g, Vertex source, const vector<Vertex> &goals, SearchScratch &scratch)
+{
+    using VertexG = typename graph_traits<G>::vertex_descriptor;
+    ScopedTimer timer(Phase::Search);
+    size_t n = num_vertices(g);
+    scratch.prepare(n);
+
+    auto &q = scratch.queues;
+    auto weight = get(edge_weight, g);
+    if (q.capacity != n) {
+        q.atomic_distances.reset(new atomic<uint64_t>[n]);
+        for (size_t v = 0; v < n; ++v) {
+            q.atomic_distances[v].store(INFINITE_BITS, memory_order_relaxed);
+        }
+        q.relaxed.assign(n, numeric_limits<double>::max());
+        q.capacity = n;
+    }
+    auto *dist = q.atomic_distances.get();
+    auto &relaxed = q.relaxed;
+    auto &buckets = q.delta_buckets;
+    auto &removed = q.removed;
+    for (auto &b : buckets) {
+        b.clear();
+    }
+
+    // Arcs légers (poids < delta) relâchés à l'intérieur du seau, arcs lourds une fois le seau vidé
+    update_weight_range(g, q);
+    double delta = q.mean_weight > 0 ? q.mean_weight : 1;
+    auto bucket_of = [&](double d) { return static_cast<size_t>(d / delta); };
+
+    size_t remaining = scratch.mark_goals(goals);
+    bool stop_at_goals = remaining > 0;
+
+    // Relâchements d'un lot de sommets, répartis entre threads si le lot est assez grand
+    const size_t PARALLEL_MIN = 512;
+    unsigned max_threads = resolve_num_threads(scratch.engine_threads, n / PARALLEL_MIN);
+    struct Local
+    {
+        vector<pair<Vertex, double>> improved;
+        vector<Vertex> reached;
+        uint64_t relaxations = 0;
+    };
+    vector<Local> locals(max_threads);
+    SearchCounters counters;
+
+    auto relax_range = [&](const vector<Vertex> &items, size_t begin, size_t end, bool light, Local &local) {
+        for (size_t i = begin; i < end; ++i) {
+            Vertex u = items[i];
+            double d = bits_distance(dist[u].load(memory_order_relaxed));
+            for (auto [ei, ei_end] = out_edges(static_cast<VertexG>(u), g); ei != ei_end; ++ei) {
+                double w = get(weight, *ei);
+                if ((w < delta) != light) {
+                    continue;
+                }
+                Vertex v = target(*ei, g);
+                double nd = d + w;
+                bool reached = false;
+                local.relaxations++;
+                if (atomic_min(dist[v], nd, reached)) {
+                    local.improved.emplace_back(v, nd);
+                    if (reached) {
+                        local.reached.push_back(v);
+                    }
+                }
+            }
+        }
+    };
+
+    // Threads créés une seule fois pour la recherche : à chaque phase parallèle, le thread appelant publie le lot,
+    // tous en relâchent une part entre deux passages de la barrière, puis il fusionne les résultats
+    const vector<Vertex> *phase_items = nullptr;
+    bool phase_light = false;
+    unsigned phase_threads = 1;
+    bool finished = false;
+    PhaseBarrier barrier(max_threads);
+    auto relax_share = [&](unsigned t) {
+        size_t chunk = (phase_items->size() + phase_threads - 1) / phase_threads;
+        size_t begin = min(phase_items->size(), t * chunk), end = min(phase_items->size(), begin + chunk);
+        relax_range(*phase_items, begin, end, phase_light, locals[t]);
+    };
+    vector<thread> workers;
+    for (unsigned t = 1; t < max_threads; ++t) {
+        workers.emplace_back([&, t]() {
+            while (true) {
+                barrier.arrive_and_wait();
+                if (finished) {
+                    return;
+                }
+                if (t < phase_threads) {
+                    relax_share(t);
+                }
+                barrier.arrive_and_wait();
+            }
+        });
+    }
+
+    auto relax = [&](const vector<Vertex> &items, bool light) {
+        unsigned num_threads = items.size() >= PARALLEL_MIN ? min<unsigned>(max_threads, static_cast<unsigned>(items.size() / PARALLEL_MIN)) : 1;
+        if (num_threads <= 1) {
+            relax_range(items, 0, items.size(), light, locals[0]);
+        } else {
+            phase_items = &items;
+            phase_light = light;
+            phase_threads = num_threads;
+            barrier.arrive_and_wait();
+            relax_share(0);
+            barrier.arrive_and_wait();
+        }
+        for (auto &local : locals) {
+            for (const auto &[v, nd] : local.improved) {
+                size_t b = bucket_of(nd);
+                if (b >= buckets.size()) {
+                    buckets.resize(b + 1);
+                }
+                buckets[b].push_back(v);
+            }
+            counters.pushes += local.improved.size();
+            counters.relaxations += local.relaxations;
+            scratch.touched.insert(scratch.touched.end(), local.reached.begin(), local.reached.end());
+            local.improved.clear();
+            local.reached.clear();
+            local.relaxations = 0;
+        }
+    };
+
+    dist[source].store(distance_bits(0.0), memory_order_relaxed);
+    scratch.touched.push_back(source);
+    buckets.resize(max<size_t>(buckets.size(), 1));
+    buckets[0].push_back(source);
+    counters.pushes++;
+
+    vector<Vertex> frontier;
+    for (size_t k = 0; k < buckets.size(); ++k) {
+        if (scratch.cancel_requested()) {
+            break;
+        }
+        removed.clear();
+        while (!buckets[k].empty()) {
+            // Sommets encore dans ce seau et pas encore relâchés avec leur distance courante
+            frontier.clear();
+            for (Vertex v : buckets[k]) {
+                counters.pops++;
+                double d = bits_distance(dist[v].load(memory_order_relaxed));
+                if (bucket_of(d) != k || relaxed[v] == d) {
+                    continue;
+                }
+                relaxed[v] = d;
+                frontier.push_back(v);
+            }
+            buckets[k].clear();
+            removed.insert(removed.end(), frontier.begin(), frontier.end());
+            relax(frontier, true);
+        }
+
+        sort(removed.begin(), removed.end());
+        removed.erase(unique(removed.begin(), removed.end()), removed.end());
+        relax(removed, false);
+        scratch.settled += removed.size();
+
+        // Seau terminé : ses sommets sont fixés
+        bool done = false;
+        if (stop_at_goals) {
+            for (Vertex v : removed) {
+                done = settle_goal(scratch, v, remaining) || done;
+            }
+        }
+        if (done) {
+            break;
+        }
+    }
+
+    finished = true;
+    if (!workers.empty()) {
+        barrier.arrive_and_wait();
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    // Prédécesseurs : parcours depuis la source des arcs tendus (d(u) + w = d(v)) entre sommets fixés,
+    // chaque sommet étant rattaché une seule fois à un sommet déjà rattaché
+    auto &distances = scratch.distances;
+    auto &predecessors = scratch.predecessors;
+    for (Vertex v : scratch.touched) {
+        distances[v] = bits_distance(dist[v].load(memory_order_relaxed));
+    }
+    removed.assign(1, source);
+    for (size_t i = 0; i < removed.size(); ++i) {
+        Vertex u = removed[i];
+        double d = distances[u];
+        for (auto [ei, ei_end] = out_edges(static_cast<VertexG>(u), g); ei != ei_end; ++ei) {
+            Vertex v = target(*ei, g);
+            if (v != source && predecessors[v] == v && relaxed[v] == distances[v] && d + get(weight, *ei) == distances[v]) {
+                predecessors[v] = u;
+                removed.push_back(v);
+            }
+        }
+    }
+    for (Vertex v : scratch.touched) {
+        dist[v].store(INFINITE_BITS, memory_order_relaxed);
+        relaxed[v] = numeric_limits<double>::max();
+    }
+
+    counters.settled = scratch.settled;
+    record_search(counters);
+}
+
+template <class G>
+static void engine_dijkstra_impl(const G &g, Vertex source, const vector<Vertex> &goals, SearchScratch &scratch)
+{
+    switch (scratch.engine) {
+        case SearchEngine::RadixHeap:
+            radix_dijkstra(g, source, goals, scratch);
+            return;
+        case SearchEngine::BucketQueue:
+            bucket_dijkstra(g, source, goals, scratch);
+            return;
+        case SearchEngine::DeltaStepping:
+            delta_stepping(g, source, goals, scratch);
+            return;
+        case SearchEngine::BinaryHeap:
+            break;
+    }
+    SearchEngine engine = scratch.engine;
+    scratch.engine = SearchEngine::BinaryHeap;
+    dijkstra_to_goals(g, source, goals, scratch);
+    scratch.engine = engine;
+}
+
+void engine_dijkstra(const Graph &g, Vertex source, const vector<Vertex> &goals, SearchScratch &scratch)
+{
+    engine_dijkstra_impl(g, source, goals, scratch);
+}
+
+void engine_dijkstra(const CSRGraph &g, Vertex source, const vector<Vertex> &goals, SearchScratch &scratch)
+{
+    engine_dijkstra_impl(g, source, goals, scratch);
+}
+
+void engine_dijkstra(const CompactGraph &g, Vertex source, const vector<Vertex> &goals, SearchScratch &scratch)
+{
+    engine_dijkstra_impl(g, source, goals, scratch);
+}
@@ -0,0 +1,334 @@
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <queue>
+#include <thread>
+#include <cmath>
+#include <string>
+#include <charconv>
+#include <system_error>
+#include "spatial_index.h"
+#include "ordered_writer.h"
+#include "vertex_order.h"
+
+using namespace std;
+
+// Positions par thread en dessous desquelles la recherche par lots reste sur un seul thread
+static const size_t MIN_POSITIONS_PER_THREAD = 1024;
+
+SpatialIndex SpatialIndex::build(const CoordinateStore &coord_list, bool planar)
+{
+    SpatialIndex index;
+    index.planar = planar;
+    size_t n = coord_list.size();
+    index.ids.resize(n);
+    iota(index.ids.begin(), index.ids.end(), 0);
+    index.split_axis.assign(n, 0);
+
+    const double *axes[3] = {coord_list.x_data(), coord_list.y_data(), coord_list.z_data()};
+    auto coordinate = [&](uint32_t v, int a) { return a == 2 && planar ? 0.0 : axes[a][v]; };
+
+    // Tranches à découper, sans récursion ; chaque milieu devient la médiane selon l'axe le plus étendu
+    vector<pair<size_t, size_t>> ranges = {{0, n}};
+    while (!ranges.empty()) {
+        auto [lo, hi] = ranges.back();
+        ranges.pop_back();
+        if (hi - lo <= LEAF_SIZE) {
+            continue;
+        }
+        int axis = 0;
+        double widest = -1;
+        for (int a = 0; a < (planar ? 2 : 3); ++a) {
+            auto [min_it, max_it] = minmax_element(index.ids.begin() + lo, index.ids.begin() + hi,
+                                                   [&](uint32_t u, uint32_t v) { return axes[a][u] < axes[a][v]; });
+            double extent = axes[a][*max_it] - axes[a][*min_it];
+            if (extent > widest) {
+                widest = extent;
+                axis = a;
+            }
+        }
+        size_t mid = lo + (hi - lo) / 2;
+        nth_element(index.ids.begin() + lo, index.ids.begin() + mid, index.ids.begin() + hi, [&](uint32_t u, uint32_t v) {
+            double cu = coordinate(u, axis), cv = coordinate(v, axis);
+            return cu < cv || (cu == cv && u < v);
+        });
+        index.split_axis[mid] = static_cast<uint8_t>(axis);
+        ranges.push_back({lo, mid});
+        ranges.push_back({mid + 1, hi});
+    }
+
+    // Positions dans l'ordre de l'arbre : une feuille est lue d'un seul tenant
+    index.px.resize(n);
+    index.py.resize(n);
+    index.pz.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t v = index.ids[i];
+        index.px[i] = coordinate(v, 0);
+        index.py[i] = coordinate(v, 1);
+        index.pz[i] = coordinate(v, 2);
+    }
+    return index;
+}
+
+/**
+ * @brief parcours de la tranche [lo, hi), moitié du côté de q d'abord ; l'autre moitié n'est visitée que si
+ * son plan de coupe est à une distance au carré d'au plus bound() (égalité comprise, pour le départage par numéro)
+ */
+template <typename Visit, typename Bound>
+void SpatialIndex::search_nearest(size_t lo, size_t hi, const double q[3], Visit &visit, Bound &bound) const
+{
+    if (hi - lo <= LEAF_SIZE) {
+        for (size_t i = lo; i < hi; ++i) {
+            visit(i);
+        }
+        return;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    int axis = split_axis[mid];
+    double d = q[axis] - coordinate(mid, axis);
+    visit(mid);
+    if (d < 0) {
+        search_nearest(lo, mid, q, visit, bound);
+        if (d * d <= bound()) {
+            search_nearest(mid + 1, hi, q, visit, bound);
+        }
+    } else {
+        search_nearest(mid + 1, hi, q, visit, bound);
+        if (d * d <= bound()) {
+            search_nearest(lo, mid, q, visit, bound);
+        }
+    }
+}
+
+template <typename Visit>
+void SpatialIndex::search_box(size_t lo, size_t hi, const double box_lo[3], const double box_hi[3], Visit &visit) const
+{
+    auto inside = [&](size_t i) {
+        for (int a = 0; a < 3; ++a) {
+            double c = coordinate(i, a);
+            if (c < box_lo[a] || c > box_hi[a]) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (hi - lo <= LEAF_SIZE) {
+        for (size_t i = lo; i < hi; ++i) {
+            if (inside(i)) {
+                visit(i);
+            }
+        }
+        return;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    int axis = split_axis[mid];
+    double split = coordinate(mid, axis);
+    if (inside(mid)) {
+        visit(mid);
+    }
+    // Moitié basse : coordonnées au plus split, moitié haute : au moins split
+    if (box_lo[axis] <= split) {
+        search_box(lo, mid, box_lo, box_hi, visit);
+    }
+    if (box_hi[axis] >= split) {
+        search_box(mid + 1, hi, box_lo, box_hi, visit);
+    }
+}
+
+bool SpatialIndex::nearest(double x, double y, double z, NearestVertex &result) const
+{
+    if (ids.empty()) {
+        return false;
+    }
+    const double q[3] = {x, y, planar ? 0.0 : z};
+    size_t best = 0;
+    double best_distance = numeric_limits<double>::infinity();
+    auto visit = [&](size_t i) {
+        double d = squared_distance(i, q);
+        if (d < best_distance || (d == best_distance && ids[i] < ids[best])) {
+            best_distance = d;
+            best = i;
+        }
+    };
+    auto bound = [&]() { return best_distance; };
+    search_nearest(0, ids.size(), q, visit, bound);
+    result = {ids[best], sqrt(best_distance)};
+    return true;
+}
+
+vector<NearestVertex> SpatialIndex::k_nearest(double x, double y, double z, size_t k) const
+{
+    vector<NearestVertex> result;
+    k = min(k, ids.size());
+    if (k == 0) {
+        return result;
+    }
+    const double q[3] = {x, y, planar ? 0.0 : z};
+    // Tas des k meilleurs (distance au carré, sommet), le moins bon au sommet
+    priority_queue<pair<double, uint32_t>> best;
+    auto visit = [&](size_t i) {
+        pair<double, uint32_t> candidate(squared_distance(i, q), ids[i]);
+        if (best.size() < k) {
+            best.push(candidate);
+        } else if (candidate < best.top()) {
+            best.pop();
+            best.push(candidate);
+        }
+    };
+    auto bound = [&]() { return best.size() < k ? numeric_limits<double>::infinity() : best.top().first; };
+    search_nearest(0, ids.size(), q, visit, bound);
+
+    result.resize(best.size());
+    for (size_t i = result.size(); i-- > 0;) {
+        result[i] = {best.top().second, sqrt(best.top().first)};
+        best.pop();
+    }
+    return result;
+}
+
+vector<uint32_t> SpatialIndex::within_radius(double x, double y, double z, double radius) const
+{
+    vector<uint32_t> result;
+    if (ids.empty() || !(radius >= 0)) {
+        return result;
+    }
+    const double q[3] = {x, y, planar ? 0.0 : z};
+    double limit = radius * radius;
+    auto visit = [&](size_t i) {
+        if (squared_distance(i, q) <= limit) {
+            result.push_back(ids[i]);
+        }
+    };
+    auto bound = [&]() { return limit; };
+    search_nearest(0, ids.size(), q, visit, bound);
+    sort(result.begin(), result.end());
+    return result;
+}
+
+vector<uint32_t> SpatialIndex::within_box(const array<double, 3> &lo, const array<double, 3> &hi) const
+{
+    vector<uint32_t> result;
+    if (ids.empty()) {
+        return result;
+    }
+    // Index plan : altitude ignorée
+    const double box_lo[3] = {lo[0], lo[1], planar ? 0.0 : lo[2]};
+    const double box_hi[3] = {hi[0], hi[1], planar ? 0.0 : hi[2]};
+    auto visit = [&](size_t i) { result.push_back(ids[i]); };
+    search_box(0, ids.size(), box_lo, box_hi, visit);
+    sort(result.begin(), result.end());
+    return result;
+}
+
+size_t SpatialIndex::memory_used() const
+{
+    return ids.capacity() * sizeof(uint32_t) + (px.capacity() + py.capacity() + pz.capacity()) * sizeof(double) +
+           split_axis.capacity() * sizeof(uint8_t);
+}
+
+void snap_to_vertices(const SpatialIndex &index, const vector<array<double, 3>> &positions, vector<NearestVertex> &nearest,
+                      unsigned num_threads)
+{
+    size_t m = positions.size();
+    nearest.resize(m);
+    auto run = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            index.nearest(positions[i][0], positions[i][1], positions[i][2], nearest[i]);
+        }
+    };
+
+    num_threads = resolve_num_threads(num_threads, m / MIN_POSITIONS_PER_THREAD);
+    if (num_threads <= 1) {
+        run(0, m);
+        return;
+    }
+    vector<thread> workers;
+    size_t chunk = (m + num_threads - 1) / num_threads;
+    for (unsigned t = 0; t < num_threads; ++t) {
+        size_t begin = min(m, t * chunk), end = min(m, begin + chunk);
+        workers.emplace_back(run, begin, end);
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+}
+
+CSVLoadResult read_position_pairs(istream &in, vector<PositionPair> &pairs)
+{
+    CSVLoadResult result;
+    result.opened = true;
+    size_t line_number = 0;
+    string line;
+    auto fail = [&](const string &message) {
+        if (result.errors.size() < CSVLoadResult::MAX_REPORTED) {
+            result.errors.push_back({line_number, message});
+        }
+        result.malformed++;
+    };
+
+    while (getline(in, line)) {
+        ++line_number;
+        const char *p = line.data(), *end = line.data() + line.size();
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+        if (p == end) {
+            continue;
+        }
+
+        // Six valeurs réelles séparées par ';'
+        PositionPair pair;
+        double *values[6] = {&pair.start[0], &pair.start[1], &pair.start[2], &pair.goal[0], &pair.goal[1], &pair.goal[2]};
+        string error;
+        for (int k = 0; k < 6 && error.empty(); ++k) {
+            while (p < end && (*p == ' ' || *p == '\t')) ++p;
+            auto [ptr, ec] = from_chars(p, end, *values[k]);
+            if (ec != errc() || ptr == p || !isfinite(*values[k])) {
+                error = "coordonnée invalide : '" + string(p, find(p, end, ';')) + "' (\"x1;y1;z1;x2;y2;z2\" attendu)";
+                break;
+            }
+            p = ptr;
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+            if (k < 5) {
+                if (p == end || *p != ';') {
+                    error = "séparateur ';' attendu (\"x1;y1;z1;x2;y2;z2\" attendu)";
+                } else {
+                    ++p;
+                }
+            } else if (p != end) {
+                error = "caractères inattendus après la dernière valeur";
+            }
+        }
+        if (!error.empty()) {
+            fail(error);
+            continue;
+        }
+        pairs.push_back(pair);
+        result.records++;
+    }
+    return result;
+}
+
+double snap_pairs(const SpatialIndex &index, const VertexNumbering &numbering, const vector<PositionPair> &positions,
+                  vector<pair<double, double>> &list_Node, unsigned num_threads)
+{
+    if (index.empty()) {
+        return 0;
+    }
+    // Départs et arrivées cherchés dans un seul lot
+    vector<array<double, 3>> points;
+    points.reserve(2 * positions.size());
+    for (const PositionPair &p : positions) {
+        points.push_back(p.start);
+        points.push_back(p.goal);
+    }
+    vector<NearestVertex> nearest;
+    snap_to_vertices(index, points, nearest, num_threads);
+
+    double farthest = 0;
+    list_Node.reserve(list_Node.size() + positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const NearestVertex &start = nearest[2 * i], &goal = nearest[2 * i + 1];
+        list_Node.push_back({numbering.external(start.vertex) + 1.0, numbering.external(goal.vertex) + 1.0});
+        farthest = max({farthest, start.distance, goal.distance});
+    }
+    return farthest;
+}
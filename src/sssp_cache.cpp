@@ -0,0 +1,256 @@
+#include <iostream>
+#include <algorithm>
+#include <limits>
+#include "sssp_cache.h"
+
+using namespace std;
+using namespace boost;
+
+bool ShortestPathTree::extract_path(Vertex goal, vector<Vertex> &path) const
+{
+    path.clear();
+    if (distances[goal] == numeric_limits<double>::max()) {
+        return false;
+    }
+
+    for (Vertex v = goal; v != source; v = predecessors[v]) {
+        if (v == predecessors[v]) {
+            cerr << "Erreur dans le chemin, arrêt prématuré" << endl;
+            path.clear();
+            return false;
+        }
+        path.push_back(v);
+    }
+    path.push_back(source);
+    reverse(path.begin(), path.end());
+    return true;
+}
+
+PathResult ShortestPathTree::query(Vertex goal) const
+{
+    PathResult result;
+    result.found = extract_path(goal, result.path);
+    result.length = result.found ? distances[goal] : numeric_limits<double>::max();
+    return result;
+}
+
+size_t ShortestPathTree::bytes() const
+{
+    return sizeof(ShortestPathTree) + distances.capacity() * sizeof(double) + predecessors.capacity() * sizeof(uint32_t);
+}
+
+ShortestPathTreeCache::ShortestPathTreeCache(size_t budget_bytes) : budget_bytes(budget_bytes)
+{
+}
+
+std::shared_ptr<const ShortestPathTree> ShortestPathTreeCache::find(Vertex source)
+{
+    lock_guard<mutex> lock(m);
+    auto it = index.find(source);
+    if (it == index.end()) {
+        miss_count++;
+        return nullptr;
+    }
+    hit_count++;
+    lru.splice(lru.begin(), lru, it->second);
+    return it->second->second;
+}
+
+template <class G>
+static std::shared_ptr<const ShortestPathTree> compute_tree(const G &g, Vertex source, SearchScratch &scratch)
+{
+    // Dijkstra sans arrivée : toute la composante de la source est fixée
+    dijkstra_to_goals(g, source, {}, scratch);
+
+    auto tree = std::make_shared<ShortestPathTree>();
+    tree->source = source;
+    tree->distances = scratch.distances;
+    tree->predecessors = scratch.predecessors;
+    return tree;
+}
+
+std::shared_ptr<const ShortestPathTree> ShortestPathTreeCache::tree(const Graph &g, Vertex source, SearchScratch &scratch)
+{
+    if (auto cached = find(source)) {
+        return cached;
+    }
+    auto computed = compute_tree(g, source, scratch);
+    if (!scratch.cancelled) {
+        insert(computed);
+    }
+    return computed;
+}
+
+std::shared_ptr<const ShortestPathTree> ShortestPathTreeCache::tree(const CSRGraph &g, Vertex source, SearchScratch &scratch)
+{
+    if (auto cached = find(source)) {
+        return cached;
+    }
+    auto computed = compute_tree(g, source, scratch);
+    if (!scratch.cancelled) {
+        insert(computed);
+    }
+    return computed;
+}
+
+std::shared_ptr<const ShortestPathTree> ShortestPathTreeCache::tree(const CompactGraph &g, Vertex source, SearchScratch &scratch)
+{
+    if (auto cached = find(source)) {
+        return cached;
+    }
+    auto computed = compute_tree(g, source, scratch);
+    if (!scratch.cancelled) {
+        insert(computed);
+    }
+    return computed;
+}
+
+void ShortestPathTreeCache::insert(std::shared_ptr<const ShortestPathTree> tree)
+{
+    lock_guard<mutex> lock(m);
+    auto it = index.find(tree->source);
+    if (it != index.end()) {
+        used_bytes -= it->second->second->bytes();
+        lru.erase(it->second);
+        index.erase(it);
+    }
+
+    lru.emplace_front(tree->source, tree);
+    index[tree->source] = lru.begin();
+    used_bytes += tree->bytes();
+    evict_locked();
+}
+
+size_t ShortestPathTreeCache::replace_trees(const function<std::shared_ptr<const ShortestPathTree>(const ShortestPathTree &)> &f)
+{
+    lock_guard<mutex> lock(m);
+    size_t replaced = 0;
+    for (Entry &entry : lru) {
+        std::shared_ptr<const ShortestPathTree> next = f(*entry.second);
+        if (next) {
+            used_bytes = used_bytes - entry.second->bytes() + next->bytes();
+            entry.second = std::move(next);
+            replaced++;
+        }
+    }
+    evict_locked();
+    return replaced;
+}
+
+void ShortestPathTreeCache::evict_locked()
+{
+    while (used_bytes > budget_bytes && !lru.empty()) {
+        const Entry &oldest = lru.back();
+        used_bytes -= oldest.second->bytes();
+        index.erase(oldest.first);
+        lru.pop_back();
+        eviction_count++;
+    }
+}
+
+bool ShortestPathTreeCache::repeated_miss(Vertex source)
+{
+    lock_guard<mutex> lock(m);
+    if (missed_once.erase(source)) {
+        return true;
+    }
+    if (missed_once.size() >= MAX_PENDING_SOURCES) {
+        missed_once.clear();
+    }
+    missed_once.insert(source);
+    return false;
+}
+
+void ShortestPathTreeCache::set_budget(size_t budget)
+{
+    lock_guard<mutex> lock(m);
+    budget_bytes = budget;
+    evict_locked();
+}
+
+void ShortestPathTreeCache::clear()
+{
+    lock_guard<mutex> lock(m);
+    lru.clear();
+    index.clear();
+    missed_once.clear();
+    used_bytes = 0;
+}
+
+size_t ShortestPathTreeCache::budget() const
+{
+    lock_guard<mutex> lock(m);
+    return budget_bytes;
+}
+
+size_t ShortestPathTreeCache::memory_used() const
+{
+    lock_guard<mutex> lock(m);
+    return used_bytes;
+}
+
+size_t ShortestPathTreeCache::size() const
+{
+    lock_guard<mutex> lock(m);
+    return lru.size();
+}
+
+size_t ShortestPathTreeCache::hits() const
+{
+    lock_guard<mutex> lock(m);
+    return hit_count;
+}
+
+size_t ShortestPathTreeCache::misses() const
+{
+    lock_guard<mutex> lock(m);
+    return miss_count;
+}
+
+size_t ShortestPathTreeCache::evictions() const
+{
+    lock_guard<mutex> lock(m);
+    return eviction_count;
+}
+
+template <class G>
+static PathResult cached_query_impl(const G &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, SearchScratch &scratch, ShortestPathTreeCache &cache)
+{
+    if (auto tree = cache.find(start)) {
+        return tree->query(goal);
+    }
+    // Premier échec d'une source en A* ou bidirectionnel : une recherche point à point coûte moins qu'un arbre complet
+    if (mode != SearchMode::Dijkstra && !cache.repeated_miss(start)) {
+        return shortest_path_query(g, coord_list, start, goal, mode, scratch);
+    }
+
+    // Échec en mode Dijkstra, ou source déjà demandée : l'arbre complet sert aussi aux arrivées suivantes depuis
+    // la même source. Arbre abandonné en cours de route : incomplet, il n'entre pas dans le cache
+    auto tree = compute_tree(g, start, scratch);
+    if (scratch.cancelled) {
+        PathResult result;
+        result.cancelled = true;
+        result.length = numeric_limits<double>::max();
+        result.settled = scratch.settled;
+        return result;
+    }
+    cache.insert(tree);
+    PathResult result = tree->query(goal);
+    result.settled = scratch.settled;
+    return result;
+}
+
+PathResult shortest_path_query(const Graph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, SearchScratch &scratch, ShortestPathTreeCache &cache)
+{
+    return cached_query_impl(g, coord_list, start, goal, mode, scratch, cache);
+}
+
+PathResult shortest_path_query(const CSRGraph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, SearchScratch &scratch, ShortestPathTreeCache &cache)
+{
+    return cached_query_impl(g, coord_list, start, goal, mode, scratch, cache);
+}
+
+PathResult shortest_path_query(const CompactGraph &g, const CoordinateStore &coord_list, Vertex start, Vertex goal, SearchMode mode, SearchScratch &scratch, ShortestPathTreeCache &cache)
+{
+    return cached_query_impl(g, coord_list, start, goal, mode, scratch, cache);
+}
@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <numeric>
+#include <array>
+#include <limits>
+#include <cmath>
+#include "vertex_order.h"
+#include "path_search.h"
+#include "instrumentation.h"
+
+using namespace std;
+using namespace boost;
+
+const char *vertex_ordering_name(VertexOrdering ordering)
+{
+    switch (ordering) {
+        case VertexOrdering::None: return "none";
+        case VertexOrdering::Hilbert: return "hilbert";
+        case VertexOrdering::Morton: return "morton";
+        case VertexOrdering::CuthillMcKee: return "rcm";
+    }
+    return "unknown";
+}
+
+bool parse_vertex_ordering(const string &name, VertexOrdering &ordering)
+{
+    for (VertexOrdering o : {VertexOrdering::None, VertexOrdering::Hilbert, VertexOrdering::Morton, VertexOrdering::CuthillMcKee}) {
+        if (name == vertex_ordering_name(o)) {
+            ordering = o;
+            return true;
+        }
+    }
+    return false;
+}
+
+vector<pair<double, double>> VertexNumbering::internal_pairs(const vector<pair<double, double>> &pairs, size_t n) const
+{
+    vector<pair<double, double>> result(pairs);
+    if (!renumbered()) {
+        return result;
+    }
+    for (auto &[start, goal] : result) {
+        if (valid_pair(start, goal, n)) {
+            start = internal(static_cast<Vertex>(start) - 1) + 1.0;
+            goal = internal(static_cast<Vertex>(goal) - 1) + 1.0;
+        }
+    }
+    return result;
+}
+
+VertexNumbering VertexNumbering::permuted(const vector<uint32_t> &order) const
+{
+    VertexNumbering result;
+    size_t n = order.size();
+    result.to_external.resize(n);
+    result.to_internal.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t file = static_cast<uint32_t>(external(order[i]));
+        result.to_external[i] = file;
+        result.to_internal[file] = static_cast<uint32_t>(i);
+    }
+    return result;
+}
+
+// Courbes sur une grille de 2^21 cases par axe (clé de 63 bits) ------------------------------------------
+
+static const unsigned CURVE_BITS = 21;
+
+/**
+ * @brief coordonnées ramenées sur la grille de la boîte englobante
+ */
+static vector<std::array<uint32_t, 3>> grid_coordinates(const CoordinateStore &coord_list)
+{
+    double lo[3] = {numeric_limits<double>::max(), numeric_limits<double>::max(), numeric_limits<double>::max()};
+    double hi[3] = {-numeric_limits<double>::max(), -numeric_limits<double>::max(), -numeric_limits<double>::max()};
+    const double *axes[3] = {coord_list.x_data(), coord_list.y_data(), coord_list.z_data()};
+    for (int a = 0; a < 3; ++a) {
+        for (size_t v = 0; v < coord_list.size(); ++v) {
+            lo[a] = min(lo[a], axes[a][v]);
+            hi[a] = max(hi[a], axes[a][v]);
+        }
+    }
+    // Même échelle sur les trois axes, pour ne pas étirer la courbe
+    double extent = 0;
+    for (int a = 0; a < 3; ++a) {
+        extent = max(extent, hi[a] - lo[a]);
+    }
+    double scale = extent > 0 ? ((1u << CURVE_BITS) - 1) / extent : 0;
+
+    vector<std::array<uint32_t, 3>> grid(coord_list.size());
+    for (size_t v = 0; v < coord_list.size(); ++v) {
+        for (int a = 0; a < 3; ++a) {
+            grid[v][a] = static_cast<uint32_t>((axes[a][v] - lo[a]) * scale);
+        }
+    }
+    return grid;
+}
+
+/**
+ * @brief bits de x écartés d'un rang sur trois (bit i en position 3i)
+ */
+static uint64_t spread_bits(uint32_t x)
+{
+    uint64_t v = x & 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffffULL;
+    v = (v | v << 16) & 0x1f0000ff0000ffULL;
+    v = (v | v << 8) & 0x100f00f00f00f00fULL;
+    v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+    v = (v | v << 2) & 0x1249249249249249ULL;
+    return v;
+}
+
+static uint64_t morton_key(const std::array<uint32_t, 3> &c)
+{
+    return spread_bits(c[0]) << 2 | spread_bits(c[1]) << 1 | spread_bits(c[2]);
+}
+
+/**
+ * @brief indice sur la courbe de Hilbert 3D (méthode de Skilling : coordonnées transposées puis entrelacées)
+ */
+static uint64_t hilbert_key(std::array<uint32_t, 3> x)
+{
+    const uint32_t top = 1u << (CURVE_BITS - 1);
+    // Passage inverse : rotations et réflexions de chaque niveau
+    for (uint32_t q = top; q > 1; q >>= 1) {
+        uint32_t p = q - 1;
+        for (int a = 0; a < 3; ++a) {
+            if (x[a] & q) {
+                x[0] ^= p;
+            } else {
+                uint32_t t = (x[0] ^ x[a]) & p;
+                x[0] ^= t;
+                x[a] ^= t;
+            }
+        }
+    }
+    // Code de Gray
+    for (int a = 1; a < 3; ++a) {
+        x[a] ^= x[a - 1];
+    }
+    uint32_t t = 0;
+    for (uint32_t q = top; q > 1; q >>= 1) {
+        if (x[2] & q) {
+            t ^= q - 1;
+        }
+    }
+    for (int a = 0; a < 3; ++a) {
+        x[a] ^= t;
+    }
+    return morton_key(x);
+}
+
+// Cuthill-McKee inverse ----------------------------------------------------------------------------------
+
+/**
+ * @brief ordre de Cuthill-McKee inverse, composante par composante
+ *
+ * Chaque composante part d'un sommet pseudo-périphérique : sommet de degré minimal, remplacé par le sommet
+ * de plus petit degré du dernier niveau d'un premier parcours. Les voisins non visités sont ajoutés par
+ * degrés croissants.
+ */
+template <typename G>
+static vector<uint32_t> cuthill_mckee_order(const G &g)
+{
+    using GVertex = typename graph_traits<G>::vertex_descriptor;
+    size_t n = num_vertices(g);
+    vector<uint32_t> degree(n);
+    for (size_t v = 0; v < n; ++v) {
+        degree[v] = static_cast<uint32_t>(out_degree(static_cast<GVertex>(v), g));
+    }
+    vector<uint32_t> by_degree(n);
+    iota(by_degree.begin(), by_degree.end(), 0);
+    stable_sort(by_degree.begin(), by_degree.end(), [&](uint32_t a, uint32_t b) { return degree[a] < degree[b]; });
+
+    vector<uint32_t> order;
+    order.reserve(n);
+    vector<char> visited(n, 0);
+    vector<uint32_t> neighbors;
+
+    // Parcours en largeur depuis start, sommets ajoutés à order ; renvoie le début du dernier niveau
+    auto bfs = [&](uint32_t start) {
+        size_t first = order.size(), level_begin = first;
+        order.push_back(start);
+        visited[start] = 1;
+        size_t level_end = order.size();
+        for (size_t i = first; i < order.size(); ++i) {
+            if (i == level_end) {
+                level_begin = level_end;
+                level_end = order.size();
+            }
+            uint32_t u = order[i];
+            neighbors.clear();
+            for (auto [ei, ei_end] = out_edges(static_cast<GVertex>(u), g); ei != ei_end; ++ei) {
+                uint32_t v = static_cast<uint32_t>(target(*ei, g));
+                if (!visited[v]) {
+                    visited[v] = 1;
+                    neighbors.push_back(v);
+                }
+            }
+            stable_sort(neighbors.begin(), neighbors.end(), [&](uint32_t a, uint32_t b) { return degree[a] < degree[b]; });
+            order.insert(order.end(), neighbors.begin(), neighbors.end());
+        }
+        return level_begin;
+    };
+
+    for (uint32_t start : by_degree) {
+        if (visited[start]) {
+            continue;
+        }
+        // Premier parcours pour trouver un sommet éloigné, annulé avant le parcours définitif
+        size_t first = order.size();
+        size_t last_level = bfs(start);
+        uint32_t peripheral = *min_element(order.begin() + last_level, order.end(), [&](uint32_t a, uint32_t b) { return degree[a] < degree[b]; });
+        for (size_t i = first; i < order.size(); ++i) {
+            visited[order[i]] = 0;
+        }
+        order.resize(first);
+        bfs(peripheral);
+    }
+
+    reverse(order.begin(), order.end());
+    return order;
+}
+
+// Application de la permutation --------------------------------------------------------------------------
+
+template <typename G>
+static void arc_locality(const G &g, uint64_t &bandwidth, double &log_gap)
+{
+    bandwidth = 0;
+    double sum = 0;
+    for (auto [ei, ei_end] = edges(g); ei != ei_end; ++ei) {
+        uint64_t u = source(*ei, g), v = target(*ei, g);
+        uint64_t gap = u > v ? u - v : v - u;
+        bandwidth = max(bandwidth, gap);
+        sum += log2(1.0 + gap);
+    }
+    log_gap = num_edges(g) ? sum / num_edges(g) : 0;
+}
+
+/**
+ * @brief graph reconstruit à partir des arcs renumérotés, triés par source puis par cible
+ */
+static void rebuild(CSRGraph &g, size_t n, const vector<pair<uint32_t, uint32_t>> &arcs, const vector<float> &arc_weights)
+{
+    g = CSRGraph(edges_are_sorted, arcs.begin(), arcs.end(), arc_weights.begin(), n, arcs.size());
+}
+
+static void rebuild(CompactGraph &g, size_t n, const vector<pair<uint32_t, uint32_t>> &arcs, const vector<float> &arc_weights)
+{
+    vector<uint64_t> offsets(n + 1, 0);
+    vector<uint32_t> targets;
+    targets.reserve(arcs.size());
+    for (const auto &[u, v] : arcs) {
+        offsets[u + 1]++;
+        targets.push_back(v);
+    }
+    for (size_t v = 1; v <= n; ++v) {
+        offsets[v] += offsets[v - 1];
+    }
+    // Renumérotation d'un graph compact : arcs toujours symétriques, la construction ne peut échouer
+    build_compact(n, offsets.data(), targets.data(), arc_weights.data(), g);
+}
+
+template <typename G>
+static VertexNumbering reorder_vertices_impl(G &g, CoordinateStore &coord_list, VertexOrdering ordering, const VertexNumbering &numbering,
+                                             ReorderReport &report)
+{
+    using GVertex = typename graph_traits<G>::vertex_descriptor;
+    ScopedTimer timer(Phase::Build);
+    report = ReorderReport();
+    report.ordering = ordering;
+    arc_locality(g, report.bandwidth_before, report.log_gap_before);
+
+    size_t n = num_vertices(g);
+    if (ordering == VertexOrdering::None || n == 0) {
+        report.bandwidth_after = report.bandwidth_before;
+        report.log_gap_after = report.log_gap_before;
+        return numbering;
+    }
+
+    // order[nouveau] = ancien
+    vector<uint32_t> order;
+    if (ordering == VertexOrdering::CuthillMcKee) {
+        order = cuthill_mckee_order(g);
+    } else {
+        vector<std::array<uint32_t, 3>> grid = grid_coordinates(coord_list);
+        vector<uint64_t> keys(n);
+        for (size_t v = 0; v < n; ++v) {
+            keys[v] = ordering == VertexOrdering::Hilbert ? hilbert_key(grid[v]) : morton_key(grid[v]);
+        }
+        order.resize(n);
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+    }
+    vector<uint32_t> rank(n);
+    for (size_t i = 0; i < n; ++i) {
+        rank[order[i]] = static_cast<uint32_t>(i);
+    }
+
+    // Arcs renumérotés, triés par source puis par cible
+    auto weight = get(edge_weight, g);
+    vector<pair<uint32_t, uint32_t>> arcs;
+    vector<float> arc_weights;
+    arcs.reserve(num_edges(g));
+    arc_weights.reserve(num_edges(g));
+    vector<pair<uint32_t, float>> out;
+    for (size_t i = 0; i < n; ++i) {
+        out.clear();
+        for (auto [ei, ei_end] = out_edges(static_cast<GVertex>(order[i]), g); ei != ei_end; ++ei) {
+            out.emplace_back(rank[target(*ei, g)], get(weight, *ei));
+        }
+        stable_sort(out.begin(), out.end(), [](const pair<uint32_t, float> &a, const pair<uint32_t, float> &b) { return a.first < b.first; });
+        for (const auto &[v, w] : out) {
+            arcs.emplace_back(static_cast<uint32_t>(i), v);
+            arc_weights.push_back(w);
+        }
+    }
+    rebuild(g, n, arcs, arc_weights);
+
+    coord_list.permute(order);
+
+    arc_locality(g, report.bandwidth_after, report.log_gap_after);
+    return numbering.permuted(order);
+}
+
+VertexNumbering reorder_vertices(CSRGraph &g, CoordinateStore &coord_list, VertexOrdering ordering, const VertexNumbering &numbering, ReorderReport &report)
+{
+    return reorder_vertices_impl(g, coord_list, ordering, numbering, report);
+}
+
+VertexNumbering reorder_vertices(CompactGraph &g, CoordinateStore &coord_list, VertexOrdering ordering, const VertexNumbering &numbering, ReorderReport &report)
+{
+    return reorder_vertices_impl(g, coord_list, ordering, numbering, report);
+}
+
+void print_reorder_report(ostream &out, const ReorderReport &report)
+{
+    out << "Vertex ordering: " << vertex_ordering_name(report.ordering)
+        << ", bandwidth " << report.bandwidth_before << " -> " << report.bandwidth_after
+        << ", mean log2 gap between neighbours " << report.log_gap_before << " -> " << report.log_gap_after << endl;
+}
@@ -0,0 +1,442 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <array>
+#include <cstdlib>
+#include <optional>
+#include <filesystem>
+#include <type_traits>
+#include "graph_analysis.h"
+#include "graph_cache.h"
+#include "path_search.h"
+#include "contraction_hierarchy.h"
+#include "sssp_cache.h"
+#include "graph_metrics.h"
+#include "graph_updates.h"
+#include "cycle_analysis.h"
+#include "vertex_order.h"
+#include "spatial_index.h"
+#include "instrumentation.h"
+
+using namespace std;
+
+/**
+ * @brief interface en ligne de commande de l'analyse, sans Qt, pour les serveurs de calcul
+ *
+ * Mêmes étapes que l'application (compute_graph), avec fichiers d'entrée, couples exportés,
+ * requêtes, analyses et fichier de sortie choisis sur la ligne de commande.
+ */
+
+static void usage(const char *program)
+{
+    cerr << "Usage : " << program << " [options]\n"
+         << "  --nodes <fichier>          sommets \"id;x;y;z\" (data/nodes.csv)\n"
+         << "  --edges <fichier>          arêtes \"source;target\" (data/edges.csv)\n"
+         << "  --graph-cache <fichier>    cache binaire du graph, relu s'il est à jour (aucun par défaut)\n"
+         << "  --pairs <fichier|->        couples exportés \"départ;arrivée\", - pour l'entrée standard (tous par défaut)\n"
+         << "  --query <départ> <arrivée> plus court chemin affiché (répétable)\n"
+         << "  --snap-pairs <fichier|->   positions \"x1;y1;z1;x2;y2;z2\" ramenées aux sommets les plus proches, ajoutées aux couples exportés\n"
+         << "  --nearest <x> <y> <z> <k>  k sommets les plus proches d'une position (répétable)\n"
+         << "  --mode <dijkstra|astar|bidirectional>  algorithme des requêtes (astar)\n"
+         << "  --engine <binary|radix|buckets|delta>  file de priorité des recherches de Dijkstra (binary)\n"
+         << "  --analyses <liste>         parmi metrics,cycles,export, séparés par des virgules, ou none (toutes)\n"
+         << "  --output <fichier>         fichier d'export (output.csv, ou output_paths.bin avec --format matrix)\n"
+         << "  --format <csv|matrix>      CSV ou matrice de prédécesseurs binaire (csv)\n"
+         << "  --reorder <hilbert|morton|rcm>  renumérotation interne des sommets (fichiers et affichage dans la numérotation des CSV)\n"
+         << "  --weights <double|float>   précision du calcul des poids des arêtes (double)\n"
+         << "  --updates <fichier>        lot \"operation;source;target[;weight]\" appliqué après le chargement (répétable)\n"
+         << "  --ch <fichier>             export par hiérarchie de contraction, prétraitée si le fichier est absent ou périmé\n"
+         << "  --compact                  graph compact : arêtes stockées une fois, sommets sur 32 bits (incompatible avec --updates)\n"
+         << "  --memory-report            mémoire de chaque structure et mémoire résidente du processus en fin d'exécution\n"
+         << "  --threads <n>              threads de calcul (tous les coeurs)\n"
+         << "  --tree-cache-mb <n>        cache des arbres de plus courts chemins (désactivé)\n"
+         << "  --per-vertex               degré de chaque sommet\n"
+         << "  --metrics-json <fichier>   métriques au format JSON\n"
+         << "  --instrumentation <fichier> temps par phase et compteurs (JSON, Prometheus si .prom)" << endl;
+}
+
+/**
+ * @brief mémoire du graph, par composant pour le graph compact
+ */
+static void add_graph_memory(MemoryReport &report, const CSRGraph &g)
+{
+    report.add("graph (CSR)", csr_memory_used(g));
+}
+
+static void add_graph_memory(MemoryReport &report, const CompactGraph &g)
+{
+    report.add("graph offsets", g.offsets_bytes());
+    report.add("graph edges", g.edges_bytes());
+    report.add("graph reverse index", g.reverse_index_bytes());
+    report.add("graph arc order", g.arc_order_bytes());
+}
+
+static bool parse_mode(const string &name, SearchMode &mode)
+{
+    if (name == "dijkstra") mode = SearchMode::Dijkstra;
+    else if (name == "astar") mode = SearchMode::AStar;
+    else if (name == "bidirectional") mode = SearchMode::Bidirectional;
+    else return false;
+    return true;
+}
+
+static bool parse_analyses(const string &list, ComputeOptions &options)
+{
+    options.run_metrics = options.run_cycles = options.run_export = false;
+    if (list == "none") {
+        return true;
+    }
+    stringstream ss(list);
+    string name;
+    while (getline(ss, name, ',')) {
+        if (name == "metrics") options.run_metrics = true;
+        else if (name == "cycles") options.run_cycles = true;
+        else if (name == "export") options.run_export = true;
+        else return false;
+    }
+    return true;
+}
+
+/**
+ * @brief application des lots au graph chargé : métriques tenues à jour et export CSV existant corrigé
+ * ligne par ligne au lieu d'être recalculé ; les analyses ainsi traitées sont retirées de options
+ *
+ * L'export n'est corrigé que si son empreinte correspond au graph d'avant les lots (mêmes CSV, renumérotation
+ * et couples, aucun lot) ; sinon il est recalculé entièrement après les lots.
+ *
+ * @param fingerprint empreinte de l'export du graph chargé, complétée des lots appliqués
+ * @return false si un lot est illisible ou contient des lignes invalides (aucun lot suivant n'est appliqué)
+ */
+static bool apply_update_batches(const vector<string> &update_files, CSRGraph &g, const CoordinateStore &coord_list, const VertexNumbering &numbering,
+                                 ComputeOptions &options, ShortestPathTreeCache *cache, ExportFingerprint &fingerprint)
+{
+    std::optional<IncrementalMetrics> metrics;
+    if (options.run_metrics) {
+        metrics.emplace(g, options.num_threads);
+    }
+
+    string output = options.output.empty() ? "output.csv" : options.output;
+    bool patch_export = options.run_export && options.format == ExportFormat::CSV && std::filesystem::exists(output);
+    if (patch_export && !export_matches_fingerprint(output, fingerprint)) {
+        cout << "Export '" << output << "' not produced from this graph, full recompute after the updates" << endl;
+        patch_export = false;
+    }
+
+    for (const string &filename : update_files) {
+        vector<EdgeUpdate> updates;
+        CSVLoadResult loaded = load_edge_updates(filename, coord_list, numbering, updates);
+        if (!loaded.ok()) {
+            report_csv_errors(filename, loaded);
+            return false;
+        }
+        chain_update_batch(fingerprint, filename);
+
+        vector<ArcChange> changes = apply_edge_updates(g, updates, numbering);
+        cout << "Updates '" << filename << "': " << updates.size() << " operations, " << changes.size() << " vertex pairs changed, "
+             << num_edges(g) << " arcs" << endl;
+        if (cache) {
+            cout << "Shortest path trees repaired: " << repair_tree_cache(g, changes, *cache) << endl;
+        }
+        if (metrics) {
+            metrics->apply(g, changes);
+        }
+        if (patch_export) {
+            ExportUpdateResult result = update_export_csv(g, numbering, changes, output, options.num_threads, cache);
+            if (!result.ok) {
+                // Export illisible : recalcul complet après les lots
+                patch_export = false;
+                continue;
+            }
+            cout << "Export '" << output << "': " << result.rows << " rows, " << result.recomputed << " recomputed from "
+                 << result.sources << " sources, " << result.rewritten << " rewritten" << endl;
+        }
+    }
+
+    if (metrics) {
+        cout << "\n1. Node degree calculation :" << endl;
+        print_metrics_summary(cout, metrics->metrics());
+        if (options.per_vertex) {
+            print_vertex_degrees(cout, metrics->metrics(), numbering);
+        }
+        cout << "\n2. Graph Degree Calculation: " << endl;
+        cout << "Graph degree: " << metrics->metrics().max_degree << endl;
+        cout << "\n3. Graph Connectivity: " << endl;
+        cout << "Graph is connected: " << (metrics->metrics().connected() ? "True" : "False") << endl;
+        if (!options.metrics_json.empty() && write_metrics_json(options.metrics_json, metrics->metrics(), numbering)) {
+            cout << "Metrics written to '" << options.metrics_json << "'" << endl;
+        }
+        options.run_metrics = false;
+    }
+    if (patch_export) {
+        save_export_fingerprint(output, fingerprint);
+        options.run_export = false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    string filename_nodes = "data/nodes.csv";
+    string filename_edges = "data/edges.csv";
+    string filename_cache, filename_ch, filename_pairs, filename_positions, instrumentation_file;
+    vector<PositionPair> position_pairs;
+    vector<pair<array<double, 3>, size_t>> nearest_queries;
+    vector<string> update_files;
+    size_t tree_cache_budget = 0;
+    VertexOrdering ordering = VertexOrdering::None;
+    WeightPrecision precision = WeightPrecision::Double;
+    bool compact = false, memory_report = false;
+
+    ComputeOptions options;
+    options.queries.clear();
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--help" || arg == "-h") {
+            usage(argv[0]);
+            return 0;
+        } else if (arg == "--nodes" && has_value) {
+            filename_nodes = argv[++i];
+        } else if (arg == "--edges" && has_value) {
+            filename_edges = argv[++i];
+        } else if (arg == "--graph-cache" && has_value) {
+            filename_cache = argv[++i];
+        } else if (arg == "--pairs" && has_value) {
+            filename_pairs = argv[++i];
+        } else if (arg == "--snap-pairs" && has_value) {
+            filename_positions = argv[++i];
+        } else if (arg == "--nearest" && i + 4 < argc) {
+            nearest_queries.push_back({{strtod(argv[i + 1], nullptr), strtod(argv[i + 2], nullptr), strtod(argv[i + 3], nullptr)},
+                                       static_cast<size_t>(strtoull(argv[i + 4], nullptr, 10))});
+            i += 4;
+        } else if (arg == "--query" && i + 2 < argc) {
+            options.queries.push_back({strtoull(argv[i + 1], nullptr, 10), strtoull(argv[i + 2], nullptr, 10)});
+            i += 2;
+        } else if (arg == "--mode" && has_value) {
+            if (!parse_mode(argv[++i], options.query_mode)) {
+                cerr << "Mode de recherche inconnu : " << argv[i] << endl;
+                return 1;
+            }
+        } else if (arg == "--engine" && has_value) {
+            SearchEngine engine;
+            if (!parse_search_engine(argv[++i], engine)) {
+                cerr << "File de priorité inconnue : " << argv[i] << endl;
+                return 1;
+            }
+            set_default_search_engine(engine);
+        } else if (arg == "--analyses" && has_value) {
+            if (!parse_analyses(argv[++i], options)) {
+                cerr << "Analyse inconnue dans : " << argv[i] << endl;
+                return 1;
+            }
+        } else if (arg == "--output" && has_value) {
+            options.output = argv[++i];
+        } else if (arg == "--format" && has_value) {
+            string format = argv[++i];
+            if (format == "csv") {
+                options.format = ExportFormat::CSV;
+            } else if (format == "matrix") {
+                options.format = ExportFormat::PathMatrix;
+            } else {
+                cerr << "Format d'export inconnu : " << format << endl;
+                return 1;
+            }
+        } else if (arg == "--reorder" && has_value) {
+            if (!parse_vertex_ordering(argv[++i], ordering)) {
+                cerr << "Ordre des sommets inconnu : " << argv[i] << endl;
+                return 1;
+            }
+        } else if (arg == "--weights" && has_value) {
+            if (!parse_weight_precision(argv[++i], precision)) {
+                cerr << "Précision des poids inconnue : " << argv[i] << endl;
+                return 1;
+            }
+        } else if (arg == "--updates" && has_value) {
+            update_files.push_back(argv[++i]);
+        } else if (arg == "--ch" && has_value) {
+            filename_ch = argv[++i];
+        } else if (arg == "--compact") {
+            compact = true;
+        } else if (arg == "--memory-report") {
+            memory_report = true;
+        } else if (arg == "--threads" && has_value) {
+            options.num_threads = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--tree-cache-mb" && has_value) {
+            tree_cache_budget = static_cast<size_t>(strtoull(argv[++i], nullptr, 10)) << 20;
+        } else if (arg == "--per-vertex") {
+            options.per_vertex = true;
+        } else if (arg == "--metrics-json" && has_value) {
+            options.metrics_json = argv[++i];
+        } else if (arg == "--instrumentation" && has_value) {
+            instrumentation_file = argv[++i];
+        } else {
+            cerr << "Option inconnue ou incomplète : " << arg << endl;
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (compact && !update_files.empty()) {
+        cerr << "Les lots de modifications (--updates) ne s'appliquent pas au graph compact" << endl;
+        return 1;
+    }
+
+    // Couples lus avant le graph : une erreur d'ouverture ou de format n'attend pas le chargement
+    if (!filename_pairs.empty()) {
+        CSVLoadResult pairs_result;
+        if (filename_pairs == "-") {
+            pairs_result = read_pairs(cin, options.pairs);
+        } else {
+            ifstream pairs(filename_pairs);
+            if (!pairs.is_open()) {
+                cerr << "Impossible d'ouvrir le fichier '" << filename_pairs << "'" << endl;
+                return 1;
+            }
+            pairs_result = read_pairs(pairs, options.pairs);
+        }
+        if (!pairs_result.ok()) {
+            report_csv_errors(filename_pairs, pairs_result);
+            return 1;
+        }
+    }
+    if (!filename_pairs.empty() && options.pairs.empty()) {
+        cerr << "Aucun couple lu dans '" << filename_pairs << "'" << endl;
+        return 1;
+    }
+    // Positions ramenées aux sommets une fois le graph chargé (et renuméroté)
+    if (!filename_positions.empty()) {
+        CSVLoadResult positions_result;
+        if (filename_positions == "-") {
+            positions_result = read_position_pairs(cin, position_pairs);
+        } else {
+            ifstream positions(filename_positions);
+            if (!positions.is_open()) {
+                cerr << "Impossible d'ouvrir le fichier '" << filename_positions << "'" << endl;
+                return 1;
+            }
+            positions_result = read_position_pairs(positions, position_pairs);
+        }
+        if (!positions_result.ok()) {
+            report_csv_errors(filename_positions, positions_result);
+            return 1;
+        }
+        if (position_pairs.empty()) {
+            cerr << "Aucun couple de positions lu dans '" << filename_positions << "'" << endl;
+            return 1;
+        }
+    }
+
+    // Mêmes étapes pour les deux représentations du graph
+    auto run = [&](auto &g) {
+        using G = std::decay_t<decltype(g)>;
+        GraphCacheKey cache_key;
+        CoordinateStore coord_list;
+        // Cycles détectés sur les arêtes au chargement, sauf si des lots modifient ensuite le graph
+        CycleAnalysis cycles;
+        bool cycles_on_load = options.run_cycles && update_files.empty();
+        if (!load_graph(filename_nodes, filename_edges, filename_cache, coord_list, g, cache_key, options.num_threads, precision,
+                        cycles_on_load ? &cycles : nullptr)) {
+            return 1;
+        }
+        if (cycles_on_load) {
+            options.cycles = &cycles;
+        }
+        cout << "Graph: " << coord_list.size() << " vertices, " << num_edges(g) << " arcs" << endl;
+        // Correspondance avec les identifiants des CSV, passée à tout ce qui lit ou écrit des sommets
+        VertexNumbering numbering;
+        if (ordering != VertexOrdering::None) {
+            ReorderReport report;
+            numbering = reorder_vertices(g, coord_list, ordering, numbering, report);
+            print_reorder_report(cout, report);
+            cache_key.ordering = static_cast<uint32_t>(ordering);
+        }
+        options.numbering = &numbering;
+
+        // Index spatial construit seulement si des positions sont à ramener aux sommets
+        SpatialIndex spatial;
+        if (!position_pairs.empty() || !nearest_queries.empty()) {
+            spatial = SpatialIndex::build(coord_list);
+        }
+        if (!position_pairs.empty()) {
+            double farthest = snap_pairs(spatial, numbering, position_pairs, options.pairs, options.num_threads);
+            cout << "Snapped " << position_pairs.size() << " position pairs to vertices, farthest position at " << farthest << endl;
+        }
+        for (const auto &[position, k] : nearest_queries) {
+            cout << "Nearest vertices to (" << position[0] << ", " << position[1] << ", " << position[2] << "):";
+            for (const NearestVertex &nearest : spatial.k_nearest(position[0], position[1], position[2], k)) {
+                cout << " " << numbering.external(nearest.vertex) + 1 << " (" << nearest.distance << ")";
+            }
+            cout << endl;
+        }
+
+        ShortestPathTreeCache path_cache(tree_cache_budget);
+        if (tree_cache_budget > 0) {
+            options.cache = &path_cache;
+        }
+
+        // Empreinte de l'export : CSV et renumérotation, couples exportés, puis lots appliqués
+        ExportFingerprint fingerprint;
+        fingerprint.graph = cache_key;
+        fingerprint.pairs_hash = hash_export_pairs(options.pairs);
+        if constexpr (std::is_same_v<G, CSRGraph>) {
+            if (!update_files.empty() && !apply_update_batches(update_files, g, coord_list, numbering, options, options.cache, fingerprint)) {
+                return 1;
+            }
+        }
+
+        ContractionHierarchy ch;
+        if (!filename_ch.empty()) {
+            // Hiérarchie du fichier valable pour les CSV seulement : reconstruite en mémoire après des lots
+            if (update_files.empty()) {
+                load_or_build_contraction_hierarchy(g, filename_ch, cache_key, ch);
+            } else {
+                ch = ContractionHierarchy::build(g);
+            }
+            options.ch = &ch;
+        }
+
+        // Empreinte écrite seulement si l'export vient d'être réécrit (ancienne empreinte retirée auparavant)
+        string output = options.output.empty() ? "output.csv" : options.output;
+        bool stamp_export = options.run_export && options.format == ExportFormat::CSV;
+        std::error_code ec;
+        auto previous_write = std::filesystem::last_write_time(output, ec);
+        bool existed = !ec;
+        if (stamp_export) {
+            std::filesystem::remove(output + ".key", ec);
+        }
+
+        compute_graph(g, coord_list, options);
+
+        if (stamp_export && (!existed || std::filesystem::last_write_time(output, ec) != previous_write)) {
+            save_export_fingerprint(output, fingerprint);
+        }
+
+        if (memory_report) {
+            MemoryReport report;
+            report.add("coordinates", coord_list.memory_used());
+            add_graph_memory(report, g);
+            SearchScratch scratch;
+            scratch.prepare(coord_list.size());
+            report.add("search state per thread", scratch.memory_used());
+            report.add("shortest path tree cache", path_cache.memory_used());
+            report.add("contraction hierarchy", ch.memory_used());
+            report.add("spatial index", spatial.memory_used());
+            print_memory_report(cout, report);
+        }
+
+        if (!instrumentation_file.empty() && write_instrumentation(instrumentation_file)) {
+            cout << "Instrumentation written to '" << instrumentation_file << "'" << endl;
+        }
+        return 0;
+    };
+
+    if (compact) {
+        CompactGraph g;
+        return run(g);
+    }
+    CSRGraph g;
+    return run(g);
+}
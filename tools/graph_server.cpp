@@ -0,0 +1,90 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <csignal>
+#include "query_server.h"
+#include "instrumentation.h"
+
+using namespace std;
+
+/**
+ * @brief démon de requêtes : graph chargé une fois, requêtes servies sur une socket Unix locale
+ *
+ * Usage : graph_server [--nodes F] [--edges F] [--graph-cache F] [--ch F] [--socket P] [--threads N]
+ *                      [--mode dijkstra|astar|bidirectional] [--engine binary|radix|buckets|delta] [--weights double|float]
+ *                      [--instrumentation F]
+ *
+ * Protocole décrit dans query_server.h ; arrêt par SIGINT, SIGTERM ou la commande SHUTDOWN.
+ */
+
+static QueryServer *running_server = nullptr;
+
+static void handle_signal(int)
+{
+    if (running_server) {
+        running_server->stop();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QueryServerConfig config;
+    string instrumentation_file;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--nodes" && has_value) {
+            config.filename_nodes = argv[++i];
+        } else if (arg == "--edges" && has_value) {
+            config.filename_edges = argv[++i];
+        } else if (arg == "--graph-cache" && has_value) {
+            config.filename_cache = argv[++i];
+        } else if (arg == "--ch" && has_value) {
+            config.filename_ch = argv[++i];
+        } else if (arg == "--socket" && has_value) {
+            config.socket_path = argv[++i];
+        } else if (arg == "--threads" && has_value) {
+            config.num_threads = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--mode" && has_value) {
+            string mode = argv[++i];
+            if (mode == "dijkstra") config.default_mode = SearchMode::Dijkstra;
+            else if (mode == "astar") config.default_mode = SearchMode::AStar;
+            else if (mode == "bidirectional") config.default_mode = SearchMode::Bidirectional;
+            else {
+                cerr << "Mode de recherche inconnu : " << mode << endl;
+                return 1;
+            }
+        } else if (arg == "--engine" && has_value) {
+            if (!parse_search_engine(argv[++i], config.default_engine)) {
+                cerr << "File de priorité inconnue : " << argv[i] << endl;
+                return 1;
+            }
+        } else if (arg == "--weights" && has_value) {
+            if (!parse_weight_precision(argv[++i], config.weight_precision)) {
+                cerr << "Précision des poids inconnue : " << argv[i] << endl;
+                return 1;
+            }
+        } else if (arg == "--instrumentation" && has_value) {
+            instrumentation_file = argv[++i];
+        } else {
+            cerr << "Usage : " << argv[0] << " [--nodes F] [--edges F] [--graph-cache F] [--ch F] [--socket P] [--threads N]"
+                 << " [--mode dijkstra|astar|bidirectional] [--engine binary|radix|buckets|delta] [--weights double|float]"
+                 << " [--instrumentation F]" << endl;
+            return 1;
+        }
+    }
+
+    QueryServer server(config);
+    running_server = &server;
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+
+    bool ok = server.run();
+    running_server = nullptr;
+
+    if (!instrumentation_file.empty() && write_instrumentation(instrumentation_file)) {
+        cout << "Instrumentation written to '" << instrumentation_file << "'" << endl;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include "path_matrix.h"
+#include "path_search.h"
+#include "vertex_order.h"
+
+using namespace std;
+
+/**
+ * @brief relecture d'une matrice de prédécesseurs et export CSV "Start;End;Path Length;Path"
+ *
+ * Usage : path_matrix_reader <matrice> <sortie.csv> [--pairs <fichier>] [départ arrivée]...
+ *
+ * Les couples sont en numérotation 1..n, donnés sur la ligne de commande ou dans un fichier
+ * "départ;arrivée" (une ligne par couple, en-tête "Start;End" sauté, lignes mal formées signalées). Sans couple, toutes les
+ * arrivées supérieures à chaque source du fichier sont exportées, comme l'export de compute_graph.
+ */
+int main(int argc, char *argv[])
+{
+    if (argc < 3) {
+        cerr << "Usage : " << argv[0] << " <matrice> <sortie.csv> [--pairs <fichier>] [départ arrivée]..." << endl;
+        return 1;
+    }
+
+    PathMatrixReader reader;
+    if (!reader.open(argv[1])) {
+        return 1;
+    }
+    size_t n = reader.num_vertices();
+
+    vector<pair<double, double>> list_Node;
+    for (int i = 3; i < argc; ++i) {
+        if (string(argv[i]) == "--pairs" && i + 1 < argc) {
+            ifstream pairs(argv[++i]);
+            if (!pairs.is_open()) {
+                cerr << "Impossible d'ouvrir le fichier '" << argv[i] << "'" << endl;
+                return 1;
+            }
+            CSVLoadResult pairs_result = read_pairs(pairs, list_Node);
+            if (!pairs_result.ok()) {
+                report_csv_errors(argv[i], pairs_result);
+                return 1;
+            }
+        } else if (i + 1 < argc) {
+            list_Node.push_back({strtod(argv[i], nullptr), strtod(argv[i + 1], nullptr)});
+            ++i;
+        } else {
+            cerr << "Arrivée manquante pour le départ " << argv[i] << endl;
+            return 1;
+        }
+    }
+
+    if (list_Node.empty()) {
+        for (Vertex s : reader.sources()) {
+            for (size_t t = s + 1; t < n; ++t) {
+                list_Node.push_back({s + 1.0, t + 1.0});
+            }
+        }
+    }
+
+    ofstream file(argv[2], ios::out | ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        cerr << "Impossible d'ouvrir le fichier de sortie" << endl;
+        return 1;
+    }
+
+    // Matrice écrite dans la numérotation des fichiers
+    VertexNumbering numbering;
+    string out = "Start;End;Path Length;Path\n";
+    vector<Vertex> path;
+    double length;
+    for (const auto &[start, goal] : list_Node) {
+        if (!valid_pair(start, goal, n)) {
+            cerr << "Erreur : Indices de sommet invalides (" << start << ", " << goal << ")" << endl;
+            continue;
+        }
+        Vertex start_idx = static_cast<Vertex>(start - 1);
+        if (!reader.has_source(start_idx)) {
+            cerr << "Erreur : source " << start << " absente de la matrice" << endl;
+            continue;
+        }
+        bool found = reader.path(start_idx, static_cast<Vertex>(goal - 1), path, length);
+        write_path_row(out, start, goal, found, length, path, numbering);
+
+        if (out.size() >= (1 << 20)) {
+            file.write(out.data(), out.size());
+            out.clear();
+        }
+    }
+    file.write(out.data(), out.size());
+
+    file.close();
+    if (!file) {
+        cerr << "Erreur d'écriture du fichier '" << argv[2] << "'" << endl;
+        return 1;
+    }
+    return 0;
+}